@@ -0,0 +1,104 @@
+/*
+* 文件名称：bench_alloc.cpp
+* 摘    要：电路构建与析构的堆分配统计：生成 W x W 的电阻网格（每个节点带负载电流源和对地电容），
+*           分阶段统计全局 operator new 的调用次数、字节数和耗时
+*           编译：g++ -std=c++17 -O2 -pthread bench_alloc.cpp -o bench_alloc
+*           运行：./bench_alloc [网格边长 W，默认 200]
+* 作    者：H.J.Xie
+* 完成日期：2025年9月22日
+*/
+#include "../xe_Simulator.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+// 全局堆分配计数
+static long long g_Allocs = 0; // operator new 的调用次数
+static long long g_Bytes = 0;  // operator new 申请的字节数
+static long long g_Frees = 0;  // operator delete 的调用次数
+
+// 替换全局 operator new/delete 后，GCC 内联时会把 malloc 返回的指针视为 new 分配的，
+// 在 operator delete 中的 free 处误报 -Wmismatched-new-delete（两者实际配对），此处局部关闭该警告
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void* operator new(size_t size) {
+    g_Allocs++;
+    g_Bytes += (long long)size;
+    void* p = std::malloc(size ? size : 1);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+void operator delete(void* p) noexcept {
+    if (p) g_Frees++;
+    std::free(p);
+}
+void operator delete(void* p, size_t) noexcept {
+    if (p) g_Frees++;
+    std::free(p);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+// 一个阶段的统计
+struct Bench_Phase {
+    const char* Name;
+    long long Allocs0, Bytes0, Frees0;
+    std::chrono::steady_clock::time_point T0;
+    explicit Bench_Phase(const char* name) : Name(name) {
+        Allocs0 = g_Allocs;
+        Bytes0 = g_Bytes;
+        Frees0 = g_Frees;
+        T0 = std::chrono::steady_clock::now();
+    }
+    ~Bench_Phase() {
+        double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - T0).count();
+        std::printf("%-8s %12lld allocs %14lld bytes %12lld frees %10.3f s\n",
+            Name, g_Allocs - Allocs0, g_Bytes - Bytes0, g_Frees - Frees0, t);
+    }
+};
+
+int main(int argc, char** argv) {
+    namespace xe = xespice;
+    int w = (argc > 1) ? std::atoi(argv[1]) : 200;
+    const char* path = "bench_alloc.cir";
+    // 生成网表
+    {
+        std::FILE* f = std::fopen(path, "w");
+        if (f == nullptr) return 1;
+        std::fprintf(f, "resistor grid %d x %d\n", w, w);
+        std::fprintf(f, "vdd n0_0 0 1\n");
+        long long count = 1;
+        for (int i = 0; i < w; i++) {
+            for (int j = 0; j < w; j++) {
+                if (j + 1 < w) std::fprintf(f, "rh%d_%d n%d_%d n%d_%d 1\n", i, j, i, j, i, j + 1), count++;
+                if (i + 1 < w) std::fprintf(f, "rv%d_%d n%d_%d n%d_%d 1\n", i, j, i, j, i + 1, j), count++;
+                std::fprintf(f, "il%d_%d n%d_%d 0 1u\n", i, j, i, j);
+                std::fprintf(f, "cd%d_%d n%d_%d 0 1p\n", i, j, i, j);
+                count += 2;
+            }
+        }
+        std::fprintf(f, ".op\n.end\n");
+        std::fclose(f);
+        std::printf("elements %lld, nodes %d\n", count, w * w);
+    }
+    xe::Circuit* cir;
+    {
+        Bench_Phase phase("read");
+        cir = xe::NewCircuit();
+        cir->ReadFile(path);
+    }
+    {
+        Bench_Phase phase("run");
+        cir->SetOutputPath("bench_alloc.txt");
+        cir->Run();
+    }
+    {
+        Bench_Phase phase("delete");
+        delete cir;
+    }
+    return 0;
+}
@@ -0,0 +1,99 @@
+/*
+* 文件名称：bench_scaling.cpp
+* 摘    要：并行吞吐量测试：生成一批互不相关的小网表（RC 梯形网络的瞬态分析与电阻网格的工作点，规模各不相同），
+*           用作业调度器分别以 1、2、4 ... 个线程（直到全部硬件线程）运行同一批作业，
+*           每个线程数输出一行 JSON（耗时、吞吐量、相对单线程的加速比和并行效率）
+*           编译：g++ -std=c++17 -O2 -pthread bench_scaling.cpp -o bench_scaling
+*           运行：./bench_scaling [作业个数，默认 256] [最低并行效率，默认 0，最大线程数时低于此值返回 1]
+*                 [最大线程数，默认全部硬件线程]
+* 作    者：H.J.Xie
+* 完成日期：2025年9月26日
+*/
+#include "../xe_Scheduler.h"
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+
+// 生成第 k 个网表（规模按 k 循环变化，使各作业的耗时不同），返回文件路径
+static xespice::String Bench_Write(int k) {
+    char path[64];
+    std::snprintf(path, sizeof(path), "bench_scaling_%d.cir", k);
+    std::FILE* f = std::fopen(path, "w");
+    if (f == nullptr) return "";
+    if (k % 2 == 0) { // RC 梯形网络的瞬态分析
+        int stages = 50 + 50 * (k % 7);
+        std::fprintf(f, "rc ladder %d\nv1 1 0 pulse(0 1 0 1n 1n 5u 10u)\n", stages);
+        for (int s = 1; s <= stages; s++) {
+            std::fprintf(f, "r%d %d %d 100\n", s, s, s + 1);
+            std::fprintf(f, "c%d %d 0 1p\n", s, s + 1);
+        }
+        std::fprintf(f, ".tran 10n 20u\n.end\n");
+    }
+    else { // 电阻网格的工作点
+        int w = 20 + 10 * (k % 5);
+        std::fprintf(f, "grid %d\nvdd n0_0 0 1\n", w);
+        for (int i = 0; i < w; i++) {
+            for (int j = 0; j < w; j++) {
+                if (j + 1 < w) std::fprintf(f, "rh%d_%d n%d_%d n%d_%d 1\n", i, j, i, j, i, j + 1);
+                if (i + 1 < w) std::fprintf(f, "rv%d_%d n%d_%d n%d_%d 1\n", i, j, i, j, i + 1, j);
+                std::fprintf(f, "il%d_%d n%d_%d 0 1u\n", i, j, i, j);
+            }
+        }
+        std::fprintf(f, ".op\n.end\n");
+    }
+    std::fclose(f);
+    return path;
+}
+
+// 以 threads 个线程运行全部作业，返回耗时（秒），有作业失败时返回负数
+static double Bench_RunAll(const xespice::Vect<xespice::BatchJob>& jobs, int threads) {
+    namespace xe = xespice;
+    std::atomic<int> failed{0};
+    double t0 = xe::Timer_Now();
+    {
+        xe::JobScheduler sched(threads, 0, 0, [&](int id, const xe::String& report, bool ok) {
+            if (!ok) {
+                failed++;
+                std::fprintf(stderr, "%s\n", report.c_str());
+            }
+        });
+        for (const xe::BatchJob& job : jobs) sched.Submit(job);
+        sched.Wait();
+    }
+    double t = xe::Timer_Now() - t0;
+    return failed ? -1 : t;
+}
+
+int main(int argc, char** argv) {
+    namespace xe = xespice;
+    int count = (argc > 1) ? std::atoi(argv[1]) : 256;
+    double minEfficiency = (argc > 2) ? std::atof(argv[2]) : 0;
+    int cores = (argc > 3) ? std::atoi(argv[3]) : (int)std::thread::hardware_concurrency();
+    if (cores <= 0) cores = 1;
+    xe::Vect<xe::BatchJob> jobs(count);
+    for (int k = 0; k < count; k++) {
+        jobs[k].Input = Bench_Write(k);
+        jobs[k].Output = jobs[k].Input + ".out";
+        if (jobs[k].Input.empty()) return 2;
+    }
+    Bench_RunAll(jobs, 1); // 预热（文件缓存、堆）
+    xe::Vect<int> counts;
+    for (int t = 1; t < cores; t *= 2) counts.push_back(t);
+    counts.push_back(cores);
+    double base = 0, efficiency = 1;
+    for (int t : counts) {
+        double sec = Bench_RunAll(jobs, t);
+        if (sec < 0) return 2;
+        if (t == 1) base = sec;
+        double speedup = base / sec;
+        efficiency = speedup / t;
+        std::printf("{\"threads\":%d,\"jobs\":%d,\"seconds\":%.6f,\"jobs_per_s\":%.2f,\"speedup\":%.3f,\"efficiency\":%.3f}\n",
+            t, count, sec, count / sec, speedup, efficiency);
+        std::fflush(stdout);
+    }
+    for (const xe::BatchJob& job : jobs) {
+        std::remove(job.Input.c_str());
+        std::remove(job.Output.c_str());
+    }
+    return (efficiency < minEfficiency) ? 1 : 0;
+}
@@ -0,0 +1,290 @@
+/*
+* 文件名称：bench_suite.cpp
+* 摘    要：宏观基准测试：生成可缩放的网表（电阻梯形网络、二维/三维 RC 电源网格、随机稀疏图、受控源网络），
+*           按元件数从小到大逐个数量级运行，分阶段计时，每次运行输出一行 JSON（便于跟踪规模曲线和版本间对比）
+*           编译：g++ -std=c++17 -O2 -pthread bench_suite.cpp -o bench_suite
+*           运行：./bench_suite [生成器名|all，默认 all] [最大元件数，默认 1e6] [最小元件数，默认 10] [.OPTIONS 参数...]
+*                 ./bench_suite compare 旧结果.jsonl 新结果.jsonl [允许的变慢比例，默认 0.1]
+*           生成器：ladder grid2d grid3d random ctrl
+* 作    者：H.J.Xie
+* 完成日期：2025年9月25日
+*/
+#include "../xe_Simulator.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+// 生成的网表规模
+struct Bench_Netlist {
+    long long Elements = 0; // 元件个数
+    long long Nodes = 0;    // 节点个数（不含地）
+};
+
+// 网表生成器：向 f 写入约 size 个元件的网表（不含标题、分析命令和 .END）
+using Bench_Generator = Bench_Netlist(*)(std::FILE* f, long long size);
+
+// 电阻梯形网络：电压源驱动，每级一个串联电阻和一个对地电阻
+static Bench_Netlist Bench_Ladder(std::FILE* f, long long size) {
+    Bench_Netlist net;
+    long long stages = std::max(1LL, size / 2);
+    std::fprintf(f, "v1 1 0 1\n");
+    for (long long k = 1; k <= stages; k++) {
+        std::fprintf(f, "rs%lld %lld %lld 10\n", k, k, k + 1);
+        std::fprintf(f, "rp%lld %lld 0 10k\n", k, k + 1);
+    }
+    net.Elements = 1 + 2 * stages;
+    net.Nodes = stages + 1;
+    return net;
+}
+
+// 二维 RC 电源网格：W x W 个节点，相邻节点间为金属电阻，每个节点带负载电流源和去耦电容，
+// 每隔 16 个节点有一个经过封装电阻接到电源的焊盘
+static Bench_Netlist Bench_Grid2D(std::FILE* f, long long size) {
+    Bench_Netlist net;
+    int w = std::max(2, (int)std::sqrt((double)size / 4));
+    std::mt19937 gen(2025);
+    std::uniform_real_distribution<double> load(0, 1e-4);
+    for (int i = 0; i < w; i++) {
+        for (int j = 0; j < w; j++) {
+            if (j + 1 < w) std::fprintf(f, "rh%d_%d n%d_%d n%d_%d 0.1\n", i, j, i, j, i, j + 1), net.Elements++;
+            if (i + 1 < w) std::fprintf(f, "rv%d_%d n%d_%d n%d_%d 0.1\n", i, j, i, j, i + 1, j), net.Elements++;
+            std::fprintf(f, "il%d_%d n%d_%d 0 %.6e\n", i, j, i, j, load(gen));
+            std::fprintf(f, "cd%d_%d n%d_%d 0 1p\n", i, j, i, j);
+            net.Elements += 2;
+            if (i % 16 == 0 && j % 16 == 0) {
+                std::fprintf(f, "rpad%d_%d n%d_%d vdd 0.01\n", i, j, i, j);
+                net.Elements++;
+            }
+        }
+    }
+    std::fprintf(f, "vdd vdd 0 1\n");
+    net.Elements++;
+    net.Nodes = (long long)w * w + 1;
+    return net;
+}
+
+// 三维 RC 电源网格：W x W x W 个节点（多层金属），层间为通孔电阻，底层焊盘接电源
+static Bench_Netlist Bench_Grid3D(std::FILE* f, long long size) {
+    Bench_Netlist net;
+    int w = std::max(2, (int)std::lround(std::cbrt((double)size / 5))); // 四舍五入：截断时 size=10 和 100 都得到 w=2
+    std::mt19937 gen(2025);
+    std::uniform_real_distribution<double> load(0, 1e-4);
+    for (int l = 0; l < w; l++) {
+        for (int i = 0; i < w; i++) {
+            for (int j = 0; j < w; j++) {
+                if (j + 1 < w) std::fprintf(f, "rx%d_%d_%d n%d_%d_%d n%d_%d_%d 0.1\n", l, i, j, l, i, j, l, i, j + 1), net.Elements++;
+                if (i + 1 < w) std::fprintf(f, "ry%d_%d_%d n%d_%d_%d n%d_%d_%d 0.1\n", l, i, j, l, i, j, l, i + 1, j), net.Elements++;
+                if (l + 1 < w) std::fprintf(f, "rz%d_%d_%d n%d_%d_%d n%d_%d_%d 0.5\n", l, i, j, l, i, j, l + 1, i, j), net.Elements++;
+                std::fprintf(f, "il%d_%d_%d n%d_%d_%d 0 %.6e\n", l, i, j, l, i, j, load(gen));
+                std::fprintf(f, "cd%d_%d_%d n%d_%d_%d 0 1p\n", l, i, j, l, i, j);
+                net.Elements += 2;
+                if (l == 0 && i % 8 == 0 && j % 8 == 0) {
+                    std::fprintf(f, "rpad%d_%d n0_%d_%d vdd 0.01\n", i, j, i, j);
+                    net.Elements++;
+                }
+            }
+        }
+    }
+    std::fprintf(f, "vdd vdd 0 1\n");
+    net.Elements++;
+    net.Nodes = (long long)w * w * w + 1;
+    return net;
+}
+
+// 随机稀疏图：每个新节点连到一个随机的已有节点（保证连通），再加同样多的随机边，每个节点有对地电阻
+static Bench_Netlist Bench_Random(std::FILE* f, long long size) {
+    Bench_Netlist net;
+    long long n = std::max(2LL, size / 3);
+    std::mt19937_64 gen(2025);
+    std::uniform_real_distribution<double> res(1, 1000);
+    std::fprintf(f, "v1 1 0 1\n");
+    for (long long k = 2; k <= n; k++) {
+        long long j = 1 + (long long)(gen() % (unsigned long long)(k - 1));
+        std::fprintf(f, "rt%lld %lld %lld %.4f\n", k, k, j, res(gen));
+    }
+    for (long long k = 1; k <= n; k++) {
+        long long a = 1 + (long long)(gen() % (unsigned long long)n);
+        long long b = 1 + (long long)(gen() % (unsigned long long)n);
+        if (a == b) b = (a % n) + 1;
+        std::fprintf(f, "re%lld %lld %lld %.4f\n", k, a, b, res(gen));
+        std::fprintf(f, "rg%lld %lld 0 %.4f\n", k, k, 1000 * res(gen));
+    }
+    net.Elements = 1 + (n - 1) + 2 * n;
+    net.Nodes = n;
+    return net;
+}
+
+// 受控源网络：每级一个 VCCS 驱动负载电阻，轮流经 VCVS、CCCS、CCVS 耦合到下一级（电流控制经零值电压源检测）
+static Bench_Netlist Bench_Ctrl(std::FILE* f, long long size) {
+    Bench_Netlist net;
+    long long stages = std::max(1LL, size / 4);
+    std::fprintf(f, "v1 a0 0 1\n");
+    std::fprintf(f, "r0 a0 0 1k\n");
+    net.Elements = 2;
+    for (long long k = 1; k <= stages; k++) {
+        std::fprintf(f, "g%lld b%lld 0 a%lld 0 1m\n", k, k, k - 1);
+        std::fprintf(f, "rb%lld b%lld 0 1k\n", k, k);
+        switch (k % 3) {
+        case 0:
+            std::fprintf(f, "e%lld a%lld 0 b%lld 0 0.9\n", k, k, k);
+            std::fprintf(f, "ra%lld a%lld 0 1k\n", k, k);
+            break;
+        case 1:
+            std::fprintf(f, "vm%lld b%lld c%lld 0\n", k, k, k);
+            std::fprintf(f, "f%lld 0 a%lld vm%lld 0.9\n", k, k, k);
+            std::fprintf(f, "rc%lld c%lld 0 1\n", k, k);
+            std::fprintf(f, "ra%lld a%lld 0 1k\n", k, k);
+            net.Elements += 2;
+            net.Nodes++;
+            break;
+        default:
+            std::fprintf(f, "vm%lld b%lld c%lld 0\n", k, k, k);
+            std::fprintf(f, "h%lld a%lld 0 vm%lld 0.9\n", k, k, k);
+            std::fprintf(f, "rc%lld c%lld 0 1\n", k, k);
+            std::fprintf(f, "ra%lld a%lld 0 1k\n", k, k);
+            net.Elements += 2;
+            net.Nodes++;
+            break;
+        }
+        net.Elements += 4;
+        net.Nodes += 2;
+    }
+    net.Nodes++;
+    return net;
+}
+
+// 生成器表
+static const struct {
+    const char* Name;
+    Bench_Generator Gen;
+} g_Generators[] = {
+    { "ladder", Bench_Ladder },
+    { "grid2d", Bench_Grid2D },
+    { "grid3d", Bench_Grid3D },
+    { "random", Bench_Random },
+    { "ctrl", Bench_Ctrl },
+};
+
+// 生成一个网表并分阶段运行，输出一行 JSON
+static bool Bench_Run(const char* name, Bench_Generator gen, long long size, int optc, char** optv) {
+    namespace xe = xespice;
+    const char* path = "bench_suite.cir";
+    const char* out = "bench_suite.out";
+    Bench_Netlist net;
+    {
+        std::FILE* f = std::fopen(path, "w");
+        if (f == nullptr) return false;
+        std::fprintf(f, "%s %lld\n", name, size);
+        net = gen(f, size);
+        if (optc > 0) { // 命令行给出的 .OPTIONS 参数
+            std::fprintf(f, ".options");
+            for (int i = 0; i < optc; i++) std::fprintf(f, " %s", optv[i]);
+            std::fprintf(f, "\n");
+        }
+        std::fprintf(f, ".op\n.end\n");
+        std::fclose(f);
+    }
+    double t0 = xe::Timer_Now();
+    xe::Circuit* cir = xe::NewCircuit();
+    cir->ReadFile(path);
+    cir->SetOutputPath(out);
+    cir->Run();
+    double tDelete = xe::Timer_Now();
+    const xe::PhaseTimes tm = cir->Timing;
+    bool ok = !cir->ErrorFlag;
+    xe::String msg = cir->ErrorMsg;
+    delete cir;
+    double t1 = xe::Timer_Now();
+    std::printf("{\"bench\":\"%s\",\"size\":%lld,\"elements\":%lld,\"nodes\":%lld,"
+        "\"read\":%.6f,\"create\":%.6f,\"compile\":%.6f,\"stamp\":%.6f,\"factor\":%.6f,"
+        "\"solve\":%.6f,\"print\":%.6f,\"run\":%.6f,\"delete\":%.6f,\"total\":%.6f,\"ok\":%s}\n",
+        name, size, net.Elements, net.Nodes, tm.Read, tm.Create, tm.Compile, tm.Stamp, tm.Factor,
+        tm.Solve, tm.Print, tm.Run, t1 - tDelete, t1 - t0, ok ? "true" : "false");
+    std::fflush(stdout);
+    if (!ok) std::fprintf(stderr, "%s %lld: %s\n", name, size, msg.c_str());
+    std::remove(path);
+    std::remove(out);
+    return ok;
+}
+
+// 一次运行的结果（对比模式用）
+struct Bench_Record {
+    char Bench[32] = "";
+    long long Size = 0;
+    double Phase[10] = {};
+};
+static const char* g_Phases[] = { "read", "create", "compile", "stamp", "factor", "solve", "print", "run", "delete", "total" };
+
+// 读取 JSON 行结果（只识别本程序输出的字段）
+static std::vector<Bench_Record> Bench_Load(const char* path) {
+    std::vector<Bench_Record> list;
+    std::FILE* f = std::fopen(path, "r");
+    if (f == nullptr) return list;
+    char line[1024];
+    while (std::fgets(line, sizeof(line), f)) {
+        Bench_Record rec;
+        const char* p = std::strstr(line, "\"bench\":\"");
+        if (p == nullptr) continue;
+        std::sscanf(p + 9, "%31[^\"]", rec.Bench);
+        if ((p = std::strstr(line, "\"size\":")) != nullptr) rec.Size = std::atoll(p + 7);
+        for (int k = 0; k < 10; k++) {
+            char key[32];
+            std::snprintf(key, sizeof(key), "\"%s\":", g_Phases[k]);
+            if ((p = std::strstr(line, key)) != nullptr) rec.Phase[k] = std::atof(p + std::strlen(key));
+        }
+        list.push_back(rec);
+    }
+    std::fclose(f);
+    return list;
+}
+
+// 对比两次结果，变慢超过 tol 的阶段记为退化（耗时均不足 10ms 的阶段受计时噪声影响，不比较），返回退化个数
+static int Bench_Compare(const char* oldPath, const char* newPath, double tol) {
+    std::vector<Bench_Record> a = Bench_Load(oldPath), b = Bench_Load(newPath);
+    int regressions = 0;
+    for (const Bench_Record& y : b) {
+        for (const Bench_Record& x : a) {
+            if (x.Size != y.Size || std::strcmp(x.Bench, y.Bench) != 0) continue;
+            for (int k = 0; k < 10; k++) {
+                if (x.Phase[k] < 1e-2 && y.Phase[k] < 1e-2) continue;
+                double ratio = y.Phase[k] / std::max(x.Phase[k], 1e-9);
+                bool bad = ratio > 1 + tol;
+                if (bad) regressions++;
+                std::printf("%-8s %10lld %-8s %10.4f s -> %10.4f s  x%.3f%s\n", y.Bench, y.Size, g_Phases[k],
+                    x.Phase[k], y.Phase[k], ratio, bad ? "  REGRESSION" : "");
+            }
+            break;
+        }
+    }
+    std::printf("%d regressions (tolerance %.0f%%)\n", regressions, tol * 100);
+    return regressions;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::strcmp(argv[1], "compare") == 0) {
+        if (argc < 4) {
+            std::fprintf(stderr, "usage: %s compare old.jsonl new.jsonl [tolerance]\n", argv[0]);
+            return 2;
+        }
+        double tol = (argc > 4) ? std::atof(argv[4]) : 0.1;
+        return Bench_Compare(argv[2], argv[3], tol) > 0 ? 1 : 0;
+    }
+    const char* which = (argc > 1) ? argv[1] : "all";
+    long long maxSize = (argc > 2) ? (long long)std::atof(argv[2]) : 1000000;
+    long long minSize = (argc > 3) ? (long long)std::atof(argv[3]) : 10;
+    int optc = std::max(0, argc - 4);
+    bool found = false;
+    for (const auto& g : g_Generators) {
+        if (std::strcmp(which, "all") != 0 && std::strcmp(which, g.Name) != 0) continue;
+        found = true;
+        for (long long size = minSize; size <= maxSize; size *= 10) {
+            if (!Bench_Run(g.Name, g.Gen, size, optc, argv + 4)) break;
+        }
+    }
+    if (!found) {
+        std::fprintf(stderr, "unknown generator: %s\n", which);
+        return 2;
+    }
+    return 0;
+}
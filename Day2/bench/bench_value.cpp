@@ -0,0 +1,136 @@
+/*
+* 文件名称：bench_value.cpp
+* 摘    要：数值解析的吞吐量测试，对比 Str_ToValue（from_chars）与原先基于 std::stod 的实现
+*           编译：g++ -std=c++17 -O2 bench_value.cpp -o bench_value
+*           运行：./bench_value [数值个数，默认 4000000]
+* 作    者：H.J.Xie
+* 完成日期：2025年9月18日
+*/
+#include "../xe_Parse.h"
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace ref
+{
+using namespace xespice;
+// 原先的实现（作为对照）
+static inline double Str_ToValueStod(const String& s) {
+    String state = "";
+    String numstr = "";
+    bool isSci = false; // 是否为科学计数法
+    // 分割数字和数量级单位
+    for (char ch : s) {
+        if (std::isdigit(ch) || ch == '+' || ch == '-' || ch == '.') {
+            if (state == "") numstr += ch;
+            else if (state == "e" && !isSci) {
+                isSci = true;
+                state = "";
+                numstr += 'e';
+                numstr += ch;
+            }
+            else break;
+        }
+        else if (std::isalpha(ch)) {
+            char c = std::tolower(ch); // 转小写
+            if (state == "") {
+                if (c == 't') { state = "t"; break; }
+                else if (c == 'g') { state = "g"; break; }
+                else if (c == 'k') { state = "k"; break; }
+                else if (c == 'u') { state = "u"; break; }
+                else if (c == 'n') { state = "n"; break; }
+                else if (c == 'p') { state = "p"; break; }
+                else if (c == 'f') { state = "f"; break; }
+                else if (c == 'e') { state = "e"; }
+                else if (c == 'm') { state = "m"; }
+                else break;
+            }
+            else if (state == "m") {
+                if (c == 'e') { state = "me"; }
+                else if (c == 'i') { state = "mi"; }
+                else break;
+            }
+            else if (state == "me") {
+                if (c == 'g') { state = "M"; break; }
+                else break;
+            }
+            else if (state == "mi") {
+                if (c == 'l') { state = "l"; break; }
+                else break;
+            }
+            else break;
+        }
+        else break;
+    }
+    // 识别数量级单位
+    double scale = 1;
+    if (state.size() > 0) {
+        switch (state[0]) {
+        case 't': scale = 1e12; break;
+        case 'g': scale = 1e9; break;
+        case 'M': scale = 1e6; break;
+        case 'k': scale = 1e3; break;
+        case 'm': scale = 1e-3; break;
+        case 'l': scale = 25.4e-6; break;
+        case 'u': scale = 1e-6; break;
+        case 'n': scale = 1e-9; break;
+        case 'p': scale = 1e-12; break;
+        case 'f': scale = 1e-15; break;
+        default: break;
+        }
+    }
+    // 识别数字
+    double number;
+    try {
+        number = std::stod(numstr) * scale;
+    }
+    catch (...) {
+        number = std::nan("");
+    }
+    return number;
+}
+
+} // namespace ref
+
+// 对 values 中的每个字符串调用 func，返回耗时（秒）和结果之和
+template<typename F>
+static double Bench_Run(const xespice::Vect<xespice::String>& values, F func, double& sum) {
+    auto t0 = std::chrono::steady_clock::now();
+    double s = 0;
+    for (const xespice::String& v : values) s += func(v);
+    auto t1 = std::chrono::steady_clock::now();
+    sum = s;
+    return std::chrono::duration<double>(t1 - t0).count();
+}
+
+int main(int argc, char** argv) {
+    namespace xe = xespice;
+    size_t count = (argc > 1) ? (size_t)std::atoll(argv[1]) : 4000000;
+    // 生成网表中常见形式的数值
+    const char* mantissa[] = { "1", "4.7", "10", "2.2", "33", "100", "0.5", "1.5e-3", "3.3", "47e2", "-12", "+6.8" };
+    const char* suffix[] = { "", "k", "meg", "m", "u", "n", "p", "f", "g", "t", "mil", "pF", "uH", "kOhm", "v" };
+    std::mt19937 rng(2025);
+    xe::Vect<xe::String> values(count);
+    for (xe::String& v : values) {
+        v = mantissa[rng() % (sizeof(mantissa) / sizeof(mantissa[0]))];
+        v += suffix[rng() % (sizeof(suffix) / sizeof(suffix[0]))];
+    }
+    // 检查两种实现结果一致
+    size_t diff = 0;
+    for (const xe::String& v : values) {
+        double a = ref::Str_ToValueStod(v), b = xe::Str_ToValue(v);
+        if (std::memcmp(&a, &b, sizeof(double)) != 0) diff++;
+    }
+    double sumOld, sumNew;
+    double tOld = Bench_Run(values, [](const xe::String& v) { return ref::Str_ToValueStod(v); }, sumOld);
+    double tNew = Bench_Run(values, [](const xe::String& v) { return xe::Str_ToValue(v); }, sumNew);
+    std::printf("values        : %zu (mismatch %zu)\n", count, diff);
+    std::printf("stod          : %8.3f s  %7.1f ns/value  %7.2f M/s  (sum %.6g)\n",
+        tOld, tOld * 1e9 / count, count / tOld * 1e-6, sumOld);
+    std::printf("from_chars    : %8.3f s  %7.1f ns/value  %7.2f M/s  (sum %.6g)\n",
+        tNew, tNew * 1e9 / count, count / tNew * 1e-6, sumNew);
+    std::printf("speedup       : %.2fx\n", tOld / tNew);
+    return (diff == 0) ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+/*
+* 文件名称：raw_undelta.cpp
+* 摘    要：差分压缩 rawfile 的读取工具：把 .OPTIONS FORMAT=RAW DELTA=1 输出的 "Delta:" 数据段解码为标准的 "Binary:" 数据段，
+*           得到其他 SPICE 波形工具可读的 rawfile（未压缩的结果表原样复制），同时校验每个表的数据完整
+*           编译：g++ -std=c++17 -O2 raw_undelta.cpp -o raw_undelta
+*           运行：./raw_undelta 输入.raw 输出.raw
+*           与 DELTA=0 的输出相比，除 Date 行外逐字节相同（解码是位精确的）
+* 作    者：H.J.Xie
+* 完成日期：2025年9月23日
+*/
+#include "../xe_Writer.h"
+#include <cstdio>
+#include <cstdlib>
+
+// 读入整个文件，失败时返回 false
+static bool Undelta_Load(const char* path, xespice::Vect<char>& data) {
+    std::FILE* f = std::fopen(path, "rb");
+    if (f == nullptr) return false;
+    char chunk[1 << 16];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), f)) > 0) data.insert(data.end(), chunk, chunk + n);
+    std::fclose(f);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    namespace xe = xespice;
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: %s in.raw out.raw\n", argv[0]);
+        return 2;
+    }
+    xe::Vect<char> in;
+    if (!Undelta_Load(argv[1], in)) {
+        std::fprintf(stderr, "cannot read %s\n", argv[1]);
+        return 2;
+    }
+    std::FILE* out = std::fopen(argv[2], "wb");
+    if (out == nullptr) {
+        std::fprintf(stderr, "cannot write %s\n", argv[2]);
+        return 2;
+    }
+    size_t pos = 0;
+    int plots = 0;
+    long long decoded = 0;
+    while (pos < in.size()) {
+        // 表头：逐行复制，直到 "Binary:" 或 "Delta:"
+        bool isComplex = false, delta = false;
+        long long vars = 0, points = 0;
+        while (true) {
+            size_t end = pos;
+            while (end < in.size() && in[end] != '\n') end++;
+            if (end >= in.size()) {
+                std::fprintf(stderr, "%s: truncated header in plot %d\n", argv[1], plots + 1);
+                std::fclose(out);
+                return 1;
+            }
+            xe::String line(in.data() + pos, end - pos);
+            pos = end + 1;
+            if (line.compare(0, 6, "Flags:") == 0) {
+                isComplex = line.find("complex") != xe::String::npos;
+                if (line.size() > 6 && line.compare(line.size() - 6, 6, " delta") == 0) line.resize(line.size() - 6);
+            }
+            else if (line.compare(0, 14, "No. Variables:") == 0) vars = std::atoll(line.c_str() + 14);
+            else if (line.compare(0, 11, "No. Points:") == 0) points = std::atoll(line.c_str() + 11);
+            else if (line == "Delta:") {
+                delta = true;
+                line = "Binary:";
+            }
+            std::fprintf(out, "%s\n", line.c_str());
+            if (line == "Binary:") break;
+        }
+        // 数据段：每点 vars 个变量（复数表每个变量两个值）
+        size_t width = (size_t)vars * (isComplex ? 2 : 1);
+        size_t count = width * (size_t)points;
+        if (delta) {
+            xe::Vect<uint64_t> prev;
+            xe::Vect<double> values;
+            values.reserve(count);
+            size_t used = (count == 0) ? 0 : xe::Raw_DecodeDelta(in.data() + pos, in.size() - pos, width, count, prev, values);
+            if (count > 0 && used == 0) {
+                std::fprintf(stderr, "%s: truncated data in plot %d\n", argv[1], plots + 1);
+                std::fclose(out);
+                return 1;
+            }
+            std::fwrite(values.data(), sizeof(double), values.size(), out);
+            pos += used;
+            decoded += (long long)count;
+        }
+        else {
+            size_t bytes = count * sizeof(double);
+            if (pos + bytes > in.size()) {
+                std::fprintf(stderr, "%s: truncated data in plot %d\n", argv[1], plots + 1);
+                std::fclose(out);
+                return 1;
+            }
+            std::fwrite(in.data() + pos, 1, bytes, out);
+            pos += bytes;
+        }
+        plots++;
+    }
+    std::fclose(out);
+    std::printf("{\"plots\":%d,\"decoded_values\":%lld,\"input_bytes\":%zu}\n", plots, decoded, in.size());
+    return 0;
+}
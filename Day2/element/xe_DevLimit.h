@@ -0,0 +1,55 @@
+#ifndef XE_DEVLIMIT_H
+#define XE_DEVLIMIT_H
+/*
+* 文件名称：xe_DevLimit.h
+* 摘    要：非线性器件牛顿迭代中的电压限制与旁路判断
+* 作    者：H.J.Xie
+* 完成日期：2025年9月12日
+*/
+#include <cmath>
+#include <algorithm>
+namespace xespice
+{
+// 热电压 kT/q（300.15K）
+const double DEV_VT = 0.025864186;
+
+// PN 结电压限制：vnew 相对 vold 的增量超过 2*vt 且高于临界电压时按对数压缩，
+// 防止指数函数溢出导致牛顿迭代发散；发生限制时 limited 置为 true
+static inline double Dev_PnjLim(double vnew, double vold, double vt, double vcrit, bool& limited) {
+    if (vnew > vcrit && std::abs(vnew - vold) > 2 * vt) {
+        if (vold > 0) {
+            double arg = 1 + (vnew - vold) / vt;
+            vnew = (arg > 0) ? vold + vt * std::log(arg) : vcrit;
+        }
+        else vnew = vt * std::log(vnew / vt);
+        limited = true;
+    }
+    return vnew;
+}
+
+// 场效应管栅源电压限制（简化的 fetlim）：
+// 每次迭代的增量不超过 max(0.5, |vold-vto|) 伏，且不允许一步越过阈值电压过多
+static inline double Dev_FetLim(double vnew, double vold, double vto, bool& limited) {
+    double over = vold - vto;
+    double step = std::max(0.5, std::abs(over));
+    double v = std::min(std::max(vnew, vold - step), vold + step);
+    if (over < 0 && v > vto + 0.5) v = vto + 0.5; // 由截止进入导通时先停在阈值附近
+    if (v != vnew) limited = true;
+    return v;
+}
+
+// 漏源电压限制：每次迭代的增量不超过 max(2, |vold|) 伏
+static inline double Dev_VdsLim(double vnew, double vold, bool& limited) {
+    double step = std::max(2.0, std::abs(vold));
+    double v = std::min(std::max(vnew, vold - step), vold + step);
+    if (v != vnew) limited = true;
+    return v;
+}
+
+// 旁路判断：电压变化小于 reltol*max(|vnew|,|vold|)+vntol 时可沿用上次的器件计算结果
+static inline bool Dev_CanBypass(double vnew, double vold, double reltol, double vntol) {
+    return std::abs(vnew - vold) <= reltol * std::max(std::abs(vnew), std::abs(vold)) + vntol;
+}
+
+} // namespace xespice
+#endif // !XE_DEVLIMIT_H
@@ -2,7 +2,7 @@
 #define XE_ELMCCCS_H
 /*
 * 文件名称：xe_ElmCCCS.h
-* 摘    要：电流控制电流源
+* 摘    要：电流控制电流源（按类型成组存放）
 * 作    者：H.J.Xie
 * 完成日期：2025年8月28日
 */
@@ -10,27 +10,82 @@
 namespace xespice
 {
 
-struct ElmCCCS : Element {
-    int N1 = -1; // 受控节点+
-    int N2 = -1; // 受控节点-
-    int Ix = -1; // 受控电流
-    double K = 0; // 比例系数
+// 电流控制电流源组
+struct GrpCCCS : ElementGroup {
+    Vect<int> N1; // 受控节点+
+    Vect<int> N2; // 受控节点-
+    Vect<int> Ix; // 受控电流
+    Vect<double> K; // 比例系数
+    Vect<int> S; // 矩阵槽位（每个元件 2 个）
 
-    void Create(Circuit* cir, const Vect<String>& arg) override {
+    int Add(Circuit* cir, const Vect<String>& arg) override {
         if (arg.size() < 5) {
             cir->SetError("ERR[F]001--Missing Arguments in element: " + arg[0]);
-            return;
+            return -1;
         }
-        N1 = cir->GetNode(arg[1]);
-        N2 = cir->GetNode(arg[2]);
-        Ix = cir->GetBranch(arg[3]);
-        K = cir->GetValue(arg[4]);
-        cir->Register(this, false, false); // 注册元件
+        N1.push_back(cir->GetNode(arg[1]));
+        N2.push_back(cir->GetNode(arg[2]));
+        Ix.push_back(cir->GetBranch(arg[3]));
+        K.push_back(cir->GetValue(arg[4]));
+        return (int)K.size() - 1;
     }
 
-    void Stamp(Circuit* cir, Equation* equ, bool isOP) override {
-        equ->AddA(N1, Ix, K);
-        equ->AddA(N2, Ix, -K);
+    void Append(const ElementGroup* src, const Vect<int>& map) override {
+        const GrpCCCS* grp = (const GrpCCCS*)src;
+        for (size_t k = 0; k < grp->K.size(); k++) {
+            N1.push_back(Tmpl_Map(map, grp->N1[k]));
+            N2.push_back(Tmpl_Map(map, grp->N2[k]));
+            Ix.push_back(Tmpl_Map(map, grp->Ix[k]));
+            K.push_back(grp->K[k]);
+        }
+    }
+
+    int Size() override {
+        return (int)K.size();
+    }
+
+    void Compile(Circuit* cir, Equation* equ, int k) override {
+        S.resize(K.size() * 2);
+        int* s = &S[(size_t)k * 2];
+        s[0] = equ->SlotA(N1[k], Ix[k]);
+        s[1] = equ->SlotA(N2[k], Ix[k]);
+    }
+
+    bool SetParam(int id, double val) override {
+        K[At(id)] = val;
+        return true;
+    }
+
+    double GetParam(int id) override {
+        return K[At(id)];
+    }
+
+    void Stamp(Circuit* cir, Equation* equ, int begin, int end) override {
+        double* a = equ->DataA();
+        const int* s = S.data();
+        const double* g = K.data();
+        for (int k = begin; k < end; k++) {
+            const int* t = s + (size_t)k * 2;
+            if (t[0]) a[t[0]] += g[k];
+            if (t[1]) a[t[1]] -= g[k];
+        }
+    }
+
+    void StampAC(Circuit* cir, ComplexEquation* equ, double omega) override {
+        std::complex<double>* a = equ->DataA();
+        for (size_t k = 0; k < K.size(); k++) {
+            a[S[2 * k]] += K[k];
+            a[S[2 * k + 1]] -= K[k];
+        }
+    }
+
+protected:
+    void PermuteArrays(const Vect<int>& order) override {
+        Gather(N1, order);
+        Gather(N2, order);
+        Gather(Ix, order);
+        Gather(K, order);
+        Gather(S, order, 2);
     }
 };
 
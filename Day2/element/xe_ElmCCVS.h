@@ -2,7 +2,7 @@
 #define XE_ELMCCVS_H
 /*
 * 文件名称：xe_ElmVCVS.h
-* 摘    要：电流控制电压源
+* 摘    要：电流控制电压源（按类型成组存放）
 * 作    者：H.J.Xie
 * 完成日期：2025年8月28日
 */
@@ -10,32 +10,96 @@
 namespace xespice
 {
 
-struct ElmCCVS : Element {
-    int N1 = -1; // 受控节点+
-    int N2 = -1; // 受控节点-
-    int Ix = -1; // 受控电流
-    int Is = -1; // 支路电流
-    double K = 0; // 比例系数
+// 电流控制电压源组
+struct GrpCCVS : ElementGroup {
+    Vect<int> N1; // 受控节点+
+    Vect<int> N2; // 受控节点-
+    Vect<int> Ix; // 受控电流
+    Vect<int> Is; // 支路电流
+    Vect<double> K; // 比例系数
+    Vect<int> S; // 矩阵槽位（每个元件 5 个）
 
-    void Create(Circuit* cir, const Vect<String>& arg) override {
+    int Add(Circuit* cir, const Vect<String>& arg) override {
         if (arg.size() < 5) {
             cir->SetError("ERR[H]001--Missing Arguments in element: " + arg[0]);
-            return;
+            return -1;
         }
-        Is = cir->GetBranch(arg[0]);
-        N1 = cir->GetNode(arg[1]);
-        N2 = cir->GetNode(arg[2]);
-        Ix = cir->GetBranch(arg[3]);
-        K = cir->GetValue(arg[4]);
-        cir->Register(this, false, false); // 注册元件
-    }
-
-    void Stamp(Circuit* cir, Equation* equ, bool isOP) override {
-        equ->AddA(N1, Is, 1);
-        equ->AddA(N2, Is, -1);
-        equ->AddA(Is, N1, 1);
-        equ->AddA(Is, N2, -1);
-        equ->AddA(Is, Ix, -K);
+        Is.push_back(cir->GetBranch(arg[0]));
+        N1.push_back(cir->GetNode(arg[1]));
+        N2.push_back(cir->GetNode(arg[2]));
+        Ix.push_back(cir->GetBranch(arg[3]));
+        K.push_back(cir->GetValue(arg[4]));
+        return (int)K.size() - 1;
+    }
+
+    void Append(const ElementGroup* src, const Vect<int>& map) override {
+        const GrpCCVS* grp = (const GrpCCVS*)src;
+        for (size_t k = 0; k < grp->K.size(); k++) {
+            N1.push_back(Tmpl_Map(map, grp->N1[k]));
+            N2.push_back(Tmpl_Map(map, grp->N2[k]));
+            Ix.push_back(Tmpl_Map(map, grp->Ix[k]));
+            Is.push_back(Tmpl_Map(map, grp->Is[k]));
+            K.push_back(grp->K[k]);
+        }
+    }
+
+    int Size() override {
+        return (int)K.size();
+    }
+
+    void Compile(Circuit* cir, Equation* equ, int k) override {
+        S.resize(K.size() * 5);
+        int* s = &S[(size_t)k * 5];
+        s[0] = equ->SlotA(N1[k], Is[k]);
+        s[1] = equ->SlotA(N2[k], Is[k]);
+        s[2] = equ->SlotA(Is[k], N1[k]);
+        s[3] = equ->SlotA(Is[k], N2[k]);
+        s[4] = equ->SlotA(Is[k], Ix[k]);
+    }
+
+    bool SetParam(int id, double val) override {
+        K[At(id)] = val;
+        return true;
+    }
+
+    double GetParam(int id) override {
+        return K[At(id)];
+    }
+
+    void Stamp(Circuit* cir, Equation* equ, int begin, int end) override {
+        double* a = equ->DataA();
+        const int* s = S.data();
+        const double* g = K.data();
+        for (int k = begin; k < end; k++) {
+            const int* t = s + (size_t)k * 5;
+            if (t[0]) a[t[0]] += 1;
+            if (t[1]) a[t[1]] -= 1;
+            if (t[2]) a[t[2]] += 1;
+            if (t[3]) a[t[3]] -= 1;
+            if (t[4]) a[t[4]] -= g[k];
+        }
+    }
+
+    void StampAC(Circuit* cir, ComplexEquation* equ, double omega) override {
+        std::complex<double>* a = equ->DataA();
+        for (size_t k = 0; k < K.size(); k++) {
+            const int* t = &S[k * 5];
+            a[t[0]] += 1.0;
+            a[t[1]] -= 1.0;
+            a[t[2]] += 1.0;
+            a[t[3]] -= 1.0;
+            a[t[4]] -= K[k];
+        }
+    }
+
+protected:
+    void PermuteArrays(const Vect<int>& order) override {
+        Gather(N1, order);
+        Gather(N2, order);
+        Gather(Ix, order);
+        Gather(Is, order);
+        Gather(K, order);
+        Gather(S, order, 5);
     }
 };
 
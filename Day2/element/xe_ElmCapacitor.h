@@ -0,0 +1,106 @@
+#ifndef XE_ELMCAPACITOR_H
+#define XE_ELMCAPACITOR_H
+/*
+* 文件名称：xe_ElmCapacitor.h
+* 摘    要：电容元件
+* 作    者：H.J.Xie
+* 完成日期：2025年9月10日
+*/
+#include "../xe_Circuit.h"
+namespace xespice
+{
+
+struct ElmCapacitor : Element {
+    int N1 = -1; // 节点+
+    int N2 = -1; // 节点-
+    double C = 0; // 电容值
+    int S11 = 0, S12 = 0, S21 = 0, S22 = 0; // 矩阵槽位
+    int B1 = 0, B2 = 0; // 向量槽位
+    double Q[4] = {}; // 电荷历史：Q[0] 为当前步，Q[1]~Q[3] 为之前已接受的各步
+    double I[2] = {}; // 电流历史：I[0] 为当前步，I[1] 为上一步
+    double Geq = 0; // 伴随模型的等效电导
+    double Ieq = 0; // 伴随模型的等效电流（i = Geq*v + Ieq）
+
+    void Create(Circuit* cir, const Vect<String>& arg) override {
+        if (arg.size() < 4) {
+            cir->SetError("ERR[C]001--Missing Arguments in element: " + arg[0]);
+            return;
+        }
+        N1 = cir->GetNode(arg[1]);
+        N2 = cir->GetNode(arg[2]);
+        C = cir->GetValue(arg[3]);
+        cir->Register(this, true, false); // 注册元件
+    }
+
+    Element* Clone(Arena& mem, const Vect<int>& map) const override {
+        ElmCapacitor* elm = mem.New<ElmCapacitor>(*this);
+        elm->N1 = Tmpl_Map(map, N1);
+        elm->N2 = Tmpl_Map(map, N2);
+        return elm;
+    }
+
+    void Compile(Circuit* cir, Equation* equ) override {
+        S11 = equ->SlotA(N1, N1);
+        S12 = equ->SlotA(N1, N2);
+        S21 = equ->SlotA(N2, N1);
+        S22 = equ->SlotA(N2, N2);
+        B1 = equ->SlotB(N1);
+        B2 = equ->SlotB(N2);
+    }
+
+    bool SetParam(double val) override {
+        C = val;
+        return true;
+    }
+
+    double GetParam() override {
+        return C;
+    }
+
+    void Stamp(Circuit* cir, Equation* equ, bool isOP) override {
+        if (isOP) return; // 直流时开路
+        const TranInfo& tr = cir->Tran;
+        Geq = tr.Ag[0] * C;
+        Ieq = tr.Ag[1] * Q[1] + tr.Ag[2] * Q[2] + tr.Ai1 * I[1];
+        double* a = equ->DataA();
+        a[S11] += Geq;
+        a[S12] -= Geq;
+        a[S21] -= Geq;
+        a[S22] += Geq;
+        double* b = equ->DataB();
+        b[B1] -= Ieq;
+        b[B2] += Ieq;
+    }
+
+    double Truncate(Circuit* cir, Equation* equ) override {
+        double v = equ->GetX(N1) - equ->GetX(N2);
+        Q[0] = C * v;
+        I[0] = Geq * v + Ieq;
+        return cir->TruncateStep(Q, I[0], I[1], cir->Config.ABSTOL);
+    }
+
+    void Accept(Circuit* cir, Equation* equ) override {
+        double v = equ->GetX(N1) - equ->GetX(N2);
+        if (cir->Tran.Steps == 0) { // 由工作点初始化历史
+            Q[0] = Q[1] = Q[2] = Q[3] = C * v;
+            I[0] = I[1] = 0;
+            return;
+        }
+        Q[3] = Q[2];
+        Q[2] = Q[1];
+        Q[1] = C * v;
+        I[1] = Geq * v + Ieq;
+    }
+
+    void StampAC(Circuit* cir, ComplexEquation* equ, double omega) override {
+        std::complex<double> y(0, omega * C);
+        std::complex<double>* a = equ->DataA();
+        a[S11] += y;
+        a[S12] -= y;
+        a[S21] -= y;
+        a[S22] += y;
+    }
+};
+
+} // namespace xespice
+#endif // !XE_ELMCAPACITOR_H
@@ -7,13 +7,15 @@
 * 完成日期：2025年8月28日
 */
 #include "../xe_Circuit.h"
+#include "xe_SourceWave.h"
 namespace xespice
 {
 
 struct ElmCurrentSource : Element {
     int N1 = -1; // 节点+
     int N2 = -1; // 节点-
-    double Idc = 0; // 直流电流
+    SourceWave Wave; // 波形（含直流值）
+    int B1 = 0, B2 = 0; // 向量槽位
 
     void Create(Circuit* cir, const Vect<String>& arg) override {
         if (arg.size() < 4) {
@@ -22,20 +24,49 @@ struct ElmCurrentSource : Element {
         }
         N1 = cir->GetNode(arg[1]);
         N2 = cir->GetNode(arg[2]);
-        if (arg.size() > 4) {
-            if (arg[3] == "DC") Idc = cir->GetValue(arg[4]);
-            else {
-                cir->SetError("ERR[I]002--Invalid Argument in element: " + arg[0]);
-                return;
-            }
+        if (!Wave.Parse(cir, arg)) {
+            cir->SetError("ERR[I]002--Invalid Argument in element: " + arg[0]);
+            return;
         }
-        else Idc = cir->GetValue(arg[3]);
-        cir->Register(this, false, false); // 注册元件
+        cir->Register(this, Wave.IsDynamic(), false); // 注册元件（时变源在瞬态分析中每步重新 stamp）
+    }
+
+    Element* Clone(Arena& mem, const Vect<int>& map) const override {
+        ElmCurrentSource* elm = mem.New<ElmCurrentSource>(*this);
+        elm->N1 = Tmpl_Map(map, N1);
+        elm->N2 = Tmpl_Map(map, N2);
+        return elm;
+    }
+
+    void Compile(Circuit* cir, Equation* equ) override {
+        B1 = equ->SlotB(N1);
+        B2 = equ->SlotB(N2);
+    }
+
+    bool SetParam(double val) override {
+        Wave.Dc = val;
+        return true;
+    }
+
+    double GetParam() override {
+        return Wave.Dc;
     }
 
     void Stamp(Circuit* cir, Equation* equ, bool isOP) override {
-        equ->AddB(N1, -Idc);
-        equ->AddB(N2, Idc);
+        double i = isOP ? Wave.Dc : Wave.Value(cir->Tran.Time);
+        double* b = equ->DataB();
+        if (N1 >= 0) b[B1] -= i;
+        if (N2 >= 0) b[B2] += i;
+    }
+
+    double Breakpoint(double t) override {
+        return Wave.NextBreak(t);
+    }
+
+    void StampAC(Circuit* cir, ComplexEquation* equ, double omega) override {
+        std::complex<double>* b = equ->DataB();
+        b[B1] -= Wave.Ac();
+        b[B2] += Wave.Ac();
     }
 };
 
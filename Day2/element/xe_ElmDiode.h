@@ -0,0 +1,99 @@
+#ifndef XE_ELMDIODE_H
+#define XE_ELMDIODE_H
+/*
+* 文件名称：xe_ElmDiode.h
+* 摘    要：二极管（理想指数模型，参数由 .MODEL 给出）
+* 作    者：H.J.Xie
+* 完成日期：2025年9月12日
+*/
+#include "../xe_Circuit.h"
+#include "xe_DevLimit.h"
+namespace xespice
+{
+
+struct ElmDiode : Element {
+    int N1 = -1; // 阳极
+    int N2 = -1; // 阴极
+    double Is = 1e-14; // 反向饱和电流（已乘面积）
+    double Vte = DEV_VT; // 发射系数乘热电压 N*Vt
+    double Vcrit = 0; // 临界电压（超过时限制电压增量）
+    int S11 = 0, S12 = 0, S21 = 0, S22 = 0; // 矩阵槽位
+    int B1 = 0, B2 = 0; // 向量槽位
+    bool Evaluated = false; // 是否已计算过工作点
+    double Vd = 0; // 上次计算时的结电压
+    double Gd = 0; // 上次计算得到的电导
+    double Ieq = 0; // 线性化后的等效电流（i = Gd*v + Ieq）
+
+    void Create(Circuit* cir, const Vect<String>& arg) override {
+        if (arg.size() < 4) {
+            cir->SetError("ERR[D]001--Missing Arguments in element: " + arg[0]);
+            return;
+        }
+        N1 = cir->GetNode(arg[1]);
+        N2 = cir->GetNode(arg[2]);
+        const ModelSpec* model = cir->GetModel(arg[3]);
+        if (model == nullptr || model->Type != "d") {
+            cir->SetError("ERR[D]002--Unknown Diode Model in element: " + arg[0]);
+            return;
+        }
+        double area = (arg.size() > 4) ? cir->GetValue(arg[4]) : 1;
+        Is = model->Get("is", 1e-14) * area;
+        Vte = model->Get("n", 1) * DEV_VT;
+        Vcrit = Vte * std::log(Vte / (std::sqrt(2.0) * Is));
+        cir->Register(this, false, true); // 注册元件
+    }
+
+    Element* Clone(Arena& mem, const Vect<int>& map) const override {
+        ElmDiode* elm = mem.New<ElmDiode>(*this);
+        elm->N1 = Tmpl_Map(map, N1);
+        elm->N2 = Tmpl_Map(map, N2);
+        return elm;
+    }
+
+    void Compile(Circuit* cir, Equation* equ) override {
+        S11 = equ->SlotA(N1, N1);
+        S12 = equ->SlotA(N1, N2);
+        S21 = equ->SlotA(N2, N1);
+        S22 = equ->SlotA(N2, N2);
+        B1 = equ->SlotB(N1);
+        B2 = equ->SlotB(N2);
+    }
+
+    void Stamp(Circuit* cir, Equation* equ, bool isOP) override {
+        NewtonInfo& nt = cir->Newton;
+        double v = equ->GetX(N1) - equ->GetX(N2);
+        if (Evaluated && cir->Config.BYPASS && Dev_CanBypass(v, Vd, cir->Config.RELTOL, cir->Config.VNTOL)) {
+            nt.Bypassed++; // 沿用上次的线性化结果
+        }
+        else {
+            if (Evaluated) v = Dev_PnjLim(v, Vd, Vte, Vcrit, nt.Limited);
+            double e = std::exp(std::min(v / Vte, 700.0));
+            double id = Is * (e - 1) + cir->Config.GMIN * v;
+            Gd = Is * e / Vte + cir->Config.GMIN;
+            Ieq = id - Gd * v;
+            Vd = v;
+            Evaluated = true;
+            nt.Evaluated++;
+            nt.AllBypassed = false;
+        }
+        double* a = equ->DataA();
+        a[S11] += Gd;
+        a[S12] -= Gd;
+        a[S21] -= Gd;
+        a[S22] += Gd;
+        double* b = equ->DataB();
+        b[B1] -= Ieq;
+        b[B2] += Ieq;
+    }
+
+    void StampAC(Circuit* cir, ComplexEquation* equ, double omega) override {
+        std::complex<double>* a = equ->DataA(); // 工作点处的小信号电导
+        a[S11] += Gd;
+        a[S12] -= Gd;
+        a[S21] -= Gd;
+        a[S22] += Gd;
+    }
+};
+
+} // namespace xespice
+#endif // !XE_ELMDIODE_H
@@ -0,0 +1,108 @@
+#ifndef XE_ELMINDUCTOR_H
+#define XE_ELMINDUCTOR_H
+/*
+* 文件名称：xe_ElmInductor.h
+* 摘    要：电感元件
+* 作    者：H.J.Xie
+* 完成日期：2025年9月10日
+*/
+#include "../xe_Circuit.h"
+namespace xespice
+{
+
+struct ElmInductor : Element {
+    int N1 = -1; // 节点+
+    int N2 = -1; // 节点-
+    int Is = -1; // 支路电流
+    double L = 0; // 电感值
+    int S1 = 0, S2 = 0, S3 = 0, S4 = 0, S5 = 0; // 矩阵槽位
+    int BS = 0; // 向量槽位
+    double F[4] = {}; // 磁链历史：F[0] 为当前步，F[1]~F[3] 为之前已接受的各步
+    double V[2] = {}; // 电压历史：V[0] 为当前步，V[1] 为上一步
+    double Req = 0; // 伴随模型的等效电阻
+    double Veq = 0; // 伴随模型的等效电压（v = Req*i + Veq）
+
+    void Create(Circuit* cir, const Vect<String>& arg) override {
+        if (arg.size() < 4) {
+            cir->SetError("ERR[L]001--Missing Arguments in element: " + arg[0]);
+            return;
+        }
+        N1 = cir->GetNode(arg[1]);
+        N2 = cir->GetNode(arg[2]);
+        Is = cir->GetBranch(arg[0]);
+        L = cir->GetValue(arg[3]);
+        cir->Register(this, true, false); // 注册元件
+    }
+
+    Element* Clone(Arena& mem, const Vect<int>& map) const override {
+        ElmInductor* elm = mem.New<ElmInductor>(*this);
+        elm->N1 = Tmpl_Map(map, N1);
+        elm->N2 = Tmpl_Map(map, N2);
+        elm->Is = Tmpl_Map(map, Is);
+        return elm;
+    }
+
+    void Compile(Circuit* cir, Equation* equ) override {
+        S1 = equ->SlotA(N1, Is);
+        S2 = equ->SlotA(N2, Is);
+        S3 = equ->SlotA(Is, N1);
+        S4 = equ->SlotA(Is, N2);
+        S5 = equ->SlotA(Is, Is);
+        BS = equ->SlotB(Is);
+    }
+
+    bool SetParam(double val) override {
+        L = val;
+        return true;
+    }
+
+    double GetParam() override {
+        return L;
+    }
+
+    void Stamp(Circuit* cir, Equation* equ, bool isOP) override {
+        double* a = equ->DataA();
+        a[S1] += 1;
+        a[S2] -= 1;
+        a[S3] += 1;
+        a[S4] -= 1;
+        if (isOP) return; // 直流时短路
+        const TranInfo& tr = cir->Tran;
+        Req = tr.Ag[0] * L;
+        Veq = tr.Ag[1] * F[1] + tr.Ag[2] * F[2] + tr.Ai1 * V[1];
+        a[S5] -= Req;
+        equ->DataB()[BS] += Veq;
+    }
+
+    double Truncate(Circuit* cir, Equation* equ) override {
+        double i = equ->GetX(Is);
+        F[0] = L * i;
+        V[0] = Req * i + Veq;
+        return cir->TruncateStep(F, V[0], V[1], cir->Config.VNTOL);
+    }
+
+    void Accept(Circuit* cir, Equation* equ) override {
+        double i = equ->GetX(Is);
+        if (cir->Tran.Steps == 0) { // 由工作点初始化历史
+            F[0] = F[1] = F[2] = F[3] = L * i;
+            V[0] = V[1] = 0;
+            return;
+        }
+        F[3] = F[2];
+        F[2] = F[1];
+        F[1] = L * i;
+        V[1] = Req * i + Veq;
+    }
+
+    void StampAC(Circuit* cir, ComplexEquation* equ, double omega) override {
+        std::complex<double>* a = equ->DataA();
+        a[S1] += 1.0;
+        a[S2] -= 1.0;
+        a[S3] += 1.0;
+        a[S4] -= 1.0;
+        a[S5] -= std::complex<double>(0, omega * L);
+    }
+};
+
+} // namespace xespice
+#endif // !XE_ELMINDUCTOR_H
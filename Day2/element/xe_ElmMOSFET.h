@@ -0,0 +1,166 @@
+#ifndef XE_ELMMOSFET_H
+#define XE_ELMMOSFET_H
+/*
+* 文件名称：xe_ElmMOSFET.h
+* 摘    要：MOS 场效应管（Level 1 Shichman-Hodges 模型，忽略体效应和电容）
+* 作    者：H.J.Xie
+* 完成日期：2025年9月12日
+*/
+#include "../xe_Circuit.h"
+#include "xe_DevLimit.h"
+namespace xespice
+{
+
+struct ElmMOSFET : Element {
+    int ND = -1; // 漏极
+    int NG = -1; // 栅极
+    int NS = -1; // 源极
+    int NB = -1; // 衬底（只作为节点存在）
+    double Type = 1; // 1 为 NMOS，-1 为 PMOS
+    double Vto = 0; // 阈值电压（按 NMOS 方向）
+    double Beta = 0; // KP*W/L
+    double Lambda = 0; // 沟道长度调制系数
+    int SDD = 0, SDG = 0, SDS = 0, SSD = 0, SSG = 0, SSS = 0; // 矩阵槽位
+    int BD = 0, BS = 0; // 向量槽位
+    bool Evaluated = false; // 是否已计算过工作点
+    double Vgs = 0, Vds = 0; // 上次计算时的栅源、漏源电压（按 NMOS 方向）
+    double Gdd = 0, Gdg = 0, Gds = 0; // 漏极电流对 vd、vg、vs 的偏导
+    double Ieq = 0; // 线性化后的等效电流（id = Gdd*vd + Gdg*vg + Gds*vs + Ieq）
+
+    void Create(Circuit* cir, const Vect<String>& arg) override {
+        if (arg.size() < 6) {
+            cir->SetError("ERR[M]001--Missing Arguments in element: " + arg[0]);
+            return;
+        }
+        ND = cir->GetNode(arg[1]);
+        NG = cir->GetNode(arg[2]);
+        NS = cir->GetNode(arg[3]);
+        NB = cir->GetNode(arg[4]);
+        const ModelSpec* model = cir->GetModel(arg[5]);
+        if (model == nullptr || (model->Type != "nmos" && model->Type != "pmos")) {
+            cir->SetError("ERR[M]002--Unknown MOS Model in element: " + arg[0]);
+            return;
+        }
+        double w = 100e-6, l = 100e-6;
+        for (size_t i = 6; i + 1 < arg.size(); i += 2) {
+            if (arg[i] == "w") w = cir->GetValue(arg[i + 1]);
+            else if (arg[i] == "l") l = cir->GetValue(arg[i + 1]);
+            else {
+                cir->SetError("ERR[M]003--Invalid Argument in element: " + arg[0]);
+                return;
+            }
+        }
+        Type = (model->Type == "nmos") ? 1 : -1;
+        Vto = Type * model->Get("vto", 0);
+        Beta = model->Get("kp", 2e-5) * w / l;
+        Lambda = model->Get("lambda", 0);
+        cir->Register(this, false, true); // 注册元件
+    }
+
+    Element* Clone(Arena& mem, const Vect<int>& map) const override {
+        ElmMOSFET* elm = mem.New<ElmMOSFET>(*this);
+        elm->ND = Tmpl_Map(map, ND);
+        elm->NG = Tmpl_Map(map, NG);
+        elm->NS = Tmpl_Map(map, NS);
+        elm->NB = Tmpl_Map(map, NB);
+        return elm;
+    }
+
+    void Compile(Circuit* cir, Equation* equ) override {
+        SDD = equ->SlotA(ND, ND);
+        SDG = equ->SlotA(ND, NG);
+        SDS = equ->SlotA(ND, NS);
+        SSD = equ->SlotA(NS, ND);
+        SSG = equ->SlotA(NS, NG);
+        SSS = equ->SlotA(NS, NS);
+        BD = equ->SlotB(ND);
+        BS = equ->SlotB(NS);
+    }
+
+    // 正向工作时的漏极电流 f(vgs, vds) 及其偏导 gm、gds（vds >= 0）
+    void Drain(double vgs, double vds, double& f, double& gm, double& gds) {
+        double vov = vgs - Vto;
+        if (vov <= 0) { // 截止区
+            f = gm = gds = 0;
+        }
+        else if (vds < vov) { // 线性区
+            double k = 1 + Lambda * vds;
+            double q = vov * vds - 0.5 * vds * vds;
+            f = Beta * q * k;
+            gm = Beta * vds * k;
+            gds = Beta * (vov - vds) * k + Beta * q * Lambda;
+        }
+        else { // 饱和区
+            f = 0.5 * Beta * vov * vov * (1 + Lambda * vds);
+            gm = Beta * vov * (1 + Lambda * vds);
+            gds = 0.5 * Beta * vov * vov * Lambda;
+        }
+    }
+
+    void Stamp(Circuit* cir, Equation* equ, bool isOP) override {
+        NewtonInfo& nt = cir->Newton;
+        double vd = equ->GetX(ND), vg = equ->GetX(NG), vs = equ->GetX(NS);
+        double vgs = Type * (vg - vs), vds = Type * (vd - vs);
+        const Configuration& cfg = cir->Config;
+        if (Evaluated && cfg.BYPASS && Dev_CanBypass(vgs, Vgs, cfg.RELTOL, cfg.VNTOL)
+            && Dev_CanBypass(vds, Vds, cfg.RELTOL, cfg.VNTOL)) {
+            nt.Bypassed++; // 沿用上次的线性化结果
+        }
+        else {
+            if (Evaluated) {
+                vgs = Dev_FetLim(vgs, Vgs, Vto, nt.Limited);
+                vds = Dev_VdsLim(vds, Vds, nt.Limited);
+            }
+            double f, gm, gds, id;
+            if (vds >= 0) { // 正向：电流由漏极流向源极
+                Drain(vgs, vds, f, gm, gds);
+                id = Type * f;
+                Gdg = gm;
+                Gdd = gds;
+                Gds = -gm - gds;
+            }
+            else { // 反向：漏源互换
+                Drain(vgs - vds, -vds, f, gm, gds);
+                id = -Type * f;
+                Gdg = -gm;
+                Gdd = gm + gds;
+                Gds = -gds;
+            }
+            // 漏源之间并联 GMIN 以保证截止时矩阵非奇异
+            Gdd += cfg.GMIN;
+            Gds -= cfg.GMIN;
+            id += cfg.GMIN * Type * vds;
+            // 线性化点为（限制后的）实际端电压
+            double vdl = vs + Type * vds, vgl = vs + Type * vgs;
+            Ieq = id - Gdd * vdl - Gdg * vgl - Gds * vs;
+            Vgs = vgs;
+            Vds = vds;
+            Evaluated = true;
+            nt.Evaluated++;
+            nt.AllBypassed = false;
+        }
+        double* a = equ->DataA();
+        a[SDD] += Gdd;
+        a[SDG] += Gdg;
+        a[SDS] += Gds;
+        a[SSD] -= Gdd;
+        a[SSG] -= Gdg;
+        a[SSS] -= Gds;
+        double* b = equ->DataB();
+        b[BD] -= Ieq;
+        b[BS] += Ieq;
+    }
+
+    void StampAC(Circuit* cir, ComplexEquation* equ, double omega) override {
+        std::complex<double>* a = equ->DataA(); // 工作点处的小信号跨导和输出电导
+        a[SDD] += Gdd;
+        a[SDG] += Gdg;
+        a[SDS] += Gds;
+        a[SSD] -= Gdd;
+        a[SSG] -= Gdg;
+        a[SSS] -= Gds;
+    }
+};
+
+} // namespace xespice
+#endif // !XE_ELMMOSFET_H
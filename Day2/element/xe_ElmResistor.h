@@ -2,7 +2,7 @@
 #define XE_ELMRESISTOR_H
 /*
 * 文件名称：xe_ElmResistor.h
-* 摘    要：电阻元件
+* 摘    要：电阻元件（按类型成组存放）
 * 作    者：H.J.Xie
 * 完成日期：2025年8月28日
 */
@@ -10,27 +10,85 @@
 namespace xespice
 {
 
-struct ElmResistor : Element {
-    int N1 = -1; // 节点+
-    int N2 = -1; // 节点-
-    double G = 0; // 电导值
+// 电阻元件组：各电阻的参数分别连续存放，整组在一个循环中 stamp
+struct GrpResistor : ElementGroup {
+    Vect<int> N1; // 节点+
+    Vect<int> N2; // 节点-
+    Vect<double> G; // 电导值
+    Vect<int> S; // 矩阵槽位（每个元件 4 个：S11 S12 S21 S22）
 
-    void Create(Circuit* cir, const Vect<String>& arg) override {
+    int Add(Circuit* cir, const Vect<String>& arg) override {
         if (arg.size() < 4) {
             cir->SetError("ERR[R]001--Missing Arguments in element: " + arg[0]);
-            return;
+            return -1;
         }
-        N1 = cir->GetNode(arg[1]);
-        N2 = cir->GetNode(arg[2]);
-        G = 1.0 / cir->GetValue(arg[3]);
-        cir->Register(this, false, false); // 注册元件
+        N1.push_back(cir->GetNode(arg[1]));
+        N2.push_back(cir->GetNode(arg[2]));
+        G.push_back(1.0 / cir->GetValue(arg[3]));
+        return (int)G.size() - 1;
     }
 
-    void Stamp(Circuit* cir, Equation* equ, bool isOP) override {
-        equ->AddA(N1, N1, G);
-        equ->AddA(N1, N2, -G);
-        equ->AddA(N2, N1, -G);
-        equ->AddA(N2, N2, G);
+    void Append(const ElementGroup* src, const Vect<int>& map) override {
+        const GrpResistor* grp = (const GrpResistor*)src;
+        for (size_t k = 0; k < grp->G.size(); k++) {
+            N1.push_back(Tmpl_Map(map, grp->N1[k]));
+            N2.push_back(Tmpl_Map(map, grp->N2[k]));
+            G.push_back(grp->G[k]);
+        }
+    }
+
+    int Size() override {
+        return (int)G.size();
+    }
+
+    void Compile(Circuit* cir, Equation* equ, int k) override {
+        S.resize(G.size() * 4);
+        int* s = &S[(size_t)k * 4];
+        s[0] = equ->SlotA(N1[k], N1[k]);
+        s[1] = equ->SlotA(N1[k], N2[k]);
+        s[2] = equ->SlotA(N2[k], N1[k]);
+        s[3] = equ->SlotA(N2[k], N2[k]);
+    }
+
+    bool SetParam(int id, double val) override {
+        G[At(id)] = 1.0 / val;
+        return true;
+    }
+
+    double GetParam(int id) override {
+        return 1.0 / G[At(id)];
+    }
+
+    void Stamp(Circuit* cir, Equation* equ, int begin, int end) override {
+        double* a = equ->DataA();
+        const int* s = S.data();
+        const double* g = G.data();
+        for (int k = begin; k < end; k++) {
+            const int* t = s + (size_t)k * 4;
+            if (t[0]) a[t[0]] += g[k];
+            if (t[1]) a[t[1]] -= g[k];
+            if (t[2]) a[t[2]] -= g[k];
+            if (t[3]) a[t[3]] += g[k];
+        }
+    }
+
+    void StampAC(Circuit* cir, ComplexEquation* equ, double omega) override {
+        std::complex<double>* a = equ->DataA();
+        for (size_t k = 0; k < G.size(); k++) {
+            const int* t = &S[k * 4];
+            a[t[0]] += G[k];
+            a[t[1]] -= G[k];
+            a[t[2]] -= G[k];
+            a[t[3]] += G[k];
+        }
+    }
+
+protected:
+    void PermuteArrays(const Vect<int>& order) override {
+        Gather(N1, order);
+        Gather(N2, order);
+        Gather(G, order);
+        Gather(S, order, 4);
     }
 };
 
@@ -2,7 +2,7 @@
 #define XE_ELMVCCS_H
 /*
 * 文件名称：xe_ElmVCCS.h
-* 摘    要：电压控制电流源
+* 摘    要：电压控制电流源（按类型成组存放）
 * 作    者：H.J.Xie
 * 完成日期：2025年8月28日
 */
@@ -10,31 +10,93 @@
 namespace xespice
 {
 
-struct ElmVCCS : Element {
-    int N1 = -1; // 受控节点+
-    int N2 = -1; // 受控节点-
-    int NC1 = -1; // 控制节点+
-    int NC2 = -1; // 控制节点-
-    double K = 0; // 比例系数
+// 电压控制电流源组
+struct GrpVCCS : ElementGroup {
+    Vect<int> N1; // 受控节点+
+    Vect<int> N2; // 受控节点-
+    Vect<int> NC1; // 控制节点+
+    Vect<int> NC2; // 控制节点-
+    Vect<double> K; // 比例系数
+    Vect<int> S; // 矩阵槽位（每个元件 4 个）
 
-    void Create(Circuit* cir, const Vect<String>& arg) override {
+    int Add(Circuit* cir, const Vect<String>& arg) override {
         if (arg.size() < 6) {
             cir->SetError("ERR[G]001--Missing Arguments in element: " + arg[0]);
-            return;
+            return -1;
         }
-        N1 = cir->GetNode(arg[1]);
-        N2 = cir->GetNode(arg[2]);
-        NC1 = cir->GetNode(arg[3]);
-        NC2 = cir->GetNode(arg[4]);
-        K = cir->GetValue(arg[5]);
-        cir->Register(this, false, false); // 注册元件
-    }
-
-    void Stamp(Circuit* cir, Equation* equ, bool isOP) override {
-        equ->AddA(N1, NC1, K);
-        equ->AddA(N1, NC2, -K);
-        equ->AddA(N2, NC1, -K);
-        equ->AddA(N2, NC2, K);
+        N1.push_back(cir->GetNode(arg[1]));
+        N2.push_back(cir->GetNode(arg[2]));
+        NC1.push_back(cir->GetNode(arg[3]));
+        NC2.push_back(cir->GetNode(arg[4]));
+        K.push_back(cir->GetValue(arg[5]));
+        return (int)K.size() - 1;
+    }
+
+    void Append(const ElementGroup* src, const Vect<int>& map) override {
+        const GrpVCCS* grp = (const GrpVCCS*)src;
+        for (size_t k = 0; k < grp->K.size(); k++) {
+            N1.push_back(Tmpl_Map(map, grp->N1[k]));
+            N2.push_back(Tmpl_Map(map, grp->N2[k]));
+            NC1.push_back(Tmpl_Map(map, grp->NC1[k]));
+            NC2.push_back(Tmpl_Map(map, grp->NC2[k]));
+            K.push_back(grp->K[k]);
+        }
+    }
+
+    int Size() override {
+        return (int)K.size();
+    }
+
+    void Compile(Circuit* cir, Equation* equ, int k) override {
+        S.resize(K.size() * 4);
+        int* s = &S[(size_t)k * 4];
+        s[0] = equ->SlotA(N1[k], NC1[k]);
+        s[1] = equ->SlotA(N1[k], NC2[k]);
+        s[2] = equ->SlotA(N2[k], NC1[k]);
+        s[3] = equ->SlotA(N2[k], NC2[k]);
+    }
+
+    bool SetParam(int id, double val) override {
+        K[At(id)] = val;
+        return true;
+    }
+
+    double GetParam(int id) override {
+        return K[At(id)];
+    }
+
+    void Stamp(Circuit* cir, Equation* equ, int begin, int end) override {
+        double* a = equ->DataA();
+        const int* s = S.data();
+        const double* g = K.data();
+        for (int k = begin; k < end; k++) {
+            const int* t = s + (size_t)k * 4;
+            if (t[0]) a[t[0]] += g[k];
+            if (t[1]) a[t[1]] -= g[k];
+            if (t[2]) a[t[2]] -= g[k];
+            if (t[3]) a[t[3]] += g[k];
+        }
+    }
+
+    void StampAC(Circuit* cir, ComplexEquation* equ, double omega) override {
+        std::complex<double>* a = equ->DataA();
+        for (size_t k = 0; k < K.size(); k++) {
+            const int* t = &S[k * 4];
+            a[t[0]] += K[k];
+            a[t[1]] -= K[k];
+            a[t[2]] -= K[k];
+            a[t[3]] += K[k];
+        }
+    }
+
+protected:
+    void PermuteArrays(const Vect<int>& order) override {
+        Gather(N1, order);
+        Gather(N2, order);
+        Gather(NC1, order);
+        Gather(NC2, order);
+        Gather(K, order);
+        Gather(S, order, 4);
     }
 };
 
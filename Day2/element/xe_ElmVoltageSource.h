@@ -7,6 +7,7 @@
 * 完成日期：2025年8月28日
 */
 #include "../xe_Circuit.h"
+#include "xe_SourceWave.h"
 namespace xespice
 {
 
@@ -14,7 +15,9 @@ struct ElmVoltageSource : Element {
     int N1 = -1; // 节点+
     int N2 = -1; // 节点-
     int Is = -1; // 支路电流
-    double Vdc = 0; // 直流电压
+    SourceWave Wave; // 波形（含直流值）
+    int S1 = 0, S2 = 0, S3 = 0, S4 = 0; // 矩阵槽位
+    int BS = 0; // 向量槽位
 
     void Create(Circuit* cir, const Vect<String>& arg) override {
         if (arg.size() < 4) {
@@ -24,23 +27,59 @@ struct ElmVoltageSource : Element {
         N1 = cir->GetNode(arg[1]);
         N2 = cir->GetNode(arg[2]);
         Is = cir->GetBranch(arg[0]);
-        if (arg.size() > 4) {
-            if (arg[3] == "DC") Vdc = cir->GetValue(arg[4]);
-            else {
-                cir->SetError("ERR[V]002--Invalid Argument in element: " + arg[0]);
-                return;
-            }
+        if (!Wave.Parse(cir, arg)) {
+            cir->SetError("ERR[V]002--Invalid Argument in element: " + arg[0]);
+            return;
         }
-        else Vdc = cir->GetValue(arg[3]);
-        cir->Register(this, false, false); // 注册元件
+        cir->Register(this, Wave.IsDynamic(), false); // 注册元件（时变源在瞬态分析中每步重新 stamp）
+    }
+
+    Element* Clone(Arena& mem, const Vect<int>& map) const override {
+        ElmVoltageSource* elm = mem.New<ElmVoltageSource>(*this);
+        elm->N1 = Tmpl_Map(map, N1);
+        elm->N2 = Tmpl_Map(map, N2);
+        elm->Is = Tmpl_Map(map, Is);
+        return elm;
+    }
+
+    void Compile(Circuit* cir, Equation* equ) override {
+        S1 = equ->SlotA(N1, Is);
+        S2 = equ->SlotA(N2, Is);
+        S3 = equ->SlotA(Is, N1);
+        S4 = equ->SlotA(Is, N2);
+        BS = equ->SlotB(Is);
+    }
+
+    bool SetParam(double val) override {
+        Wave.Dc = val;
+        return true;
+    }
+
+    double GetParam() override {
+        return Wave.Dc;
     }
 
     void Stamp(Circuit* cir, Equation* equ, bool isOP) override {
-        equ->AddA(N1, Is, 1);
-        equ->AddA(N2, Is, -1);
-        equ->AddA(Is, N1, 1);
-        equ->AddA(Is, N2, -1);
-        equ->AddB(Is, Vdc);
+        double* a = equ->DataA();
+        if (S1) a[S1] += 1;
+        if (S2) a[S2] -= 1;
+        if (S3) a[S3] += 1;
+        if (S4) a[S4] -= 1;
+        double v = isOP ? Wave.Dc : Wave.Value(cir->Tran.Time);
+        equ->DataB()[BS] += v;
+    }
+
+    double Breakpoint(double t) override {
+        return Wave.NextBreak(t);
+    }
+
+    void StampAC(Circuit* cir, ComplexEquation* equ, double omega) override {
+        std::complex<double>* a = equ->DataA();
+        a[S1] += 1.0;
+        a[S2] -= 1.0;
+        a[S3] += 1.0;
+        a[S4] -= 1.0;
+        equ->DataB()[BS] += Wave.Ac();
     }
 };
 
@@ -0,0 +1,118 @@
+#ifndef XE_SOURCEWAVE_H
+#define XE_SOURCEWAVE_H
+/*
+* 文件名称：xe_SourceWave.h
+* 摘    要：独立源的时域波形（DC、PULSE、SIN）
+* 作    者：H.J.Xie
+* 完成日期：2025年9月10日
+*/
+#include "../xe_Circuit.h"
+namespace xespice
+{
+// 波形类型
+enum WaveType {
+    WAVE_DC = 0,    // 直流
+    WAVE_PULSE = 1, // PULSE(V1 V2 TD TR TF PW PER)
+    WAVE_SIN = 2    // SIN(VO VA FREQ TD THETA)
+};
+
+// 独立源的波形
+struct SourceWave {
+    int Type = WAVE_DC; // 波形类型
+    double P[7] = {};   // 波形参数
+    double Dc = 0;      // 直流值（用于 OP 和 .DC 分析）
+    double AcMag = 0;   // 交流幅度（用于 .AC 分析）
+    double AcPhase = 0; // 交流相位（度）
+
+    // 从 arg[3] 开始解析 "[DC] v"、"AC mag [phase]"、"PULSE ..." 或 "SIN ..."，返回 false 表示参数有误
+    bool Parse(Circuit* cir, const Vect<String>& arg) {
+        bool hasDc = false;
+        size_t i = 3;
+        while (i < arg.size()) {
+            const String& key = arg[i];
+            if (key == "dc" && i + 1 < arg.size()) {
+                Dc = cir->GetValue(arg[i + 1]);
+                hasDc = true;
+                i += 2;
+            }
+            else if (key == "ac" && i + 1 < arg.size()) {
+                AcMag = cir->GetValue(arg[i + 1]);
+                i += 2;
+                if (i < arg.size() && !std::isnan(Str_ToValue(arg[i]))) { // 可省略的相位
+                    AcPhase = cir->GetValue(arg[i]);
+                    i++;
+                }
+            }
+            else if (key == "pulse" || key == "sin") {
+                Type = (key == "pulse") ? WAVE_PULSE : WAVE_SIN;
+                int count = (Type == WAVE_PULSE) ? 7 : 5;
+                i++;
+                for (int k = 0; k < count && i < arg.size(); k++, i++) P[k] = cir->GetValue(arg[i]);
+            }
+            else if (i == 3) { // 省略 DC 关键字
+                Dc = cir->GetValue(key);
+                hasDc = true;
+                i++;
+            }
+            else return false;
+        }
+        if (!hasDc) Dc = Value(0); // 未给出直流值时取 0 时刻的值
+        return true;
+    }
+
+    // 是否随时间变化
+    bool IsDynamic() const {
+        return Type != WAVE_DC;
+    }
+
+    // 交流小信号激励的相量
+    std::complex<double> Ac() const {
+        return std::polar(AcMag, AcPhase * 3.14159265358979323846 / 180);
+    }
+
+    // t 之后（不含 t）的下一个拐角时刻：PULSE 每个周期的 TD、TR、PW、TF 边沿，SIN 的延迟起点，没有时返回 HUGE_VAL
+    double NextBreak(double t) const {
+        if (Type == WAVE_PULSE) {
+            double td = P[2], tr = P[3], tf = P[4], pw = P[5], per = P[6];
+            if (t < td) return td;
+            if (pw <= 0) return (t < td + tr) ? td + tr : HUGE_VAL; // 上升后保持 v2
+            double edge[4] = { 0, tr, tr + pw, tr + pw + tf };
+            double k = (per > 0) ? std::floor((t - td) / per) : 0;
+            for (int c = 0; c < 2; c++, k++) { // 本周期与下一周期（舍入可能使 t 落在上一周期末尾）
+                double start = td + k * per;
+                for (double e : edge)
+                    if (start + e > t) return start + e;
+                if (per <= 0) break;
+            }
+            return HUGE_VAL;
+        }
+        if (Type == WAVE_SIN) return (t < P[3]) ? P[3] : HUGE_VAL;
+        return HUGE_VAL;
+    }
+
+    // 计算 t 时刻的值
+    double Value(double t) const {
+        if (Type == WAVE_PULSE) {
+            double v1 = P[0], v2 = P[1], td = P[2], tr = P[3], tf = P[4], pw = P[5], per = P[6];
+            if (t < td) return v1;
+            t -= td;
+            if (per > 0) t = std::fmod(t, per);
+            if (t < tr) return (tr > 0) ? v1 + (v2 - v1) * t / tr : v2;
+            t -= tr;
+            if (t < pw || pw <= 0) return v2;
+            t -= pw;
+            if (t < tf) return (tf > 0) ? v2 + (v1 - v2) * t / tf : v1;
+            return v1;
+        }
+        if (Type == WAVE_SIN) {
+            double vo = P[0], va = P[1], freq = P[2], td = P[3], theta = P[4];
+            if (t < td) return vo;
+            t -= td;
+            return vo + va * std::exp(-theta * t) * std::sin(2 * 3.14159265358979323846 * freq * t);
+        }
+        return Dc;
+    }
+};
+
+} // namespace xespice
+#endif // !XE_SOURCEWAVE_H
@@ -0,0 +1,203 @@
+#ifndef XE_ARENA_H
+#define XE_ARENA_H
+/*
+* 文件名称：xe_Arena.h
+* 摘    要：单调增长的内存池（电路构建期间的小对象只需移动指针分配，析构时整体释放）
+* 作    者：H.J.Xie
+* 完成日期：2025年9月22日
+*/
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+#include <new>
+#include <utility>
+#include <type_traits>
+#include "xe_StdType.h"
+namespace xespice
+{
+// 内存块缓存：内存池释放时交回的内存块暂存于此，供之后的内存池直接取用
+// 批处理中依次运行的电路共用一个缓存，后续电路不必重新向系统申请（并触发缺页）
+// 不是线程安全的
+struct BlockCache {
+private:
+    Vect<std::pair<void*, size_t>> Free; // 空闲的内存块及其字节数
+    size_t Bytes = 0; // 空闲块的总字节数
+public:
+    size_t Limit = (size_t)256 << 20; // 缓存字节数的上限，超出时交回的块直接释放
+    long long Hits = 0; // 从缓存取得内存块的次数
+    BlockCache() = default;
+    BlockCache(const BlockCache&) = delete;
+    BlockCache& operator=(const BlockCache&) = delete;
+    // 取出一个不小于 need 字节的空闲块（取其中最小的），bytes 返回块的实际大小，没有时返回 nullptr
+    void* Take(size_t need, size_t& bytes);
+    // 交回一个内存块
+    void Give(void* block, size_t bytes);
+    // 获取缓存的字节数
+    size_t BytesCached() const;
+    // 析构函数，释放全部空闲块
+    ~BlockCache();
+};
+
+inline void* BlockCache::Take(size_t need, size_t& bytes) {
+    size_t best = Free.size();
+    for (size_t k = 0; k < Free.size(); k++) {
+        if (Free[k].second >= need && (best == Free.size() || Free[k].second < Free[best].second)) best = k;
+    }
+    if (best == Free.size()) return nullptr;
+    void* block = Free[best].first;
+    bytes = Free[best].second;
+    Free[best] = Free.back();
+    Free.pop_back();
+    Bytes -= bytes;
+    Hits++;
+    return block;
+}
+
+inline void BlockCache::Give(void* block, size_t bytes) {
+    if (Bytes + bytes > Limit) {
+        std::free(block);
+        return;
+    }
+    Free.emplace_back(block, bytes);
+    Bytes += bytes;
+}
+
+inline size_t BlockCache::BytesCached() const {
+    return Bytes;
+}
+
+inline BlockCache::~BlockCache() {
+    for (auto& block : Free) std::free(block.first);
+}
+
+// 内存池类：从按需申请的内存块中顺序分配，不单独释放
+// 析构函数非平凡的对象登记在池内的链表中，释放时按创建的逆序析构
+// 不是线程安全的，每个电路各有一个
+struct Arena {
+private:
+    static const size_t MIN_BLOCK = 4 * 1024;    // 第一个内存块的大小
+    static const size_t MAX_BLOCK = 1024 * 1024; // 内存块大小的上限（之后的块不再翻倍）
+    // 待析构对象的登记项（分配在池内）
+    struct DtorNode {
+        void (*Fn)(void*); // 析构函数
+        void* Obj;         // 对象地址
+        DtorNode* Next;    // 前一个登记的对象
+    };
+    Vect<std::pair<void*, size_t>> Blocks; // 已申请的内存块及其字节数
+    BlockCache* Cache = nullptr; // 内存块缓存（nullptr 表示直接向系统申请和释放）
+    char* Cur = nullptr; // 当前块中下一个可用的位置
+    char* End = nullptr; // 当前块的末尾
+    size_t NextBlock = MIN_BLOCK; // 下一个内存块的大小
+    DtorNode* Dtors = nullptr; // 待析构对象链表（最近登记的在前）
+    size_t Reserved = 0; // 已申请的内存块总字节数
+    size_t Used = 0; // 已分配出去的字节数
+    long long Count = 0; // 分配的次数
+    // 申请一个至少能容纳 size 字节（按 align 对齐）的新内存块
+    void Grow(size_t size, size_t align);
+public:
+    Arena() = default;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    // 分配 size 字节，按 align 对齐（align 为 2 的幂）
+    void* Alloc(size_t size, size_t align = alignof(std::max_align_t));
+    // 在池中构造一个 T 类型的对象，析构函数非平凡时登记，在 Release 时析构
+    template<typename T, typename... Args>
+    T* New(Args&&... args);
+    // 析构所有登记的对象并释放全部内存块（设置了缓存时交回缓存）
+    void Release();
+    // 设置内存块缓存（之后申请的块先从缓存取，释放时全部交回缓存；缓存须比内存池存在得更久）
+    void SetCache(BlockCache* cache);
+    // 获取分配的次数
+    long long Allocations() const;
+    // 获取已分配出去的字节数
+    size_t BytesUsed() const;
+    // 获取已申请的内存块总字节数
+    size_t BytesReserved() const;
+    // 获取已申请的内存块个数
+    size_t BlockCount() const;
+    // 析构函数
+    ~Arena();
+};
+
+inline void Arena::Grow(size_t size, size_t align) {
+    size_t need = size + align;
+    size_t bytes = std::max(NextBlock, need);
+    size_t got = 0;
+    void* block = Cache ? Cache->Take(bytes, got) : nullptr;
+    if (block) bytes = got;
+    else block = std::malloc(bytes);
+    if (block == nullptr) throw std::bad_alloc();
+    Blocks.emplace_back(block, bytes);
+    Cur = (char*)block;
+    End = Cur + bytes;
+    Reserved += bytes;
+    if (NextBlock < MAX_BLOCK) NextBlock *= 2;
+}
+
+inline void* Arena::Alloc(size_t size, size_t align) {
+    size_t pad = (size_t)(-(uintptr_t)Cur) & (align - 1);
+    if (Cur == nullptr || (size_t)(End - Cur) < pad + size) {
+        Grow(size, align);
+        pad = (size_t)(-(uintptr_t)Cur) & (align - 1);
+    }
+    char* p = Cur + pad;
+    Cur = p + size;
+    Used += size;
+    Count++;
+    return p;
+}
+
+template<typename T, typename... Args>
+inline T* Arena::New(Args&&... args) {
+    T* obj = new (Alloc(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    if (!std::is_trivially_destructible<T>::value) {
+        DtorNode* node = (DtorNode*)Alloc(sizeof(DtorNode), alignof(DtorNode));
+        node->Fn = [](void* p) { ((T*)p)->~T(); };
+        node->Obj = obj;
+        node->Next = Dtors;
+        Dtors = node;
+    }
+    return obj;
+}
+
+inline void Arena::Release() {
+    for (DtorNode* node = Dtors; node != nullptr; node = node->Next) node->Fn(node->Obj);
+    Dtors = nullptr;
+    for (auto& block : Blocks) {
+        if (Cache) Cache->Give(block.first, block.second);
+        else std::free(block.first);
+    }
+    Blocks.clear();
+    Cur = End = nullptr;
+    NextBlock = MIN_BLOCK;
+    Reserved = Used = 0;
+    Count = 0;
+}
+
+inline void Arena::SetCache(BlockCache* cache) {
+    Cache = cache;
+}
+
+inline long long Arena::Allocations() const {
+    return Count;
+}
+
+inline size_t Arena::BytesUsed() const {
+    return Used;
+}
+
+inline size_t Arena::BytesReserved() const {
+    return Reserved;
+}
+
+inline size_t Arena::BlockCount() const {
+    return Blocks.size();
+}
+
+inline Arena::~Arena() {
+    Release();
+}
+
+} // namespace xespice
+#endif // !XE_ARENA_H
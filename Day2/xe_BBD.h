@@ -0,0 +1,458 @@
+#ifndef XE_BBD_H
+#define XE_BBD_H
+/*
+* 文件名称：xe_BBD.h
+* 摘    要：分块加边对角（BBD）撕裂求解：矩阵图划分为互不耦合的块与界面，各块并行分解，界面用 Schur 补求解
+* 作    者：H.J.Xie
+* 完成日期：2025年9月26日
+*/
+#include <algorithm>
+#include <functional>
+#include "xe_StdType.h"
+#include "xe_SparseLU.h"
+#include "xe_Ordering.h"
+#include "xe_ThreadPool.h"
+namespace xespice
+{
+// BBD 撕裂求解器：未知数划分为 K 个块和界面 S，按块排列后矩阵为加边块对角形式
+//   [A_11           A_1S]
+//   [      ...      ... ]
+//   [          A_KK A_KS]
+//   [A_S1 ... A_SK  A_SS]
+// 各块只经界面耦合，A_kk 各自做稀疏 LU 分解（块内选主元），界面方程的系数矩阵为 Schur 补
+//   S = A_SS - sum_k A_Sk A_kk^{-1} A_kS
+// 划分在 A+A^T 的图上递归二分（按广度优先序切开，块内连通、切边少），与编号较小的块相邻的顶点、
+// 对角元为 0 的未知数（电压源等的支路方程，不能在块内作主元）以及连接很多顶点的枢纽（电源线等）放入界面
+// 界面过大（各块的稠密 Schur 补贡献远超矩阵本身）时不适合撕裂，Setup 返回 -1
+// 各块的分解与 Schur 补贡献、两次块替换都在线程池上并行；贡献按块的顺序累加，结果与线程数无关
+struct BBDSolver {
+private:
+    // 一个对角块及其与界面的耦合
+    struct Block {
+        Vect<int> Vars;          // 块内未知数（局部序号 -> 方程序号，升序）
+        Vect<int> Ap, Ai, Ae;    // A_kk 的 CSC 结构（局部行号）及各位置在方程 CSC 数值中的位置
+        Vect<double> Ax;         // A_kk 的数值
+        Vect<int> Q;             // A_kk 的列排序
+        SparseLU<double> LU;     // A_kk 的分解
+        Vect<int> Cols;          // 与块耦合的界面列（界面序号）
+        Vect<int> Cp, Ci, Ce;    // A_kS 按 Cols 的 CSC 结构（局部行号）及数值位置
+        Vect<double> Cv;         // A_kS 的数值（分解时复制，替换时与分解一致）
+        Vect<int> Rows;          // 与块耦合的界面行（界面序号）
+        Vect<int> Rp, Ri, Re;    // A_Sk 按块内列的 CSC 结构（行为 Rows 中的位置）及数值位置
+        Vect<double> Rv;         // A_Sk 的数值
+        Vect<int> SPos;          // Schur 补贡献 (Rows[r], Cols[c]) 在 S 中的位置（[r*|Cols|+c]）
+        Vect<double> Contrib;    // A_Sk A_kk^{-1} A_kS（|Rows|*|Cols|）
+        Vect<double> Bb, Zb;     // 求贡献时的多右端项工作区
+        Vect<double> Y, Z;       // 替换的工作向量
+        bool Ok = true;          // 本次分解是否成功
+    };
+    int N = 0;                   // 方程组规模
+    Vect<int> PartOf;            // 各未知数所属的块（-1 为界面）
+    Vect<int> LocalOf;           // 各未知数在块内或界面中的序号
+    Vect<Block> Blocks;          // 各对角块（不含空块）
+    Vect<int> Border;            // 界面未知数（界面序号 -> 方程序号）
+    Vect<int> Sp, Si;            // Schur 补 S 的 CSC 结构
+    Vect<int> SSrc, SDst;        // A_SS 各元素在方程 CSC 数值中的位置及在 S 中的位置
+    Vect<double> Sx;             // S 的数值
+    Vect<int> SQ;                // S 的列排序
+    SparseLU<double> SLU;        // S 的分解
+    Vect<double> Bs, Xs;         // 界面的右端项和解
+    bool Factored = false;       // 是否已有完整的分解（可以沿用主元顺序）
+    // 在 A+A^T 的图上划分未知数，fixed 标记预先放入界面的未知数（对角元为 0），枢纽顶点也加入其中
+    void Partition(int parts, const int* Ap, const int* Ai, Vect<char>& fixed);
+    // 分解一个块并求其 Schur 补贡献（refactor 为 true 时先尝试沿用主元顺序）
+    bool FactorBlock(Block& blk, const double* Cx, double pivotTol, bool refactor);
+    // 对 0~count-1 执行 fn（有线程池时并行）
+    static void ForEach(ThreadPool* pool, int count, const std::function<void(int)>& fn);
+public:
+    // 建立划分及各块、界面的非零结构（n 为规模，Ap/Ai/Cx 为方程的 CSC 矩阵，parts 为块数，ordering 为 OrderType）
+    // 返回预测的各块与界面 L+U 非零元个数之和（界面按 Schur 补的非零结构估计），界面过大时返回 -1
+    long long Setup(int n, const int* Ap, const int* Ai, const double* Cx, int parts, int ordering);
+    // 分解（refactor 为 true 时沿用上次的主元顺序，失效的块或界面重新选主元），矩阵奇异时返回 false
+    bool Factorize(const double* Cx, double pivotTol, bool refactor, ThreadPool* pool);
+    // 利用分解结果求解 Ax = b
+    void Solve(const double* b, double* x, ThreadPool* pool);
+    // 获取块数
+    int BlockCount() const;
+    // 获取最大块的未知数个数
+    int LargestBlock() const;
+    // 获取界面的未知数个数
+    int BorderSize() const;
+    // 获取各块与界面的 L+U 非零元总数
+    int FactorNNZ() const;
+    // 一次数值重分解的乘加次数（各块分解、Schur 补贡献与界面分解）
+    long long FactorFlops() const;
+};
+
+inline void BBDSolver::ForEach(ThreadPool* pool, int count, const std::function<void(int)>& fn) {
+    if (pool) pool->Run(count, fn);
+    else for (int i = 0; i < count; i++) fn(i);
+}
+
+inline void BBDSolver::Partition(int parts, const int* Ap, const int* Ai, Vect<char>& fixed) {
+    // A+A^T 的邻接表（不含对角元，重复的边不影响划分）
+    Vect<int> xadj(N + 1, 0);
+    for (int j = 0; j < N; j++) {
+        for (int p = Ap[j]; p < Ap[j + 1]; p++) {
+            if (Ai[p] != j) {
+                xadj[Ai[p] + 1]++;
+                xadj[j + 1]++;
+            }
+        }
+    }
+    for (int i = 0; i < N; i++) xadj[i + 1] += xadj[i];
+    Vect<int> adj(xadj[N]), next(xadj.begin(), xadj.end() - 1);
+    for (int j = 0; j < N; j++) {
+        for (int p = Ap[j]; p < Ap[j + 1]; p++) {
+            int i = Ai[p];
+            if (i == j) continue;
+            adj[next[i]++] = j;
+            adj[next[j]++] = i;
+        }
+    }
+    // 度数超过平均值 8 倍的枢纽顶点直接放入界面（否则广度优先的层次很宽，切出的界面很大）
+    int hub = std::max(32, (int)(8LL * xadj[N] / std::max(1, N)));
+    for (int v = 0; v < N; v++) if (xadj[v + 1] - xadj[v] > hub) fixed[v] = 1;
+    // 递归二分：每段按广度优先序重排后切成两段（块数按比例分配），预先放入界面的未知数不参与
+    Vect<int> perm;
+    for (int v = 0; v < N; v++) if (!fixed[v]) perm.push_back(v);
+    PartOf.assign(N, -1);
+    Vect<int> seg(N, -1), mark(N, -1), order;
+    int stamp = 0;
+    struct Range { int Lo, Hi, Parts, First; };
+    Vect<Range> stack = { { 0, (int)perm.size(), std::max(1, parts), 0 } };
+    while (!stack.empty()) {
+        Range r = stack.back();
+        stack.pop_back();
+        if (r.Parts == 1 || r.Hi - r.Lo < 2) {
+            for (int k = r.Lo; k < r.Hi; k++) PartOf[perm[k]] = r.First;
+            continue;
+        }
+        int id = stamp++;
+        for (int k = r.Lo; k < r.Hi; k++) seg[perm[k]] = id;
+        // 广度优先遍历本段（只经过本段的顶点），返回遍历顺序
+        auto bfs = [&](int start, Vect<int>& out) {
+            int m = stamp++;
+            size_t head = out.size();
+            out.push_back(start);
+            mark[start] = m;
+            while (head < out.size()) {
+                int v = out[head++];
+                for (int p = xadj[v]; p < xadj[v + 1]; p++) {
+                    int u = adj[p];
+                    if (seg[u] == id && mark[u] != m) {
+                        mark[u] = m;
+                        out.push_back(u);
+                    }
+                }
+            }
+        };
+        order.clear();
+        Vect<int> comp;
+        int visited = stamp++; // 标记已排入 order 的顶点
+        for (int k = r.Lo; k < r.Hi; k++) {
+            int v = perm[k];
+            if (seg[v] != id || mark[v] == visited) continue;
+            // 从该连通分量的伪外围顶点出发（两次遍历取最远点），使层次结构尽量细长
+            comp.clear();
+            bfs(v, comp);
+            int far = comp.back();
+            comp.clear();
+            bfs(far, comp);
+            for (int u : comp) {
+                mark[u] = visited;
+                order.push_back(u);
+            }
+        }
+        std::copy(order.begin(), order.end(), perm.begin() + r.Lo);
+        int p1 = r.Parts / 2;
+        int mid = r.Lo + (int)((long long)(r.Hi - r.Lo) * p1 / r.Parts);
+        stack.push_back({ mid, r.Hi, r.Parts - p1, r.First + p1 });
+        stack.push_back({ r.Lo, mid, p1, r.First });
+    }
+    // 切边的一端放入界面：与编号较小的块相邻的顶点
+    Vect<char> border(N, 0);
+    for (int v = 0; v < N; v++) {
+        if (PartOf[v] < 0) continue;
+        for (int p = xadj[v]; p < xadj[v + 1]; p++) {
+            int u = adj[p];
+            if (PartOf[u] >= 0 && PartOf[u] < PartOf[v]) {
+                border[v] = 1;
+                break;
+            }
+        }
+    }
+    for (int v = 0; v < N; v++) if (border[v]) PartOf[v] = -1;
+}
+
+inline long long BBDSolver::Setup(int n, const int* Ap, const int* Ai, const double* Cx, int parts, int ordering) {
+    N = n;
+    Factored = false;
+    Vect<char> fixed(N, 1);
+    for (int j = 0; j < N; j++) {
+        for (int p = Ap[j]; p < Ap[j + 1]; p++) if (Ai[p] == j && Cx[p] != 0) fixed[j] = 0;
+    }
+    Partition(parts, Ap, Ai, fixed);
+    // 各块（去掉空块）与界面的序号
+    int maxPart = 0;
+    for (int v = 0; v < N; v++) maxPart = std::max(maxPart, PartOf[v] + 1);
+    Vect<int> blockOf(maxPart, -1);
+    Blocks.clear();
+    Border.clear();
+    LocalOf.assign(N, -1);
+    for (int v = 0; v < N; v++) {
+        int k = PartOf[v];
+        if (k < 0) {
+            LocalOf[v] = (int)Border.size();
+            Border.push_back(v);
+            continue;
+        }
+        if (blockOf[k] < 0) {
+            blockOf[k] = (int)Blocks.size();
+            Blocks.emplace_back();
+        }
+        Block& blk = Blocks[blockOf[k]];
+        LocalOf[v] = (int)blk.Vars.size();
+        blk.Vars.push_back(v);
+    }
+    for (int v = 0; v < N; v++) if (PartOf[v] >= 0) PartOf[v] = blockOf[PartOf[v]];
+    int ns = (int)Border.size();
+    // 块内各列：A_kk 与 A_Sk
+    Vect<int> rowPos(ns, -1);
+    for (Block& blk : Blocks) {
+        int k = (int)(&blk - Blocks.data());
+        blk.Ap.assign(1, 0);
+        blk.Ai.clear(); blk.Ae.clear();
+        blk.Rp.assign(1, 0);
+        blk.Ri.clear(); blk.Re.clear();
+        blk.Rows.clear();
+        for (int v : blk.Vars) {
+            for (int p = Ap[v]; p < Ap[v + 1]; p++) {
+                int i = Ai[p];
+                if (PartOf[i] == k) {
+                    blk.Ai.push_back(LocalOf[i]);
+                    blk.Ae.push_back(p);
+                }
+                else if (PartOf[i] < 0) {
+                    int s = LocalOf[i];
+                    if (rowPos[s] < 0) {
+                        rowPos[s] = (int)blk.Rows.size();
+                        blk.Rows.push_back(s);
+                    }
+                    blk.Ri.push_back(rowPos[s]);
+                    blk.Re.push_back(p);
+                }
+            }
+            blk.Ap.push_back((int)blk.Ai.size());
+            blk.Rp.push_back((int)blk.Ri.size());
+        }
+        for (int s : blk.Rows) rowPos[s] = -1;
+        blk.Cols.clear();
+        blk.Cp.clear();
+        blk.Ci.clear(); blk.Ce.clear();
+    }
+    // 界面各列：A_SS 与 A_kS
+    Vect<Vect<std::pair<int, int>>> colBlocks(ns); // 各界面列耦合的块及其在块的 Cols 中的位置
+    Vect<std::pair<int, int>> ss; // A_SS 各元素：（数值位置，行的界面序号）
+    Vect<int> ssStart(ns + 1, 0);
+    for (int s = 0; s < ns; s++) {
+        int v = Border[s];
+        for (int p = Ap[v]; p < Ap[v + 1]; p++) {
+            int i = Ai[p];
+            int k = PartOf[i];
+            if (k < 0) {
+                ss.emplace_back(p, LocalOf[i]);
+                continue;
+            }
+            Block& blk = Blocks[k];
+            if (blk.Cols.empty() || blk.Cols.back() != s) {
+                colBlocks[s].emplace_back(k, (int)blk.Cols.size());
+                blk.Cols.push_back(s);
+                blk.Cp.push_back((int)blk.Ci.size());
+            }
+            blk.Ci.push_back(LocalOf[i]);
+            blk.Ce.push_back(p);
+        }
+        ssStart[s + 1] = (int)ss.size();
+    }
+    // 各块稠密贡献的总规模远超矩阵本身时，界面近乎稠密，撕裂没有收益
+    long long dense = 0;
+    for (const Block& blk : Blocks) dense += (long long)blk.Rows.size() * blk.Cols.size();
+    if (dense > std::max(1LL << 20, 16LL * Ap[N])) {
+        Blocks.clear();
+        Border.clear();
+        return -1;
+    }
+    for (Block& blk : Blocks) {
+        blk.Cp.push_back((int)blk.Ci.size());
+        blk.SPos.assign(blk.Rows.size() * blk.Cols.size(), 0);
+    }
+    // Schur 补的非零结构：A_SS 以及各块的 Rows x Cols
+    Sp.assign(1, 0);
+    Si.clear();
+    SSrc.clear();
+    SDst.clear();
+    Vect<int> posOf(ns, -1);
+    for (int s = 0; s < ns; s++) {
+        int begin = (int)Si.size();
+        auto add = [&](int r) {
+            if (posOf[r] < 0) {
+                posOf[r] = (int)Si.size();
+                Si.push_back(r);
+            }
+        };
+        for (int e = ssStart[s]; e < ssStart[s + 1]; e++) add(ss[e].second);
+        for (auto& kc : colBlocks[s]) for (int r : Blocks[kc.first].Rows) add(r);
+        for (int e = ssStart[s]; e < ssStart[s + 1]; e++) {
+            SSrc.push_back(ss[e].first);
+            SDst.push_back(posOf[ss[e].second]);
+        }
+        for (auto& kc : colBlocks[s]) {
+            Block& blk = Blocks[kc.first];
+            int nc = (int)blk.Cols.size();
+            for (int r = 0; r < (int)blk.Rows.size(); r++) blk.SPos[(size_t)r * nc + kc.second] = posOf[blk.Rows[r]];
+        }
+        for (int p = begin; p < (int)Si.size(); p++) posOf[Si[p]] = -1;
+        Sp.push_back((int)Si.size());
+    }
+    Sx.assign(Si.size(), 0.0);
+    Bs.assign(ns, 0.0);
+    Xs.assign(ns, 0.0);
+    // 各块与界面的填充缩减排序
+    long long pred = 0;
+    for (Block& blk : Blocks) pred += Ord_Compute(blk.Q, (int)blk.Vars.size(), blk.Ap.data(), blk.Ai.data(), ordering);
+    if (ns > 0) pred += Ord_Compute(SQ, ns, Sp.data(), Si.data(), ordering);
+    return pred;
+}
+
+inline bool BBDSolver::FactorBlock(Block& blk, const double* Cx, double pivotTol, bool refactor) {
+    int nk = (int)blk.Vars.size();
+    blk.Ax.resize(blk.Ae.size());
+    for (size_t p = 0; p < blk.Ae.size(); p++) blk.Ax[p] = Cx[blk.Ae[p]];
+    blk.Cv.resize(blk.Ce.size());
+    for (size_t p = 0; p < blk.Ce.size(); p++) blk.Cv[p] = Cx[blk.Ce[p]];
+    blk.Rv.resize(blk.Re.size());
+    for (size_t p = 0; p < blk.Re.size(); p++) blk.Rv[p] = Cx[blk.Re[p]];
+    bool ok = refactor && blk.LU.Refactorize(blk.Ap.data(), blk.Ai.data(), blk.Ax.data(), pivotTol);
+    if (!ok) ok = blk.LU.Factorize(nk, blk.Ap.data(), blk.Ai.data(), blk.Ax.data(), blk.Q.data(), pivotTol);
+    if (!ok) return false;
+    // Schur 补贡献：A_kk Z = A_kS（每次 m 列一起替换），再左乘 A_Sk
+    int nc = (int)blk.Cols.size(), nr = (int)blk.Rows.size();
+    blk.Contrib.assign((size_t)nr * nc, 0.0);
+    if (nr == 0 || nc == 0) return true;
+    const int m = 16;
+    blk.Bb.resize((size_t)nk * m);
+    blk.Zb.resize((size_t)nk * m);
+    for (int c0 = 0; c0 < nc; c0 += m) {
+        int w = std::min(m, nc - c0);
+        std::fill(blk.Bb.begin(), blk.Bb.begin() + (size_t)nk * w, 0.0);
+        for (int t = 0; t < w; t++) {
+            for (int p = blk.Cp[c0 + t]; p < blk.Cp[c0 + t + 1]; p++) blk.Bb[(size_t)blk.Ci[p] * w + t] += blk.Cv[p];
+        }
+        blk.LU.SolveBatch(w, blk.Bb.data(), blk.Zb.data());
+        for (int j = 0; j < nk; j++) {
+            const double* z = blk.Zb.data() + (size_t)j * w;
+            for (int p = blk.Rp[j]; p < blk.Rp[j + 1]; p++) {
+                double v = blk.Rv[p];
+                double* dst = blk.Contrib.data() + (size_t)blk.Ri[p] * nc + c0;
+                for (int t = 0; t < w; t++) dst[t] += v * z[t];
+            }
+        }
+    }
+    return true;
+}
+
+inline bool BBDSolver::Factorize(const double* Cx, double pivotTol, bool refactor, ThreadPool* pool) {
+    refactor = refactor && Factored;
+    Factored = false;
+    int nb = (int)Blocks.size();
+    ForEach(pool, nb, [&](int k) {
+        Blocks[k].Ok = FactorBlock(Blocks[k], Cx, pivotTol, refactor);
+    });
+    for (const Block& blk : Blocks) if (!blk.Ok) return false;
+    // S = A_SS - sum_k A_Sk A_kk^{-1} A_kS（按块的顺序累加）
+    std::fill(Sx.begin(), Sx.end(), 0.0);
+    for (size_t e = 0; e < SSrc.size(); e++) Sx[SDst[e]] += Cx[SSrc[e]];
+    for (const Block& blk : Blocks) {
+        for (size_t t = 0; t < blk.SPos.size(); t++) Sx[blk.SPos[t]] -= blk.Contrib[t];
+    }
+    int ns = (int)Border.size();
+    if (ns > 0) {
+        bool ok = refactor && SLU.Refactorize(Sp.data(), Si.data(), Sx.data(), pivotTol);
+        if (!ok) ok = SLU.Factorize(ns, Sp.data(), Si.data(), Sx.data(), SQ.data(), pivotTol);
+        if (!ok) return false;
+    }
+    Factored = true;
+    return true;
+}
+
+inline void BBDSolver::Solve(const double* b, double* x, ThreadPool* pool) {
+    int nb = (int)Blocks.size(), ns = (int)Border.size();
+    // y_k = A_kk^{-1} b_k
+    ForEach(pool, nb, [&](int k) {
+        Block& blk = Blocks[k];
+        int nk = (int)blk.Vars.size();
+        blk.Y.resize(nk);
+        blk.Z.resize(nk);
+        for (int j = 0; j < nk; j++) blk.Y[j] = b[blk.Vars[j]];
+        blk.LU.Solve(blk.Y.data(), blk.Z.data());
+    });
+    if (ns > 0) {
+        // 界面：S x_S = b_S - sum_k A_Sk y_k
+        for (int s = 0; s < ns; s++) Bs[s] = b[Border[s]];
+        for (const Block& blk : Blocks) {
+            for (int j = 0; j < (int)blk.Vars.size(); j++) {
+                double z = blk.Z[j];
+                for (int p = blk.Rp[j]; p < blk.Rp[j + 1]; p++) Bs[blk.Rows[blk.Ri[p]]] -= blk.Rv[p] * z;
+            }
+        }
+        SLU.Solve(Bs.data(), Xs.data());
+        for (int s = 0; s < ns; s++) x[Border[s]] = Xs[s];
+    }
+    // x_k = A_kk^{-1} (b_k - A_kS x_S)
+    ForEach(pool, nb, [&](int k) {
+        Block& blk = Blocks[k];
+        int nk = (int)blk.Vars.size();
+        if (ns > 0 && !blk.Cols.empty()) {
+            for (int j = 0; j < nk; j++) blk.Y[j] = b[blk.Vars[j]];
+            for (int c = 0; c < (int)blk.Cols.size(); c++) {
+                double xs = Xs[blk.Cols[c]];
+                for (int p = blk.Cp[c]; p < blk.Cp[c + 1]; p++) blk.Y[blk.Ci[p]] -= blk.Cv[p] * xs;
+            }
+            blk.LU.Solve(blk.Y.data(), blk.Z.data());
+        }
+        for (int j = 0; j < nk; j++) x[blk.Vars[j]] = blk.Z[j];
+    });
+}
+
+inline int BBDSolver::BlockCount() const {
+    return (int)Blocks.size();
+}
+
+inline int BBDSolver::LargestBlock() const {
+    int n = 0;
+    for (const Block& blk : Blocks) n = std::max(n, (int)blk.Vars.size());
+    return n;
+}
+
+inline int BBDSolver::BorderSize() const {
+    return (int)Border.size();
+}
+
+inline int BBDSolver::FactorNNZ() const {
+    int nnz = Border.empty() ? 0 : SLU.FactorNNZ();
+    for (const Block& blk : Blocks) nnz += blk.LU.FactorNNZ();
+    return nnz;
+}
+
+inline long long BBDSolver::FactorFlops() const {
+    long long flops = Border.empty() ? 0 : SLU.FactorFlops();
+    for (const Block& blk : Blocks) {
+        flops += blk.LU.FactorFlops();
+        flops += (long long)blk.Cols.size() * 2 * blk.LU.FactorNNZ() + (long long)blk.Rv.size() * blk.Cols.size();
+    }
+    return flops;
+}
+
+} // namespace xespice
+#endif // !XE_BBD_H
@@ -0,0 +1,179 @@
+#ifndef XE_BATCH_H
+#define XE_BATCH_H
+/*
+* 文件名称：xe_Batch.h
+* 摘    要：批处理与服务模式：一个进程依次运行多个网表，各作业共用工作区并报告各自的耗时
+* 作    者：H.J.Xie
+* 完成日期：2025年9月26日
+*/
+#include <iostream>
+#include <sstream>
+#include <cerrno>
+#include <cstring>
+#include "xe_Simulator.h"
+#include "xe_Workspace.h"
+#include "xe_Stats.h"
+#include "xe_Timer.h"
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#define XE_UNIX_SOCKET 1 // 支持 UNIX 域套接字
+#else
+#define XE_UNIX_SOCKET 0
+#endif
+namespace xespice
+{
+// 批处理作业：输入网表与输出文件的路径
+struct BatchJob {
+    String Input = "";
+    String Output = "";
+};
+
+// 让释放的堆内存留在进程中（glibc 默认把大块内存直接 mmap/munmap，并把堆顶的空闲内存归还系统）
+// 后续作业的矩阵和分解向量可直接复用已缺页的内存
+static inline void Batch_RetainHeap() {
+#if defined(__GLIBC__)
+    mallopt(M_MMAP_THRESHOLD, 32 << 20); // 32MB 以下的分配都从堆中取（glibc 允许的上限）
+    mallopt(M_TRIM_THRESHOLD, 1 << 30);  // 堆顶空闲不到 1GB 时不归还系统
+#endif
+}
+
+// 解析一行作业描述 "输入 [输出]"（省略输出时为输入路径加 ".out"），空行和 '#' 开头的行返回 false
+static inline bool Batch_ParseJob(const String& line, BatchJob& job) {
+    std::istringstream is(line);
+    job.Input.clear();
+    job.Output.clear();
+    if (!(is >> job.Input) || job.Input[0] == '#') return false;
+    if (!(is >> job.Output)) job.Output = job.Input + ".out";
+    return true;
+}
+
+// 在工作区中运行一个作业（id 为作业序号，stats 为命令行要求的 STATS 级别，threads > 0 时覆盖网表的 THREADS），
+// 返回一行 JSON 报告。作业失败（含异常）不影响进程继续运行后续作业
+static inline String Batch_RunJob(Workspace& ws, const BatchJob& job, int id, int stats, bool& ok, int threads = 0) {
+    double t0 = Timer_Now();
+    long long blockHits = ws.Blocks.Hits;
+    long long srcHits = ws.SourceHits, srcMisses = ws.SourceMisses;
+    SimResult res = Simulate(job.Input, job.Output, &ws, threads, stats);
+    const PhaseTimes& time = res.Timing;
+    const String& error = res.Error;
+    ok = res.Ok;
+    std::ostringstream os;
+    os << "{\"job\": " << id << ", \"input\": " << Json_Quote(job.Input) << ", \"output\": " << Json_Quote(job.Output);
+    os << ", \"ok\": " << (ok ? "true" : "false") << ", \"error\": " << Json_Quote(error);
+    os << ", \"times\": {\"read\": " << Json_Number(time.Read) << ", \"create\": " << Json_Number(time.Create);
+    os << ", \"compile\": " << Json_Number(time.Compile) << ", \"stamp\": " << Json_Number(time.Stamp);
+    os << ", \"factor\": " << Json_Number(time.Factor) << ", \"solve\": " << Json_Number(time.Solve);
+    os << ", \"run\": " << Json_Number(time.Run) << ", \"total\": " << Json_Number(Timer_Now() - t0) << "}";
+    os << ", \"warm\": {\"arena_blocks_reused\": " << ws.Blocks.Hits - blockHits;
+    os << ", \"lib_hits\": " << ws.SourceHits - srcHits << ", \"lib_misses\": " << ws.SourceMisses - srcMisses;
+    os << ", \"cached_bytes\": " << ws.Blocks.BytesCached() << "}}";
+    return os.str();
+}
+
+// 依次运行输入流中的作业（每行一个），每个作业的报告写一行到 out，最后写一行汇总，返回失败的作业个数
+static inline int Batch_RunStream(Workspace& ws, std::istream& in, std::ostream& out, int stats) {
+    double t0 = Timer_Now();
+    int count = 0, failed = 0;
+    String line;
+    BatchJob job;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!Batch_ParseJob(line, job)) continue;
+        bool ok = false;
+        out << Batch_RunJob(ws, job, ++count, stats, ok) << std::endl; // 每个作业完成即输出，便于调用方流式读取
+        if (!ok) failed++;
+    }
+    out << "{\"jobs\": " << count << ", \"failed\": " << failed << ", \"total\": " << Json_Number(Timer_Now() - t0);
+    out << ", \"lib_cached\": " << ws.SourceCount() << "}" << std::endl;
+    return failed;
+}
+
+#if XE_UNIX_SOCKET
+// 向套接字写完整个字符串，返回 false 表示连接已断开
+static inline bool Batch_SendAll(int fd, const String& s) {
+    size_t sent = 0;
+    while (sent < s.size()) {
+#ifdef MSG_NOSIGNAL
+        ssize_t n = send(fd, s.data() + sent, s.size() - sent, MSG_NOSIGNAL); // 对方关闭时不产生 SIGPIPE
+#else
+        ssize_t n = send(fd, s.data() + sent, s.size() - sent, 0);
+#endif
+        if (n <= 0) return false;
+        sent += (size_t)n;
+    }
+    return true;
+}
+#endif
+
+// 服务模式：在 UNIX 域套接字 path 上监听，连接依次处理，每个连接可发送多行作业描述，
+// 每个作业完成后回送一行报告；收到 "quit" 行时回送确认并结束服务。返回 false 表示无法监听（error 为原因）
+static inline bool Batch_Serve(Workspace& ws, const String& path, int stats, String& error) {
+#if XE_UNIX_SOCKET
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        error = "ERR035--Cannot listen on socket: " + path;
+        return false;
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size());
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0) {
+        error = "ERR035--Cannot listen on socket: " + path;
+        return false;
+    }
+    unlink(path.c_str()); // 删除上次遗留的套接字文件
+    if (bind(server, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(server, 16) != 0) {
+        close(server);
+        error = "ERR035--Cannot listen on socket: " + path;
+        return false;
+    }
+    int count = 0;
+    bool quit = false;
+    while (!quit) {
+        int conn = accept(server, nullptr, nullptr);
+        if (conn < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        String buf;
+        char chunk[4096];
+        bool alive = true;
+        while (alive && !quit) {
+            ssize_t n = recv(conn, chunk, sizeof(chunk), 0);
+            if (n <= 0) break; // 对方关闭连接
+            buf.append(chunk, (size_t)n);
+            size_t pos;
+            while (alive && !quit && (pos = buf.find('\n')) != String::npos) {
+                String line = buf.substr(0, pos);
+                buf.erase(0, pos + 1);
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                BatchJob job;
+                if (line == "quit") {
+                    quit = true;
+                    Batch_SendAll(conn, "{\"quit\": true, \"jobs\": " + std::to_string(count) + "}\n");
+                }
+                else if (Batch_ParseJob(line, job)) {
+                    bool ok = false;
+                    alive = Batch_SendAll(conn, Batch_RunJob(ws, job, ++count, stats, ok) + "\n");
+                }
+            }
+        }
+        close(conn);
+    }
+    close(server);
+    unlink(path.c_str());
+    return true;
+#else
+    error = "ERR035--UNIX socket server is not supported on this platform";
+    return false;
+#endif
+}
+
+} // namespace xespice
+#endif // !XE_BATCH_H
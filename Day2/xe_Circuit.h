@@ -10,31 +10,253 @@
 #include "xe_Equation.h"
 #include "xe_Configuration.h"
 #include "xe_Parse.h"
+#include "xe_MappedFile.h"
+#include "xe_Arena.h"
+#include "xe_SymbolTable.h"
+#include "xe_Writer.h"
+#include "xe_LowRank.h"
+#include "xe_Stats.h"
+#include "xe_Workspace.h"
+#include <sstream>
+#include <random>
+#include <limits>
 namespace xespice
 {
 
 struct Circuit; // 电路类（前向声明）
+// 子电路模板中的局部未知量编号映射为实例中的编号（负数表示地，不变）
+static inline int Tmpl_Map(const Vect<int>& map, int i) {
+    return (i < 0) ? i : map[i];
+}
 // 电路元件类（抽象类）
 struct Element {
     // 根据字符串列表创建元件
     virtual void Create(Circuit* cir, const Vect<String>& arg) = 0;
+    // 编译 stamp：预先取得元件在 MNA 方程中的矩阵和向量槽位，之后的 Stamp 只需按槽位写入数值
+    // （默认不做任何事，此时 Stamp 应通过 AddA/AddB 写入）
+    virtual void Compile(Circuit* cir, Equation* equ) {};
     // 元件 stamp 到 MNA 方程（isOP 表示是否为直流工作点分析）
     virtual void Stamp(Circuit* cir, Equation* equ, bool isOP) = 0;
+    // 交流小信号 stamp 到复数方程（与 Stamp 使用相同的槽位，omega 为角频率）
+    // 非线性元件使用工作点处的线性化参数
+    virtual void StampAC(Circuit* cir, ComplexEquation* equ, double omega) {};
+    // 设置元件的主参数（如独立源的直流值），返回 false 表示该元件不支持
+    virtual bool SetParam(double val) { return false; };
+    // 获取元件的主参数
+    virtual double GetParam() { return 0; };
+    // 瞬态分析中求解完一步后，由解计算本步的状态并返回建议的下一步长（默认不限制步长）
+    virtual double Truncate(Circuit* cir, Equation* equ) { return HUGE_VAL; };
+    // 瞬态分析中接受一步（Tran.Steps 为 0 时表示由工作点初始化历史）
+    virtual void Accept(Circuit* cir, Equation* equ) {};
+    // 瞬态分析中 t 之后的下一个断点（波形的拐角），步长须落在断点上（默认没有断点）
+    virtual double Breakpoint(double t) { return HUGE_VAL; };
+    // 复制出子电路实例中的元件：本元件属于子电路模板（未知量为局部编号），按 map 映射为实例中的编号
+    virtual Element* Clone(Arena& mem, const Vect<int>& map) const = 0;
     // 析构函数
     virtual ~Element() {};
 };
-// 电路元件构造函数（由小写字母指定电路元件类型）
-using ElementCtor = Element*(*)(char ch);
+// 电路元件组类（抽象类）：大量同类型的固定线性元件按类型成组，各参数分别连续存放在数组中
+// 整组只需一次虚函数调用，在紧凑的循环中 stamp；组内元件以创建编号（Add 的返回值）引用
+struct ElementGroup {
+    // 根据字符串列表创建一个元件，返回其创建编号
+    virtual int Add(Circuit* cir, const Vect<String>& arg) = 0;
+    // 获取元件个数
+    virtual int Size() = 0;
+    // 编译数组中第 k 个元件的 stamp 槽位
+    virtual void Compile(Circuit* cir, Equation* equ, int k) = 0;
+    // 将数组中第 begin~end-1 个元件 stamp 到 MNA 方程（固定元件，直流和瞬态相同）
+    virtual void Stamp(Circuit* cir, Equation* equ, int begin, int end) = 0;
+    // 将全部元件 stamp 到交流小信号方程
+    virtual void StampAC(Circuit* cir, ComplexEquation* equ, double omega) = 0;
+    // 设置第 id 个（创建编号）元件的主参数，返回 false 表示不支持
+    virtual bool SetParam(int id, double val) { return false; };
+    // 获取第 id 个（创建编号）元件的主参数
+    virtual double GetParam(int id) { return 0; };
+    // 追加子电路实例中的元件：src 为子电路模板中的同类型元件组（未知量为局部编号），按 map 映射为实例中的编号
+    virtual void Append(const ElementGroup* src, const Vect<int>& map) = 0;
+    // 按 order 重排数组（重排后第 i 个为原来的第 order[i] 个），编译后用于使同色元件连续存放
+    void Reorder(const Vect<int>& order);
+    // 编译创建编号为 id 的元件的 stamp 槽位
+    void CompileOne(Circuit* cir, Equation* equ, int id) { Compile(cir, equ, At(id)); }
+    // 将创建编号为 id 的元件单独 stamp 到 MNA 方程
+    void StampOne(Circuit* cir, Equation* equ, int id) { Stamp(cir, equ, At(id), At(id) + 1); }
+    // 析构函数
+    virtual ~ElementGroup() {};
+protected:
+    Vect<int> Ids; // 数组中各位置的元件的创建编号（未重排时为空）
+    Vect<int> Pos; // 各创建编号的元件在数组中的位置（未重排时为空）
+    // 重排派生类的各个数组（对每个数组调用 Gather）
+    virtual void PermuteArrays(const Vect<int>& order) = 0;
+    // 按 order 重排一个数组（每个元件占 w 个连续元素）
+    template<typename T>
+    static void Gather(Vect<T>& v, const Vect<int>& order, int w = 1);
+    // 创建编号对应的数组位置
+    int At(int id) { return Pos.empty() ? id : Pos[id]; }
+};
+// 元件引用：独立的元件对象，或元件组中的一个元件
+struct ElmRef {
+    Element* Elm = nullptr; // 元件对象
+    ElementGroup* Grp = nullptr; // 元件所在的组
+    int Id = -1; // 组内的创建编号
+    bool Fixed = false; // 是否为固定元件（成组的元件都是固定元件）
+    // 是否引用了元件
+    bool Valid() const { return Elm != nullptr || Grp != nullptr; }
+    // 设置元件的主参数
+    bool SetParam(double val) { return Elm ? Elm->SetParam(val) : Grp->SetParam(Id, val); }
+    // 获取元件的主参数
+    double GetParam() { return Elm ? Elm->GetParam() : Grp->GetParam(Id); }
+};
+// 扫描参数（.DC 的一个扫描源）
+struct SweepSpec {
+    String Name = ""; // 扫描元件名
+    double Start = 0; // 起始值
+    double Stop = 0;  // 终止值
+    double Step = 0;  // 步长
+    int Count = 0;    // 扫描点数
+};
+// 参数扫描的分布类型
+enum StepDistType {
+    STEP_VALUES = 0, // .STEP 给出的取值列表
+    STEP_UNIF = 1,   // .MC 均匀分布：原值 * (1 + Tol * U(-1,1))
+    STEP_GAUSS = 2   // .MC 正态分布：原值 * (1 + Tol * N(0,1))
+};
+// 参数扫描的一个对象（.STEP 或 .MC 中的一个元件）
+struct StepSpec {
+    String Name = "";     // 元件名
+    int Dist = STEP_VALUES; // 分布类型（StepDistType）
+    Vect<double> Values;  // .STEP 的取值列表
+    double Tol = 0;       // .MC 的相对容差
+};
+// 交流分析的扫描方式
+enum AcSweepType {
+    AC_DEC = 0, // 每十倍频程 Points 个点
+    AC_OCT = 1, // 每倍频程 Points 个点
+    AC_LIN = 2  // 共 Points 个点线性分布
+};
+// 交流分析参数（.AC）
+struct AcSpec {
+    int Type = AC_DEC; // 扫描方式（AcSweepType）
+    int Points = 0;    // 点数（为 0 表示不进行交流分析）
+    double Start = 0;  // 起始频率
+    double Stop = 0;   // 终止频率
+};
+// 瞬态分析参数（.TRAN）
+struct TranSpec {
+    double Step = 0;  // 输出步长
+    double Stop = 0;  // 终止时间（为 0 表示不进行瞬态分析）
+    double Start = 0; // 开始输出的时间
+    double Max = 0;   // 最大步长
+};
+// 瞬态分析的积分信息（供动态元件使用）
+// 对状态量 q（电荷或磁链），当前步的导数近似为 Ag[0]*q(n+1) + Ag[1]*q(n) + Ag[2]*q(n-1) + Ai1*q'(n)
+struct TranInfo {
+    double Time = 0;    // 当前求解的时刻
+    double Ag[3] = {};  // 积分系数
+    double Ai1 = 0;     // 梯形法中上一步导数的系数
+    int Order = 1;      // 积分阶数
+    int Steps = 0;      // 已接受的步数
+    double T[4] = {};   // 时刻历史：T[0] 为当前步，T[1]~T[3] 为之前已接受的各步
+};
+// 器件模型（.MODEL name type param value ...）
+struct ModelSpec {
+    String Type = ""; // 模型类型（如 d、nmos、pmos）
+    Dict<double> Param; // 模型参数（小写参数名）
+    // 获取参数，未给出时返回默认值 def
+    double Get(const String& key, double def) const {
+        auto iter = Param.find(key);
+        return (iter == Param.end()) ? def : iter->second;
+    }
+};
+// 子电路模板：定义中的元件只解析一次（首次实例化时），未知量用局部编号表示，嵌套的实例已展开在内
+// 实例化时只需把局部编号映射为实例中的编号，再复制元件
+struct SubcktTemplate {
+    bool Building = false; // 是否正在建立（定义直接或间接引用自身时会遇到）
+    Vect<int> VarPort; // 各局部未知量对应的端口（-1 表示内部未知量），按元件中首次用到的顺序编号
+    Vect<String> VarName; // 各内部未知量相对于实例的层次名（如 "n1"、"x2.n1"，空表示辅助变量）
+    Vect<char> VarIsNode; // 各局部未知量是否为节点（否则为支路电流）
+    Vect<Element*> Elements; // 独立的元件对象（按创建顺序）
+    Vect<char> Flags; // 各元件对象的注册信息（1 为动态，2 为非线性）
+    ElementGroup* Groups[26] = {}; // 成组的元件
+    int Counts[26] = {}; // 各类型（元件名首字母）的元件个数
+};
+// 子电路定义（.SUBCKT name port ... 至 .ENDS）：保存元件描述的单词，首次实例化时建立模板，之后的实例只映射编号
+// 读入结束后只读（模板由主电路建立，.STEP/.MC 的工作电路与主电路共用）
+struct SubcktDef {
+    String Name = ""; // 子电路名
+    int PortCount = 0; // 端口个数
+    Vect<StrView> Tokens; // 各元件描述的单词（指向文件映射）
+    Vect<size_t> Start; // 各元件描述在 Tokens 中的起始位置
+    SymbolTable Locals; // 端口名称表（编号即端口序号）
+    SubcktTemplate* Tmpl = nullptr; // 元件模板（尚未实例化时为 nullptr）
+    explicit SubcktDef(Arena& arena) : Locals(arena) {}
+};
+// 正在建立的子电路模板（建立期间 GetNode/GetBranch/NewAux 返回模板中的局部编号）
+struct TemplateBuild {
+    const SubcktDef* Def = nullptr; // 子电路定义
+    SubcktTemplate* Tmpl = nullptr; // 正在建立的模板
+    Dict<int> Nodes; // 节点名 -> 局部编号
+    Dict<int> Branches; // 支路名 -> 局部编号
+};
+// 牛顿迭代的状态（供非线性元件使用）
+struct NewtonInfo {
+    bool Limited = false;     // 本次迭代是否有器件限制了端电压（此时不能判为收敛）
+    bool AllBypassed = true;  // 本次迭代是否所有器件都被旁路（此时矩阵与上次相同）
+    long long Evaluated = 0;  // 器件模型计算的次数
+    long long Bypassed = 0;   // 器件被旁路的次数
+    long long Iterations = 0; // 牛顿迭代的总次数
+    long long ReusedLU = 0;   // 因全部旁路而沿用上次 LU 分解的迭代次数
+};
+// 各阶段的累计耗时（秒），Run 结束时填写分解与求解两项
+struct PhaseTimes {
+    double Read = 0;    // 读取网表（ReadFile，含 .INCLUDE/.LIB）
+    double Create = 0;  // 创建元件（CreateElement，含子电路展开）
+    double Compile = 0; // 编译 stamp 槽位并着色
+    double Stamp = 0;   // stamp（固定部分、动态元件与牛顿迭代中的非线性元件）
+    double Factor = 0;  // 主方程的分解（含符号分析与数值重分解）
+    double Solve = 0;   // 主方程的替换求解
+    double Print = 0;   // 输出 .OP 结果
+    double Op = 0;      // 直流工作点分析
+    double Ac = 0;      // .AC 分析（含输出）
+    double Dc = 0;      // .DC 分析（含输出）
+    double Tran = 0;    // .TRAN 分析（含输出）
+    double Step = 0;    // .STEP/.MC（含输出）
+    double Alter = 0;   // .ALTER（含输出）
+    double Run = 0;     // Run 的总耗时
+};
+// 运行计数（STATS 报告用）
+struct RunCounters {
+    int Elements[26] = {}; // 各类型（元件名首字母）的元件个数，含子电路展开的元件
+    long long FixedStamps = 0;     // 固定元件的 stamp 次数
+    long long DynamicStamps = 0;   // 动态元件的 stamp 次数
+    long long NonlinearStamps = 0; // 非线性元件的 stamp 次数
+};
+// Run 的各阶段（硬件计数器按阶段累计）
+enum StatsPhase {
+    STATS_CREATE = 0, STATS_COMPILE, STATS_OP, STATS_PRINT, STATS_AC, STATS_DC, STATS_TRAN, STATS_STEP, STATS_ALTER,
+    STATS_PHASE_COUNT
+};
+// 电路元件构造函数（由小写字母指定电路元件类型，在电路的内存池 arena 中构造）
+using ElementCtor = Element*(*)(char ch, Arena& arena);
+// 电路元件组构造函数（由小写字母指定，返回 nullptr 表示该类型不成组）
+using GroupCtor = ElementGroup*(*)(char ch, Arena& arena);
 // 电路类
+// 可重入：电路的全部状态（含错误信息和输出文件）都在对象内，不同线程可以同时使用各自的电路对象；
+// 同一个电路对象（及其工作区）同一时刻只能由一个线程调用
 struct Circuit {
 public:
     /*//////////////////// 公共成员变量 ////////////////////*/
     Configuration Config; // 电路配置参数
     bool ErrorFlag = false; // 电路是否有错误
     String ErrorMsg = ""; // 错误信息
+    TranInfo Tran; // 瞬态分析的积分信息
+    NewtonInfo Newton; // 牛顿迭代的状态
+    PhaseTimes Timing; // 各阶段的耗时
+    RunCounters Counters; // 元件个数与 stamp 次数
     /*//////////////////// 供外部使用 ////////////////////*/
     // 设置电路元件构造函数函数
     void SetElementCtor(ElementCtor ctor);
+    // 设置电路元件组构造函数
+    void SetGroupCtor(GroupCtor ctor);
     // 设置输出路径（true 表示成功）
     bool SetOutputPath(const String& filepath);
     // 读取网表文件，构建电路（返回 true 表示成功）
@@ -42,64 +264,247 @@ public:
     bool ReadFile(const String& filepath, bool isLib=false);
     // 运行仿真程序（返回 true 表示仿真成功）
     bool Run();
+    // 修改元件的主参数（电阻值、受控源增益、独立源的值等），在 Run 之后调用，返回 false 表示元件不存在或不支持
+    // 固定元件的修改只改写其槽位，矩阵的变化记为工作点矩阵的低秩修正，由 SolveAltered 求解
+    bool SetElementValue(StrView name, double value);
+    // 按修改后的元件值重新求解工作点，返回 true 表示成功
+    // 线性电路沿用已有的分解做低秩修正，累积的秩使修正比重新分解更费时时才重新分解
+    bool SolveAltered();
+    // 获取当前解中的节点电压，节点不存在时返回 nan（不区分大小写）
+    double GetVoltage(StrView node);
+    // 获取当前解中的支路电流，支路不存在时返回 nan（不区分大小写）
+    double GetCurrent(StrView branch);
     /*//////////////////// 供 Element 类使用 ////////////////////*/
     // 查找节点电压，若不存在则创建，返回节点编号（不区分大小写）
-    int GetNode(const String& name);
+    int GetNode(StrView name);
     // 查找支路电流，若不存在则创建，返回支路编号（不区分大小写）
-    int GetBranch(const String& name);
+    int GetBranch(StrView name);
     // 创建一个辅助变量（在解向量中），返回编号
     int NewAux();
     // 注册元件，提供信息：是否为动态，是否为非线性
     void Register(Element* elm, bool isDynamic, bool isNonlinear);
+    // 根据状态量 q 的历史（q[0] 为当前步）估计局部截断误差，返回建议的下一步长
+    // i0、i1 为当前步和上一步的 dq/dt，absTol 为其绝对容差
+    double TruncateStep(const double* q, double i0, double i1, double absTol);
+    // 查找器件模型，不存在时返回 nullptr（不区分大小写）
+    const ModelSpec* GetModel(const String& name);
     /*//////////////////// 通用 ////////////////////*/
     // 设置错误信息
     void SetError(const String& msg);
     // 将字符串转为数值
     double GetValue(const String& s);
-    // 构造函数
-    Circuit();
+    // 构造函数（ws 为共用的工作区，须比电路存在得更久；nullptr 表示独立运行）
+    // 有工作区时内存池从工作区缓存的内存块分配，.INCLUDE/.LIB 文件经工作区缓存，线程池由工作区提供
+    Circuit(Workspace* ws = nullptr);
     // 析构函数
     ~Circuit();
 private:
     /*//////////////////// 私有成员变量 ////////////////////*/
     String Title = ""; // 电路文件标题
-    String DirPath = ""; // 文件目录路径 
-    OutStream OutputFile; // 输出文件
+    String DirPath = ""; // 正在读入的文件所在的目录路径（相对路径的 .INCLUDE/.LIB 以此为基准）
+    ResultWriter OutputFile; // 输出文件（带缓冲区，文本或 rawfile 格式）
     ElementCtor ElmCtor = nullptr; // 电路元件构造函数
+    GroupCtor GrpCtor = nullptr; // 电路元件组构造函数
+    Arena Mem; // 电路的内存池（元件对象、元件组、文件映射和名称字符串，电路析构时整体释放）
     /*//////////////////// 电路方程相关 ////////////////////*/
     int Xsize = 0; // 解向量规模
     Equation* MNA = nullptr; // MNA 方程
-    Dict<int> NodeDict; // 电路节点电压编号字典
-    Dict<int> BranchDict; // 电路支路电流编号字典
-    Dict<Element*> ElmDict; // 电路元件字典
-    HashSet<Element*> FixedSet; // 固定元件集合
+    ThreadPool* Pool = nullptr; // 并行计算所用的线程池
+    Workspace* Work = nullptr; // 共用的工作区（nullptr 表示独立运行，线程池由电路自己创建和释放）
+    static constexpr int NO_INDEX = -2; // NodeOf/BranchOf 中表示该名称不是节点/支路
+    SymbolTable Symbols{Mem}; // 节点和支路名称的符号表（不区分大小写）
+    Vect<int> NodeOf; // 各符号对应的节点电压编号（地为 -1）
+    Vect<int> BranchOf; // 各符号对应的支路电流编号
+    SymbolTable ElmNames{Mem}; // 元件名称的符号表（首次按名称查找元件时才建立，创建元件时不必逐个登记）
+    Vect<ElmRef> ElmOf; // 各元件名称对应的元件（同名元件只记录第一个）
+    Vect<Element*> ElmList; // 全部元件对象（按创建顺序，存放在内存池中）
+    Vect<char> ElmFlags; // 各元件对象的注册信息（1 为动态，2 为非线性，0 为固定元件）
+    ElementGroup* Groups[26] = {}; // 各类型的元件组（按元件名首字母）
+    Vect<ElementGroup*> GroupList; // 全部元件组（按创建顺序，存放在内存池中）
+    Vect<Vect<int>> GroupColors; // 各元件组中每种颜色的起始位置（最后一段为只能串行 stamp 的部分）
+    Vect<std::pair<StrView, int>> NodeList; // 按名称排序的节点及其编号（用于输出）
+    Vect<std::pair<StrView, int>> BranchList; // 按名称排序的支路及其编号（用于输出）
+    Vect<Element*> FixedList; // 固定元件列表（按注册顺序）
+    Vect<Vect<Element*>> FixedColors; // 按写冲突着色分组的固定元件（同组元件的槽位互不重叠）
+    int ColorCount = 0; // 固定元件和元件组共用的颜色数
+    Vect<Element*> FixedSerial; // 未编译 stamp 的固定元件（只能串行 stamp）
+    Vect<Element*> DynamicList; // 动态元件列表（瞬态分析中每步重新 stamp）
+    Vect<Element*> NonlinearList; // 非线性元件列表（牛顿迭代中每次重新 stamp）
+    Vect<int> NodeDiag; // 各节点对角元的槽位（gmin 步进时使用）
+    Vect<double> XTol; // 各未知数收敛判断的绝对容差
+    Vect<double> LinA; // 牛顿迭代的线性基准矩阵 A（不含非线性元件）
+    Vect<double> LinB; // 牛顿迭代的线性基准向量 B
+    Vect<double> XPrev; // 牛顿迭代中上一次的解
+    Vect<double> XAccept; // 瞬态分析中最近接受的一步的解（牛顿迭代的初值）
+    Vect<double> FixedA; // 只含固定元件时的矩阵 A 的快照
+    Vect<double> FixedB; // 只含固定元件时的向量 B 的快照
+    int TranAccepted = 0; // 瞬态分析接受的步数
+    int TranRejected = 0; // 瞬态分析因截断误差过大而拒绝的步数
+    int TranReused = 0;   // 瞬态分析中直接沿用上一步 LU 分解的步数
+    int AcPoints = 0;     // 交流分析的频率点数
+    int AcWorkers = 0;    // 交流分析的并行方程个数
+    int AcFullCount = 0;  // 交流分析中完整分解（重新选主元）的次数
+    int StepVariants = 0; // .STEP/.MC 的变体个数
+    int StepWorkers = 0;  // .STEP/.MC 使用的工作电路个数
+    Vect<double> OpX;     // 工作点的解（.STEP/.MC 各变体的初值）
+    LowRankUpdate Alter;  // 元件值修改对工作点矩阵的低秩修正
+    bool AlterReady = false; // MNA 中是否为工作点矩阵（线性电路还须是低秩修正基准的分解）
+    int AlterRuns = 0;    // 修改元件值后重新求解工作点的次数
+    int AlterUpdates = 0; // 其中用低秩修正求解的次数
+    int AlterRefactors = 0; // 其中因秩过大而重新分解的次数
+    int AlterMaxRank = 0; // 低秩修正用到的最大秩
+    double RunStart = 0; // Run 开始的时刻
+    PerfCounters Perf; // 硬件性能计数器（STATS=2 时打开）
+    long long PerfLast[PERF_EVENT_COUNT] = {}; // 上一次采样的计数值
+    long long PerfPhase[STATS_PHASE_COUNT][PERF_EVENT_COUNT] = {}; // 各阶段累计的计数值
     /*//////////////////// 主电路描述 ////////////////////*/
-    Vect<String> ElementMemo; // 元件描述存储
+    Vect<MappedFile*> Sources; // 已读取的网表文件映射（单词指向其中，存放在内存池中）
+    Vect<StrView> MemoTokens; // 各元件描述的单词（依次存放）
+    Vect<size_t> MemoStart; // 各元件描述在 MemoTokens 中的起始位置
+    Vect<SweepSpec> DcSweeps; // .DC 扫描（第一个为最内层）
+    TranSpec TranCmd; // .TRAN 参数
+    AcSpec AcCmd; // .AC 参数
+    Vect<StepSpec> StepList; // .STEP 和 .MC 的扫描对象（.STEP 在前，第一个变化最快）
+    Vect<Vect<std::pair<String, double>>> AlterList; // 各 .ALTER 修改的元件及新值
+    int McRuns = 0; // .MC 的运行次数（0 表示没有 .MC）
+    unsigned long long McSeed = 1; // .MC 的随机数种子
+    Dict<ModelSpec> ModelDict; // 器件模型字典
+    /*//////////////////// 子电路和库文件 ////////////////////*/
+    static const int MAX_DEPTH = 64; // 子电路实例的最大嵌套层数
+    SymbolTable SubcktNames{Mem}; // 子电路名称表
+    Vect<SubcktDef*> SubcktList; // 各子电路定义（与名称表编号对应，存放在内存池中）
+    SubcktDef* CurSubckt = nullptr; // 正在读入的子电路定义（nullptr 表示在主电路中）
+    TemplateBuild* Build = nullptr; // 正在建立的子电路模板（nullptr 表示在主电路中创建元件）
+    Vect<String> SourcePaths; // 各文件映射的路径（与 Sources 对应）
+    HashSet<String> Included; // 已读入的 .INCLUDE 文件和 .LIB 段（路径与段名），重复引用时跳过
+    String LibWant = ""; // 正在读入的库文件中需要的段名（空表示读入整个文件）
+    bool LibSkip = false; // 当前行是否在不需要的 .LIB 段中
+    int IncludeDepth = 0; // 正在读入的 .INCLUDE/.LIB 文件的嵌套层数（0 表示主文件，段标记只在被包含的文件中有效）
     /*//////////////////// 内部函数 ////////////////////*/
-    // 读取主电路标题
-    void ReadTitle(InStream& file);
-    // 读取经过精简后的一行
-    void ReadLine(const String& line);
+    // 在符号表中查找名称，不存在时加入，返回符号编号
+    int Intern(StrView name);
+    // 在正在建立的模板中查找未知量，不存在时加入，返回局部编号（isNode 表示节点，地返回 -1）
+    // direct 表示名称直接出现在定义中（此时可能是端口），name 为空时加入无名的辅助变量
+    int TemplateVar(StrView name, bool isNode, bool direct);
+    // 按名称查找元件，不存在时返回 nullptr（子电路中的元件名为 "x1.r1" 的形式）
+    ElmRef FindElement(StrView name);
+    // 按创建顺序登记一组元件描述中各元件的名称（prefix 为子电路实例的层次名前缀）
+    void IndexElements(const Vect<StrView>& tokens, const Vect<size_t>& start, const String& prefix,
+        int* count, size_t& next, int depth);
+    // 元件名（可带子电路层次前缀）对应的类型字母
+    static char TypeOf(StrView name);
+    // 获取单词在网表文件中的原文（单词在读入时已转为小写，文件路径需要原来的大小写）
+    String SourceText(StrView token);
+    // 读取主电路标题，返回标题行之后的位置
+    char* ReadTitle(char* p, char* end);
+    // 读取分解为单词后的一个逻辑行
+    void ReadLine(const Vect<StrView>& tokens);
     // 读取命令
-    void ReadCommand(const String& line);
-    // 创建元件
-    void CreateElement(Vect<String>& elementMemo);
-    // 创建元件
+    void ReadCommand(const Vect<StrView>& line);
+    // 按元件描述创建元件
+    void CreateElement();
+    // 按一组元件描述依次创建元件（depth 为子电路嵌套层数，arg 为共用的参数缓冲）
+    void CreateLines(const Vect<StrView>& tokens, const Vect<size_t>& start, Vect<String>& arg, int depth);
+    // 创建子电路实例：映射模板中的未知量编号，复制模板中的元件（模板不存在时先建立）
+    void Instantiate(Vect<String>& arg, int depth);
+    // 建立子电路模板：以局部编号创建定义中的元件（depth 为定义中元件的嵌套层数）
+    void BuildTemplate(SubcktDef* def, int depth);
+    // 编译各元件的 stamp 槽位，并按槽位冲突对元件着色
+    void CompileElements();
+    // 将固定元件 stamp 到 MNA 方程（同色元件并行，结果与线程数无关）
+    void StampFixed();
+    // 以当前 MNA 中的矩阵和向量为线性基准，求解含非线性元件的方程（线性电路只求解一次）
+    // maxIter 为最大迭代次数，gshunt 为各节点附加的对地电导，srcFactor 为独立源的缩放系数
+    bool SolveNewton(bool isOP, int maxIter, double gshunt = 0, double srcFactor = 1);
+    // 求解直流工作点：先直接牛顿迭代，不收敛时依次尝试 gmin 步进和电源步进
+    bool SolveOP();
+    // 运行直流工作点分析
     void RunOP();
     // 输出 OP 分析后的节点电压和支路电流
     void PrintOP();
+    // 运行 .DC 扫描分析（沿用 OP 的分解结果，所有扫描点分批同时替换）并输出结果
+    void RunDC();
+    // 运行 .AC 小信号分析（各频率点分块并行，每个线程一个复数方程，沿用第一个频率点的主元顺序）
+    void RunAC();
+    // 复制出一个工作电路：由已读入的元件描述重建元件，方程沿用本电路的非零结构、排序和主元
+    Circuit* Clone();
+    // 运行 .STEP/.MC：各变体的工作点在线程池上并行求解（每个线程一个工作电路），结果按变体顺序输出
+    void RunStep();
+    // 对非线性电路逐点运行 .DC 扫描（以上一点的解为初值）并输出结果
+    // nominal 为各扫描源的原值，D 为各扫描源单位变化对 B 的贡献
+    void RunDCNewton(const Vect<double>& nominal, const Vect<double>& D);
+    // 计算当前步长下的积分系数
+    void SetIntegration(double h);
+    // 所有动态元件在 t 之后的最近断点，没有时返回 HUGE_VAL
+    double NextBreakpoint(double t);
+    // 运行 .TRAN 瞬态分析并输出结果
+    void RunTRAN();
+    // 输出瞬态分析中一个时刻的结果
+    void PrintTRAN(double t);
+    // 输出矩阵统计信息（排序方法、非零元、预测与实际的填充）
+    void PrintAcct();
+    // 采样硬件计数器，将与上次采样之差累计到阶段 phase（phase < 0 只记录起点）
+    void SamplePerf(int phase);
+    // 运行 Run 的一个阶段：计时并采样硬件计数器
+    void RunPhase(void (Circuit::*fn)(), double& time, int phase);
+    // 将运行统计（各阶段耗时、元件与 stamp 计数、矩阵与主元、内存、硬件计数器）写入输出文件同名的 .stats.json 文件
+    void PrintStats();
+    // 恢复工作点矩阵并以其分解为低秩修正的基准（瞬态分析会改写 MNA 中的矩阵和分解）
+    bool BeginAlter();
+    // 依次执行各 .ALTER（修改累积），每次重新求解工作点并输出结果
+    void RunAlter();
     // 执行 .OPTIONS 命令
     void CmdOptions(const Vect<String>& tokens);
+    // 执行 .DC 命令
+    void CmdDC(const Vect<String>& tokens);
+    // 执行 .TRAN 命令
+    void CmdTran(const Vect<String>& tokens);
+    // 执行 .AC 命令
+    void CmdAC(const Vect<String>& tokens);
+    // 执行 .STEP 命令
+    void CmdStep(const Vect<String>& tokens);
+    // 执行 .MC 命令
+    void CmdMC(const Vect<String>& tokens);
+    // 执行 .MODEL 命令
+    void CmdModel(const Vect<String>& tokens);
+    // 执行 .ALTER 命令
+    void CmdAlter(const Vect<String>& tokens);
+    // 执行 .SUBCKT 命令（开始一个子电路定义）
+    void CmdSubckt(const Vect<String>& tokens);
+    // 执行 .ENDS 命令（结束子电路定义，建立局部名称表）
+    void CmdEnds(const Vect<String>& tokens);
+    // 执行 .INCLUDE 和 .LIB 命令（每个文件或库段只读入一次）
+    void CmdInclude(const Vect<StrView>& line);
 };
 
+inline void ElementGroup::Reorder(const Vect<int>& order) {
+    PermuteArrays(order);
+    Vect<int> ids(order.size());
+    for (size_t i = 0; i < order.size(); i++) ids[i] = Ids.empty() ? order[i] : Ids[order[i]];
+    Ids.swap(ids);
+    Pos.resize(Ids.size());
+    for (size_t i = 0; i < Ids.size(); i++) Pos[Ids[i]] = (int)i;
+}
+
+template<typename T>
+inline void ElementGroup::Gather(Vect<T>& v, const Vect<int>& order, int w) {
+    Vect<T> res(v.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        for (int j = 0; j < w; j++) res[i * w + j] = v[(size_t)order[i] * w + j];
+    }
+    v.swap(res);
+}
+
 inline void Circuit::SetElementCtor(ElementCtor ctor) {
     ElmCtor = ctor;
 }
 
+inline void Circuit::SetGroupCtor(GroupCtor ctor) {
+    GrpCtor = ctor;
+}
+
 inline bool Circuit::SetOutputPath(const String& filepath) {
-    if (OutputFile.is_open()) OutputFile.close();
-    OutputFile.open(filepath, std::ios::trunc);
-    if (!OutputFile) {
+    if (!OutputFile.Open(filepath)) {
         SetError("ERR001--Cannot open output file: " + filepath);
         return false;
     }
@@ -109,103 +514,270 @@ inline bool Circuit::SetOutputPath(const String& filepath) {
 inline bool Circuit::ReadFile(const String& filepath, bool isLib)
 {
     if (ErrorFlag) return false;
-    InStream infile(filepath);
-    if (!infile) {
+    double scratch = 0;
+    ScopedTimer timer(isLib ? scratch : Timing.Read); // 被包含的文件计入主文件
+    // 有工作区时库文件经缓存读取：已分解过且未改动的文件直接重放各逻辑行
+    SourceEntry* cached = (isLib && Work) ? Work->FindSource(filepath) : nullptr;
+    if (cached && cached->Complete) {
+        Sources.push_back(&cached->File); // 映射归工作区所有
+        SourcePaths.push_back(filepath);
+        for (const Vect<StrView>& line : cached->Lines) ReadLine(line);
+        return !ErrorFlag;
+    }
+    // 正在读取中的文件（库文件中引用自身的另一段）不经缓存
+    SourceEntry* entry = (isLib && Work && !cached) ? Work->NewSource(filepath) : nullptr;
+    Vect<Vect<StrView>>* record = entry ? &entry->Lines : nullptr; // 记录分解出的逻辑行
+    MappedFile* file = entry ? &entry->File : Mem.New<MappedFile>();
+    if (!file->Open(filepath)) {
+        if (entry) Work->DropSource(filepath);
         SetError("ERR002--Cannot open netlist file: " + filepath);
         return false;
     }
-    String blankNormal = " \t\f\v\r\n,=()[]"; // 普通模式中的空白符
-    String blankExpr = " \t\f\v\r\n"; // 表达式中的空白符
-    char ch = ' '; // 读取的字符
-    char chPrev = ' '; // 前一个字符
-    String line = "";
-    bool lineEnd = false; // 换行状态
-    int braceCount = 0; // 大括号计数
+    Sources.push_back(file); // 单词直接指向映射内存，映射保留到电路析构
+    SourcePaths.push_back(filepath);
+    char* p = file->Begin();
+    char* end = file->End();
     // 判断是否为主文件
     if (!isLib) {
-        ReadTitle(infile); // 读取标题
+        p = ReadTitle(p, end); // 读取标题
         DirPath = ""; // 提取目录部分（以 '/' 结尾）
         size_t pos = filepath.find_last_of("/\\");
         if (pos != std::string::npos) DirPath = filepath.substr(0, pos+1);
     }
-    // 读取内容（将空白符替换为空格）
-    while (infile.get(ch)) {
-        if (lineEnd) { // 换行时的判断
-            if (ch != '+') { // 若非续行符
-                ReadLine(line);
-                line = "";
-                braceCount = 0; // 恢复到初始状态
+    // 逐字符查表分类，单词原地转为小写；表达式（大括号内）中的空白符原地删除
+    // 写指针 w 只在单词内前进且不超过读指针，未改变的字符不写入（不触发页复制）
+    const CharTable& table = Str_CharTable();
+    Vect<StrView> tokens; // 当前逻辑行的单词
+    char* start = nullptr; // 当前单词的起始位置（nullptr 表示不在单词中）
+    char* w = nullptr; // 当前单词的写指针
+    int braceCount = 0; // 大括号计数（大于 0 时为表达式状态）
+    for (; p < end; p++) {
+        char ch = *p;
+        int cls = table.Class[(unsigned char)ch];
+        if (cls == CH_NEWLINE) {
+            if (braceCount <= 0 && start) { // 普通状态，换行结束单词
+                tokens.emplace_back(start, w - start);
+                start = nullptr;
             }
-            else ch = ' '; // 续行符'+'替换为空格
-            lineEnd = false; // 重置换行状态
-        }
-        if (ch == '\n') lineEnd = true; // 若为换行符，设置换行状态
-        if (braceCount <= 0) { // 普通状态，消除连续的空白符
-            // 将空白字符替换为空格
-            if (blankNormal.find(ch) != std::string::npos) ch = ' ';
-            // 如果不为连续空格，则添加到字符串中
-            if (!(chPrev == ' ' && ch == ' ' )) line += ch;
-        }
-        else { // 表达式状态，忽略空白符
-            // 将空白字符替换为空格
-            if (blankExpr.find(ch) != std::string::npos) ch = ' ';
-            // 不为空白符则添加到字符串中
-            if (ch != ' ') line += ch;
-        }
-        if (ch == '{') braceCount += 1; // 如果为左大括号，计数加一
-        if (ch == '}') braceCount -= 1; // 如果为右大括号，计数减一
-        chPrev = ch; // 上一个字符更新
+            if (p + 1 < end && p[1] == '+') { // 续行符，表达式可跨行继续
+                p++;
+                continue;
+            }
+            if (start) tokens.emplace_back(start, w - start); // 表达式未闭合就换行时保留已读入的部分（由表达式求值报错）
+            start = nullptr;
+            if (record && !tokens.empty() && tokens[0][0] != '*') record->push_back(tokens);
+            ReadLine(tokens);
+            tokens.clear();
+            braceCount = 0; // 恢复到初始状态
+            continue;
+        }
+        if (braceCount <= 0) { // 普通状态，空白符和分隔符结束单词
+            if (cls == CH_BLANK || cls == CH_SEP) {
+                if (start) tokens.emplace_back(start, w - start);
+                start = nullptr;
+                continue;
+            }
+            if (!start) start = w = p;
+        }
+        else if (cls == CH_BLANK) continue; // 表达式状态，忽略空白符
+        char lower = table.Lower[(unsigned char)ch];
+        if (w != p || lower != ch) *w = lower;
+        w++;
+        if (cls == CH_LBRACE) braceCount += 1; // 如果为左大括号，计数加一
+        if (cls == CH_RBRACE) braceCount -= 1; // 如果为右大括号，计数减一
     }
+    // 文件末尾没有换行符的最后一行
+    if (start) tokens.emplace_back(start, w - start);
+    if (record && !tokens.empty() && tokens[0][0] != '*') record->push_back(tokens);
+    ReadLine(tokens);
+    if (entry) entry->Complete = true;
     if (ErrorFlag) return false;
     else return true;
 }
 
 inline bool Circuit::Run() {
     if (ErrorFlag) return false;
-    CreateElement(ElementMemo); // 构建主电路
-    if (ErrorFlag) return false;
+    ScopedTimer timer(Timing.Run);
+    RunStart = Timer_Now();
+    if (Config.STATS >= 2 && Perf.Open()) SamplePerf(-1); // 打开硬件计数器并记录起点
+    RunPhase(&Circuit::CreateElement, Timing.Create, STATS_CREATE); // 构建主电路
+    if (ErrorFlag) {
+        if (Config.STATS) PrintStats();
+        return false;
+    }
     MNA = new Equation(Xsize); // 构建 MNA 方程
-    for (const auto& pair : NodeDict) { // 添加节点到地的附加电导
+    for (const auto& pair : NodeList) { // 添加节点到地的附加电导
         MNA->AddA(pair.second, pair.second, Config.GMIN);
     }
-    RunOP(); // 运行直流工作点分析
-    PrintOP(); // 输出 .OP 结果
-    OutputFile.close();
+    RunPhase(&Circuit::CompileElements, Timing.Compile, STATS_COMPILE); // 编译 stamp 槽位并对元件着色
+    MNA->SetOrdering(Config.ORDERING); // 设置填充缩减排序方法
+    MNA->SetSolver(Config.SOLVER); // 设置线性求解器
+    MNA->SetKrylov(Config.KRYLOV, Config.ITERTOL, Config.ITERMAX);
+    MNA->SetTearing(Config.PARTS);
+    if (Config.THREADS != 1) { // 创建线程池
+        Pool = Work ? Work->GetPool(Config.THREADS) : new ThreadPool(Config.THREADS);
+        MNA->SetThreadPool(Pool);
+    }
+    OutputFile.SetFormat(Config.FORMAT, Config.DELTA != 0, Config.NUMDGT); // 设置输出格式
+    OutputFile.SetTitle(Title);
+    RunPhase(&Circuit::RunOP, Timing.Op, STATS_OP); // 运行直流工作点分析
+    RunPhase(&Circuit::PrintOP, Timing.Print, STATS_PRINT); // 输出 .OP 结果
+    RunPhase(&Circuit::RunAC, Timing.Ac, STATS_AC); // 运行 .AC 小信号分析（在工作点处线性化）
+    RunPhase(&Circuit::RunDC, Timing.Dc, STATS_DC); // 运行 .DC 扫描分析
+    RunPhase(&Circuit::RunTRAN, Timing.Tran, STATS_TRAN); // 运行 .TRAN 瞬态分析
+    RunPhase(&Circuit::RunStep, Timing.Step, STATS_STEP); // 运行 .STEP/.MC 参数扫描
+    RunPhase(&Circuit::RunAlter, Timing.Alter, STATS_ALTER); // 运行 .ALTER（在工作点上修改元件值并重新求解）
+    Timing.Factor = MNA->FactorSeconds();
+    Timing.Solve = MNA->SolveSeconds();
+    if (Config.ACCT) PrintAcct(); // 输出矩阵统计信息
+    if (!OutputFile.Close()) SetError("ERR041--Cannot write output file: " + OutputFile.GetPath());
+    if (Config.STATS) PrintStats(); // 写入运行统计
     return ErrorFlag;
 }
 
-inline int Circuit::GetNode(const String& name) {
-    String s = Str_ToLower(name);
-    if (NodeDict.find(s) == NodeDict.end()) {
-        NodeDict[s] = Xsize;
-        Xsize++;
-        return Xsize-1;
+inline int Circuit::GetNode(StrView name) {
+    if (Build) return TemplateVar(name, true, true);
+    int id = Intern(name);
+    if (NodeOf[id] == NO_INDEX) NodeOf[id] = Xsize++;
+    return NodeOf[id];
+}
+
+inline int Circuit::GetBranch(StrView name) {
+    if (Build) return TemplateVar(name, false, true);
+    int id = Intern(name);
+    if (BranchOf[id] == NO_INDEX) BranchOf[id] = Xsize++;
+    return BranchOf[id];
+}
+
+inline int Circuit::Intern(StrView name) {
+    int id = Symbols.Intern(name);
+    if (id == (int)NodeOf.size()) { // 新符号
+        NodeOf.push_back(NO_INDEX);
+        BranchOf.push_back(NO_INDEX);
     }
-    else return NodeDict[s];
+    return id;
 }
 
-inline int Circuit::GetBranch(const String& name) {
-    String s = Str_ToLower(name);
-    if (BranchDict.find(s) == BranchDict.end()) {
-        BranchDict[s] = Xsize;
-        Xsize++;
-        return Xsize-1;
+inline int Circuit::TemplateVar(StrView name, bool isNode, bool direct) {
+    if (isNode && name == "0") return -1; // 地是全局的
+    Dict<int>& vars = isNode ? Build->Nodes : Build->Branches;
+    SubcktTemplate* tmpl = Build->Tmpl;
+    int k = (int)tmpl->VarPort.size();
+    if (!name.empty()) {
+        auto res = vars.emplace(String(name), k);
+        if (!res.second) return res.first->second;
     }
-    else return BranchDict[s];
+    int port = (direct && isNode) ? Build->Def->Locals.Find(name) : -1; // 嵌套实例的内部名称不会是端口
+    tmpl->VarPort.push_back(port);
+    tmpl->VarName.push_back((port >= 0) ? String() : String(name));
+    tmpl->VarIsNode.push_back(isNode);
+    return k;
+}
+
+inline ElmRef Circuit::FindElement(StrView name) {
+    if (ElmNames.Size() == 0) { // 按创建顺序重现各元件的引用，建立元件名称表
+        int count[26] = {}; // 各元件组已登记的元件个数
+        size_t next = 0; // 下一个元件对象
+        IndexElements(MemoTokens, MemoStart, "", count, next, 0);
+    }
+    int id = ElmNames.Find(name);
+    return (id < 0) ? ElmRef() : ElmOf[id];
+}
+
+inline void Circuit::IndexElements(const Vect<StrView>& tokens, const Vect<size_t>& start, const String& prefix,
+    int* count, size_t& next, int depth) {
+    for (size_t k = 0; k < start.size(); k++) {
+        size_t first = start[k];
+        size_t last = (k + 1 < start.size()) ? start[k+1] : tokens.size();
+        StrView elmName = tokens[first];
+        if (elmName[0] == 'x') { // 子电路实例：按定义中的顺序展开
+            int sub = (last - first >= 2) ? SubcktNames.Find(tokens[last-1]) : -1;
+            if (sub < 0 || depth >= MAX_DEPTH) continue;
+            const SubcktDef* def = SubcktList[sub];
+            IndexElements(def->Tokens, def->Start, prefix + String(elmName) + ".", count, next, depth + 1);
+            continue;
+        }
+        int type = elmName[0] - 'a';
+        ElmRef ref;
+        if (Groups[type] != nullptr) {
+            ref.Grp = Groups[type];
+            ref.Id = count[type]++;
+            ref.Fixed = true;
+        }
+        else if (next < ElmList.size()) {
+            ref.Elm = ElmList[next];
+            ref.Fixed = (ElmFlags[next] == 0);
+            next++;
+        }
+        int id = prefix.empty() ? ElmNames.Intern(elmName) : ElmNames.Intern(prefix + String(elmName));
+        if (id == (int)ElmOf.size()) ElmOf.push_back(ref);
+    }
+}
+
+inline char Circuit::TypeOf(StrView name) {
+    return name[name.find_last_of('.') + 1]; // 没有 '.' 时 npos + 1 为 0
+}
+
+inline String Circuit::SourceText(StrView token) {
+    for (size_t k = 0; k < Sources.size(); k++) {
+        const char* begin = Sources[k]->Begin();
+        if (token.data() < begin || token.data() >= Sources[k]->End()) continue;
+        InStream in(SourcePaths[k], std::ios::binary); // 映射是写时复制的私有内存，文件本身未被改写
+        String s(token.size(), '\0');
+        in.seekg(token.data() - begin);
+        if (in.read(&s[0], s.size())) return s;
+    }
+    return String(token);
 }
 
 inline int Circuit::NewAux() {
+    if (Build) return TemplateVar("", false, false);
     Xsize++;
     return Xsize-1;
 }
 
 inline void Circuit::Register(Element* elm, bool isDynamic, bool isNonlinear) {
+    if (Build) { // 模板中的元件只记录注册信息，由各实例的副本注册
+        Build->Tmpl->Flags.back() = (char)((isDynamic ? 1 : 0) | (isNonlinear ? 2 : 0));
+        return;
+    }
+    ElmFlags.back() = (char)((isDynamic ? 1 : 0) | (isNonlinear ? 2 : 0)); // 元件对象加入 ElmList 后才注册
     if (!isDynamic && !isNonlinear) {
-        FixedSet.emplace(elm); // 加入固定元件集合，这些元件只用 Stamp 一次
+        FixedList.push_back(elm); // 加入固定元件列表，这些元件只用 Stamp 一次
+    }
+    if (isDynamic) {
+        DynamicList.push_back(elm); // 加入动态元件列表，瞬态分析中每步 Stamp
+    }
+    if (isNonlinear) {
+        NonlinearList.push_back(elm); // 加入非线性元件列表，牛顿迭代中每次 Stamp
     }
     // 其余的以后再来探索吧~
 }
 
+inline double Circuit::TruncateStep(const double* q, double i0, double i1, double absTol) {
+    int k = Tran.Order;
+    if (Tran.Steps < k) return HUGE_VAL; // 历史点不足
+    // k+1 阶差商，约等于 q 的 k+1 阶导数除以 (k+1)!
+    double d[4];
+    for (int j = 0; j <= k + 1; j++) d[j] = q[j];
+    for (int level = 1; level <= k + 1; level++)
+        for (int j = 0; j <= k + 1 - level; j++)
+            d[j] = (d[j] - d[j + 1]) / (Tran.T[j] - Tran.T[j + level]);
+    // 局部截断误差系数（乘以 (k+1)!）：后向欧拉 1/2*2，梯形 1/12*6，BDF2 2/9*6
+    double coef = (k == 1) ? 1.0 : (Config.METHOD == 0 ? 0.5 : 4.0 / 3.0);
+    double h = Tran.T[0] - Tran.T[1];
+    double err = std::abs(coef * d[0] * std::pow(h, k + 1)) / h; // 换算为 dq/dt 的误差
+    double tol = Config.RELTOL * std::max(std::abs(i0), std::abs(i1)) + absTol
+        + (Config.RELTOL * std::max(std::abs(q[0]), std::abs(q[1])) + Config.CHGTOL) / h;
+    if (err <= 0) return HUGE_VAL;
+    return h * std::pow(Config.TRTOL * tol / err, 1.0 / (k + 1));
+}
+
+inline const ModelSpec* Circuit::GetModel(const String& name) {
+    auto iter = ModelDict.find(Str_ToLower(name));
+    return (iter == ModelDict.end()) ? nullptr : &iter->second;
+}
+
 inline void Circuit::SetError(const String& msg)
 {
     if (!ErrorFlag) {
@@ -220,76 +792,1201 @@ inline double Circuit::GetValue(const String& s) {
     return num;
 }
 
-inline void Circuit::ReadTitle(InStream& file) {
-    char ch = ' ';
-    String line = "";
-    // 读取电路标题
-    while (file.get(ch)) {
-        if (ch == '\n') break;
-        else if (ch != '\r') line += ch;
+inline char* Circuit::ReadTitle(char* p, char* end) {
+    // 读取电路标题（不含 '\r'）
+    Title = "";
+    for (; p < end; p++) {
+        if (*p == '\n') return p + 1;
+        else if (*p != '\r') Title += *p;
     }
-    Title = line;
+    return p;
 }
 
-inline void Circuit::ReadLine(const String& line) {
-    // 跳过空字符串和注释行（以 '*'开头）
-    if (line.size() < 1 || line[0] == '*') return;
-    char headChar = std::tolower(line[0]); // 行开头字母
-    if (headChar == '.') ReadCommand(line); // 处理'.'开头的控制语句
+inline void Circuit::ReadLine(const Vect<StrView>& tokens) {
+    // 跳过空行和注释行（以 '*'开头）
+    if (tokens.empty() || tokens[0][0] == '*') return;
+    // 库文件的段（.LIB name 至 .ENDL）：只读入 .LIB file name 所要的段
+    bool libBegin = (tokens[0] == ".lib" && tokens.size() == 2);
+    if (libBegin || tokens[0] == ".endl") {
+        if (IncludeDepth == 0) { // 主文件中没有段可选，不能据此跳过之后的行
+            SetError("ERR036--Library Section Outside Library File: " + String(tokens[0]) + (libBegin ? " " + String(tokens[1]) : ""));
+            return;
+        }
+        LibSkip = libBegin ? (tokens[1] != LibWant) : !LibWant.empty();
+        return;
+    }
+    if (LibSkip) return;
+    char headChar = tokens[0][0]; // 行开头字母（已转为小写）
+    if (headChar == '.') ReadCommand(tokens); // 处理'.'开头的控制语句
     else if (headChar >= 'a' && headChar <= 'z') { // 处理元件描述
-        ElementMemo.push_back(line); // 将描述放入主电路
-    } 
-    else SetError("ERR003--Invalid Line: " + line);
+        Vect<StrView>& memo = CurSubckt ? CurSubckt->Tokens : MemoTokens; // 放入子电路定义或主电路
+        (CurSubckt ? CurSubckt->Start : MemoStart).push_back(memo.size());
+        memo.insert(memo.end(), tokens.begin(), tokens.end());
+    }
+    else {
+        String line = "";
+        for (StrView t : tokens) line.append(t).append(" ");
+        SetError("ERR003--Invalid Line: " + line);
+    }
 }
 
-inline void Circuit::ReadCommand(const String& line) {
-    // 分割行内容为 tokens（以空格分隔）
-    Vect<String> tokens;
-    Str_Split(tokens, line);
-    String cmd = Str_ToLower(tokens[0].substr(1)); // 转换为小写便于比较
+inline void Circuit::ReadCommand(const Vect<StrView>& line) {
+    Vect<String> tokens(line.begin(), line.end());
+    String cmd = tokens[0].substr(1);
+    // 子电路定义中只允许 .MODEL（模型是全局的）和 .ENDS（.END 留到创建元件时报告缺少 .ENDS）
+    if (CurSubckt && cmd != "model" && cmd != "ends" && cmd != "end") {
+        SetError("ERR029--Invalid Command in .SUBCKT " + CurSubckt->Name + ": " + tokens[0]);
+        return;
+    }
     // 执行指令
     if (cmd == "op" || cmd == "end") return; // 这两个命令我们不需要操作
     else if (cmd == "options") CmdOptions(tokens);
+    else if (cmd == "dc") CmdDC(tokens);
+    else if (cmd == "tran") CmdTran(tokens);
+    else if (cmd == "ac") CmdAC(tokens);
+    else if (cmd == "step") CmdStep(tokens);
+    else if (cmd == "mc") CmdMC(tokens);
+    else if (cmd == "model") CmdModel(tokens);
+    else if (cmd == "alter") CmdAlter(tokens);
+    else if (cmd == "subckt") CmdSubckt(tokens);
+    else if (cmd == "ends") CmdEnds(tokens);
+    else if (cmd == "include" || cmd == "inc" || cmd == "lib") CmdInclude(line);
     else SetError("ERR005--Unrecognizable Command: " + tokens[0]);
 }
 
-inline void Circuit::CreateElement(Vect<String>& elementMemo) {
+inline void Circuit::CreateElement() {
     if (ErrorFlag) return;
-    for (String& s : elementMemo) {
-        Vect<String> arg;
-        Str_Split(arg, s);
-        Element* ptr = ElmCtor(std::tolower(arg[0][0]));
-        if (ptr == nullptr) {
-            SetError("ERR008--Element Construction Failed: " + arg[0]);
-            return;
+    if (CurSubckt) {
+        SetError("ERR040--Missing .ENDS: " + CurSubckt->Name);
+        return;
+    }
+    Vect<String> arg; // 各元件共用的参数缓冲（字符串保留容量，避免逐单词分配内存）
+    CreateLines(MemoTokens, MemoStart, arg, 0);
+    if (ErrorFlag) return;
+    // 按名称排序节点和支路，输出顺序与读入顺序无关
+    NodeList.clear();
+    BranchList.clear();
+    for (int id = 0; id < Symbols.Size(); id++) {
+        if (NodeOf[id] != NO_INDEX) NodeList.emplace_back(Symbols.Name(id), NodeOf[id]);
+        if (BranchOf[id] != NO_INDEX) BranchList.emplace_back(Symbols.Name(id), BranchOf[id]);
+    }
+    std::sort(NodeList.begin(), NodeList.end());
+    std::sort(BranchList.begin(), BranchList.end());
+}
+
+inline void Circuit::CreateLines(const Vect<StrView>& tokens, const Vect<size_t>& start, Vect<String>& arg, int depth) {
+    for (size_t k = 0; k < start.size(); k++) {
+        size_t first = start[k];
+        size_t last = (k + 1 < start.size()) ? start[k+1] : tokens.size();
+        arg.resize(last - first);
+        for (size_t t = first; t < last; t++) arg[t - first].assign(tokens[t]);
+        char ch = arg[0][0];
+        if (ch == 'x') { // 子电路实例
+            Instantiate(arg, depth);
+            if (ErrorFlag) return;
+            continue;
+        }
+        (Build ? Build->Tmpl->Counts : Counters.Elements)[ch - 'a']++;
+        ElementGroup*& grp = (Build ? Build->Tmpl->Groups : Groups)[ch - 'a'];
+        if (grp == nullptr && GrpCtor != nullptr) { // 首次遇到该类型时创建元件组
+            grp = GrpCtor(ch, Mem);
+            if (grp != nullptr && !Build) GroupList.push_back(grp);
+        }
+        if (grp != nullptr) grp->Add(this, arg); // 成组的元件只向数组追加参数
+        else {
+            Element* ptr = ElmCtor(ch, Mem);
+            if (ptr == nullptr) {
+                SetError("ERR008--Element Construction Failed: " + arg[0]);
+                return;
+            }
+            if (Build) {
+                Build->Tmpl->Elements.push_back(ptr);
+                Build->Tmpl->Flags.push_back(0);
+            }
+            else {
+                ElmList.push_back(ptr);
+                ElmFlags.push_back(0);
+            }
+            ptr->Create(this, arg);
         }
-        ptr->Create(this, arg);
-        ElmDict.emplace(arg[0], ptr);
         if (ErrorFlag) return;
     }
 }
 
-inline void Circuit::RunOP() {
+inline void Circuit::Instantiate(Vect<String>& arg, int depth) {
+    // X 名称 节点1 ... 节点n 子电路名
+    int id = (arg.size() >= 2) ? SubcktNames.Find(arg.back()) : -1;
+    if (id < 0) {
+        SetError("ERR026--Unknown Subcircuit: " + arg[0] + " " + arg.back());
+        return;
+    }
+    SubcktDef* def = SubcktList[id];
+    if ((int)arg.size() - 2 != def->PortCount) {
+        SetError("ERR027--Port Count Mismatch: " + arg[0] + " " + def->Name);
+        return;
+    }
+    if (depth >= MAX_DEPTH || (def->Tmpl && def->Tmpl->Building)) { // 引用自身的定义会无限嵌套
+        SetError("ERR030--Subcircuit Nesting Too Deep: " + arg[0]);
+        return;
+    }
+    if (def->Tmpl == nullptr) BuildTemplate(def, depth + 1);
+    if (ErrorFlag) return;
+    const SubcktTemplate* tmpl = def->Tmpl;
+    // 按首次用到的顺序映射各局部未知量（与逐行创建元件时的编号顺序相同）
+    // 端口在外层解析，内部未知量取层次名（外层也是模板时为外层的局部未知量）
+    int vars = (int)tmpl->VarPort.size();
+    Vect<int> map(vars);
+    String prefix = arg[0] + ".";
+    for (int k = 0; k < vars; k++) {
+        int port = tmpl->VarPort[k];
+        bool isNode = tmpl->VarIsNode[k];
+        const String& name = tmpl->VarName[k];
+        if (port >= 0) map[k] = GetNode(arg[port + 1]);
+        else if (name.empty()) map[k] = NewAux();
+        else if (Build) map[k] = TemplateVar(prefix + name, isNode, false);
+        else {
+            int sym = Intern(prefix + name);
+            int& x = isNode ? NodeOf[sym] : BranchOf[sym];
+            if (x == NO_INDEX) x = Xsize++; // 可能已在外层按层次名引用过
+            map[k] = x;
+        }
+    }
+    // 复制元件：成组的元件追加到同类型的组，元件对象复制后注册
+    for (int t = 0; t < 26; t++) {
+        if (tmpl->Counts[t] == 0) continue;
+        (Build ? Build->Tmpl->Counts : Counters.Elements)[t] += tmpl->Counts[t];
+        if (tmpl->Groups[t] == nullptr) continue;
+        ElementGroup*& grp = (Build ? Build->Tmpl->Groups : Groups)[t];
+        if (grp == nullptr) {
+            grp = GrpCtor((char)('a' + t), Mem);
+            if (!Build) GroupList.push_back(grp);
+        }
+        grp->Append(tmpl->Groups[t], map);
+    }
+    for (size_t e = 0; e < tmpl->Elements.size(); e++) {
+        Element* elm = tmpl->Elements[e]->Clone(Mem, map);
+        if (Build) {
+            Build->Tmpl->Elements.push_back(elm);
+            Build->Tmpl->Flags.push_back(0);
+        }
+        else {
+            ElmList.push_back(elm);
+            ElmFlags.push_back(0);
+        }
+        Register(elm, tmpl->Flags[e] & 1, tmpl->Flags[e] & 2);
+    }
+}
+
+inline void Circuit::BuildTemplate(SubcktDef* def, int depth) {
+    def->Tmpl = Mem.New<SubcktTemplate>();
+    def->Tmpl->Building = true;
+    TemplateBuild build;
+    build.Def = def;
+    build.Tmpl = def->Tmpl;
+    TemplateBuild* outer = Build;
+    Build = &build;
+    Vect<String> arg; // 调用者的参数缓冲仍在使用（端口和实例名）
+    CreateLines(def->Tokens, def->Start, arg, depth);
+    Build = outer;
+    def->Tmpl->Building = false;
+}
+
+inline void Circuit::CompileElements() {
     if (ErrorFlag) return;
-    for (Element* elm : FixedSet) {
+    for (Element* elm : DynamicList) {
+        elm->Compile(this, MNA);
+    }
+    for (Element* elm : NonlinearList) {
+        elm->Compile(this, MNA);
+    }
+    // 收敛容差：节点电压用 VNTOL，支路电流等其余未知数用 ABSTOL
+    XTol.assign(Xsize, Config.ABSTOL);
+    NodeDiag.clear();
+    for (const auto& pair : NodeList) {
+        if (pair.second < 0) continue;
+        XTol[pair.second] = Config.VNTOL;
+        NodeDiag.push_back(MNA->SlotA(pair.second, pair.second));
+    }
+    XPrev.assign(Xsize, 0);
+    // 贪心着色：逐个编译固定元件和元件组中的元件，每个元件取其所有槽位上都未被占用的最小颜色
+    // （最多 64 种，超出的以及未编译的元件串行处理；哑槽位不参与着色，各元件的 stamp 跳过它）
+    // 连接同一非地枢纽节点（如 VDD）的元件共用其对角槽位，颜色两两不同，因此第 64 个之后的都落入串行部分：
+    // 这是预期的扩展上限，这类电路中枢纽上的元件只能串行 stamp（接地不受影响）
+    Vect<unsigned long long> maskA, maskB(Xsize + 1, 0);
+    int maxColor = -1;
+    auto color = [&](const Vect<int>& slots) {
+        if (slots.empty()) return -1; // 未编译（或不写入任何槽位）的元件
+        unsigned long long used = 0;
+        for (int s : slots) {
+            if (s >= (int)maskA.size()) maskA.resize(s + 1, 0);
+            used |= (s >= 0) ? maskA[s] : maskB[~s];
+        }
+        if (~used == 0) return -1;
+        int c = 0;
+        while (used >> c & 1) c++;
+        for (int s : slots) ((s >= 0) ? maskA[s] : maskB[~s]) |= 1ull << c;
+        maxColor = std::max(maxColor, c);
+        return c;
+    };
+    FixedColors.clear();
+    FixedSerial.clear();
+    for (Element* elm : FixedList) {
+        MNA->BeginRecord();
+        elm->Compile(this, MNA);
+        int c = color(MNA->EndRecord());
+        if (c < 0) FixedSerial.push_back(elm);
+        else {
+            if (c >= (int)FixedColors.size()) FixedColors.resize(c + 1);
+            FixedColors[c].push_back(elm);
+        }
+    }
+    Vect<Vect<int>> groupColor(GroupList.size());
+    for (size_t g = 0; g < GroupList.size(); g++) {
+        int count = GroupList[g]->Size();
+        groupColor[g].resize(count);
+        for (int k = 0; k < count; k++) {
+            MNA->BeginRecord();
+            GroupList[g]->Compile(this, MNA, k);
+            groupColor[g][k] = color(MNA->EndRecord());
+        }
+    }
+    // 按颜色重排各元件组（稳定计数排序，串行部分在最后），使每种颜色在数组中连续
+    ColorCount = maxColor + 1;
+    GroupColors.assign(GroupList.size(), Vect<int>());
+    for (size_t g = 0; g < GroupList.size(); g++) {
+        Vect<int>& start = GroupColors[g];
+        start.assign(ColorCount + 2, 0);
+        for (int c : groupColor[g]) start[((c < 0) ? ColorCount : c) + 1]++;
+        for (int c = 0; c <= ColorCount; c++) start[c + 1] += start[c];
+        Vect<int> order(groupColor[g].size()), next(start.begin(), start.end() - 1);
+        for (int k = 0; k < (int)order.size(); k++) {
+            int c = groupColor[g][k];
+            order[next[(c < 0) ? ColorCount : c]++] = k;
+        }
+        GroupList[g]->Reorder(order);
+    }
+}
+
+inline void Circuit::StampFixed() {
+    const int chunk = 4096; // 每个任务 stamp 的元件个数
+    Vect<std::pair<int, int>> tasks; // 各任务：（元件组编号，-1 表示固定元件对象）和起始位置
+    for (int c = 0; c < ColorCount; c++) {
+        tasks.clear();
+        Vect<Element*>* group = (c < (int)FixedColors.size()) ? &FixedColors[c] : nullptr;
+        if (group) for (int k = 0; k < (int)group->size(); k += chunk) tasks.emplace_back(-1, k);
+        for (int g = 0; g < (int)GroupList.size(); g++) {
+            for (int k = GroupColors[g][c]; k < GroupColors[g][c + 1]; k += chunk) tasks.emplace_back(g, k);
+        }
+        std::function<void(int)> job = [&](int t) {
+            int g = tasks[t].first, begin = tasks[t].second;
+            if (g < 0) {
+                int end = std::min((int)group->size(), begin + chunk);
+                for (int k = begin; k < end; k++) (*group)[k]->Stamp(this, MNA, true);
+            }
+            else GroupList[g]->Stamp(this, MNA, begin, std::min(GroupColors[g][c + 1], begin + chunk));
+        };
+        if (Pool) Pool->Run((int)tasks.size(), job);
+        else for (int t = 0; t < (int)tasks.size(); t++) job(t);
+    }
+    for (Element* elm : FixedSerial) {
         elm->Stamp(this, MNA, true);
     }
-    if (MNA->Factorize(Config.PIVTOL)) MNA->Substitute();
-    else SetError("ERR009--Singular Matrix!");
+    Counters.FixedStamps += (long long)FixedList.size();
+    for (size_t g = 0; g < GroupList.size(); g++) {
+        GroupList[g]->Stamp(this, MNA, GroupColors[g][ColorCount], GroupColors[g][ColorCount + 1]);
+        Counters.FixedStamps += GroupList[g]->Size();
+    }
+}
+
+inline void Circuit::RunOP() {
+    if (ErrorFlag) return;
+    {
+        ScopedTimer phase(Timing.Stamp);
+        StampFixed();
+        FixedA.resize(MNA->NNZ()); // 保存固定部分，瞬态分析每步从此恢复
+        FixedB.resize(Xsize);
+        MNA->SaveA(FixedA.data());
+        MNA->SaveB(FixedB.data());
+        for (Element* elm : DynamicList) {
+            elm->Stamp(this, MNA, true);
+        }
+        Counters.DynamicStamps += (long long)DynamicList.size();
+    }
+    if (!SolveOP() && !ErrorFlag) SetError("ERR017--No Convergence in DC Operating Point!");
+    OpX.resize(Xsize);
+    MNA->SaveX(OpX.data());
+    Alter.Reset(Xsize);
+    AlterReady = NonlinearList.empty(); // 线性电路的分解即为低秩修正的基准
+}
+
+inline bool Circuit::SolveNewton(bool isOP, int maxIter, double gshunt, double srcFactor) {
+    if (NonlinearList.empty()) { // 线性电路直接求解
+        if (!MNA->Refactorize(Config.PIVTOL) || !MNA->Substitute()) {
+            SetError("ERR009--Singular Matrix!");
+            return false;
+        }
+        return true;
+    }
+    int n = Xsize;
+    LinA.resize(MNA->NNZ()); // 每次迭代从线性基准恢复，只重新 stamp 非线性元件
+    LinB.resize(n);
+    MNA->SaveA(LinA.data());
+    MNA->SaveB(LinB.data());
+    for (int iter = 0; iter < maxIter; iter++) {
+        MNA->SaveX(XPrev.data());
+        if (iter > 0) {
+            MNA->LoadA(LinA.data());
+            MNA->LoadB(LinB.data());
+        }
+        double* a = MNA->DataA();
+        for (int s : NodeDiag) a[s] += gshunt;
+        if (srcFactor != 1) { // 线性基准中的 B 只来自独立源
+            double* b = MNA->DataB();
+            for (int i = 0; i < n; i++) b[i] *= srcFactor;
+        }
+        Newton.Limited = false;
+        Newton.AllBypassed = true;
+        {
+            ScopedTimer phase(Timing.Stamp);
+            for (Element* elm : NonlinearList) elm->Stamp(this, MNA, isOP);
+            Counters.NonlinearStamps += (long long)NonlinearList.size();
+        }
+        Newton.Iterations++;
+        // 所有器件都被旁路时矩阵与上次相同，沿用上次的分解
+        if (iter > 0 && Newton.AllBypassed) Newton.ReusedLU++;
+        else if (!MNA->Refactorize(Config.PIVTOL)) return false;
+        if (!MNA->Substitute()) return false;
+        if (iter == 0 || Newton.Limited) continue;
+        bool converged = true;
+        for (int i = 0; i < n && converged; i++) {
+            double x = MNA->GetX(i), xp = XPrev[i];
+            converged = std::abs(x - xp) <= Config.RELTOL * std::max(std::abs(x), std::abs(xp)) + XTol[i];
+        }
+        if (converged) return true;
+    }
+    return false;
+}
+
+inline bool Circuit::SolveOP() {
+    if (SolveNewton(true, Config.ITL1)) return true;
+    if (ErrorFlag || NonlinearList.empty()) return false;
+    Vect<double> baseA(LinA), baseB(LinB); // 线性基准（SolveNewton 会覆盖 LinA/LinB）
+    Vect<double> zero(Xsize, 0);
+    // gmin 步进：先在各节点并联较大的对地电导，逐步减小到 0，每步以上一步的解为初值
+    if (Config.GMINSTEPS > 0) {
+        MNA->LoadX(zero.data());
+        bool ok = true;
+        double g = 1e-2;
+        double ratio = std::pow(g / std::max(Config.GMIN, 1e-15), 1.0 / Config.GMINSTEPS);
+        for (int k = 0; k <= Config.GMINSTEPS && ok; k++, g /= ratio) {
+            MNA->LoadA(baseA.data());
+            MNA->LoadB(baseB.data());
+            ok = SolveNewton(true, Config.ITL1, g);
+        }
+        MNA->LoadA(baseA.data());
+        MNA->LoadB(baseB.data());
+        if (ok && SolveNewton(true, Config.ITL1)) return true;
+    }
+    // 电源步进：将所有独立源从 0 逐步增加到原值
+    if (Config.SRCSTEPS > 0) {
+        MNA->LoadX(zero.data());
+        bool ok = true;
+        for (int k = 1; k <= Config.SRCSTEPS && ok; k++) {
+            MNA->LoadA(baseA.data());
+            MNA->LoadB(baseB.data());
+            ok = SolveNewton(true, Config.ITL1, 0, (double)k / Config.SRCSTEPS);
+        }
+        if (ok) return true;
+    }
+    return false;
 }
 
 inline void Circuit::PrintOP() {
     if (ErrorFlag) return;
-    for (const auto& pair : NodeDict) {
-        OutputFile << "V(" << pair.first << ")\t";
-        OutputFile << std::scientific << std::setprecision(Config.NUMDGT) 
-        << MNA->GetX(pair.second) << std::endl;
+    if (!OutputFile.IsText()) { // rawfile：只有一个点的结果表
+        OutputFile.BeginPlot("Operating Point", false);
+        for (const auto& pair : NodeList) OutputFile.AddVar('V', pair.first);
+        for (const auto& pair : BranchList) OutputFile.AddVar('I', pair.first);
+        OutputFile.EndHeader();
+        for (const auto& pair : NodeList) OutputFile.Real(MNA->GetX(pair.second));
+        for (const auto& pair : BranchList) OutputFile.Real(MNA->GetX(pair.second));
+        OutputFile.EndRow();
+        OutputFile.EndPlot();
+        return;
+    }
+    for (const auto& pair : NodeList) {
+        OutputFile.Put("V(");
+        OutputFile.Put(pair.first);
+        OutputFile.Put(")\t");
+        OutputFile.PutReal(MNA->GetX(pair.second));
+        OutputFile.Put('\n');
+    }
+    for (const auto& pair : BranchList) {
+        OutputFile.Put("I(");
+        OutputFile.Put(pair.first);
+        OutputFile.Put(")\t");
+        OutputFile.PutReal(MNA->GetX(pair.second));
+        OutputFile.Put('\n');
+    }
+}
+
+inline void Circuit::RunDC() {
+    if (ErrorFlag || DcSweeps.empty()) return;
+    int n = Xsize;
+    int ns = (int)DcSweeps.size();
+    // 查找扫描源（只允许独立电压源和电流源，它们只影响常数向量 B）
+    Vect<Element*> src(ns);
+    Vect<double> nominal(ns);
+    for (int s = 0; s < ns; s++) {
+        const String& name = DcSweeps[s].Name;
+        src[s] = FindElement(name).Elm; // 独立源不成组
+        if (src[s] == nullptr || (TypeOf(name) != 'v' && TypeOf(name) != 'i')) {
+            SetError("ERR013--Invalid .DC Source: " + name);
+            return;
+        }
+        nominal[s] = src[s]->GetParam();
+    }
+    // 计算每个扫描源的单位变化对 B 的贡献 D(s)，之后 B = B0 + sum (v(s) - v0(s)) * D(s)
+    Vect<double> saveA(MNA->NNZ()), B0(n), zero(n, 0), Bt(n), D((size_t)ns * n);
+    MNA->SaveA(saveA.data());
+    MNA->SaveB(B0.data());
+    for (int s = 0; s < ns; s++) {
+        double* d = D.data() + (size_t)s * n;
+        MNA->LoadB(zero.data());
+        src[s]->SetParam(nominal[s] + 1);
+        src[s]->Stamp(this, MNA, true);
+        MNA->SaveB(d);
+        MNA->LoadB(zero.data());
+        src[s]->SetParam(nominal[s]);
+        src[s]->Stamp(this, MNA, true);
+        MNA->SaveB(Bt.data());
+        for (int i = 0; i < n; i++) d[i] -= Bt[i];
+    }
+    MNA->LoadA(saveA.data()); // 恢复 stamp 前的矩阵
+    MNA->LoadB(B0.data());
+    if (!NonlinearList.empty()) { // 非线性电路不能共用分解，逐点做牛顿迭代
+        RunDCNewton(nominal, D);
+        return;
+    }
+    // 输出表头
+    OutputFile.BeginPlot("DC transfer characteristic", false);
+    for (int s = 0; s < ns; s++) OutputFile.AddColumn(DcSweeps[s].Name, (TypeOf(DcSweeps[s].Name) == 'v') ? "voltage" : "current");
+    for (const auto& pair : NodeList) OutputFile.AddVar('V', pair.first);
+    for (const auto& pair : BranchList) OutputFile.AddVar('I', pair.first);
+    OutputFile.EndHeader();
+    // 分批构造常数向量并同时替换
+    long long total = 1;
+    for (const SweepSpec& sw : DcSweeps) total *= sw.Count;
+    const int chunk = 64;
+    Vect<double> Bs((size_t)chunk * n), Xs((size_t)chunk * n), vals((size_t)chunk * ns);
+    for (long long p0 = 0; p0 < total; p0 += chunk) {
+        int m = (int)std::min<long long>(chunk, total - p0);
+        for (int r = 0; r < m; r++) {
+            double* b = Bs.data() + (size_t)r * n;
+            std::copy(B0.begin(), B0.end(), b);
+            long long idx = p0 + r;
+            for (int s = 0; s < ns; s++) { // 第一个扫描源变化最快
+                const SweepSpec& sw = DcSweeps[s];
+                double v = sw.Start + (idx % sw.Count) * sw.Step;
+                idx /= sw.Count;
+                vals[(size_t)r * ns + s] = v;
+                double dv = v - nominal[s];
+                if (dv == 0) continue;
+                const double* d = D.data() + (size_t)s * n;
+                for (int i = 0; i < n; i++) b[i] += dv * d[i];
+            }
+        }
+        if (!MNA->SubstituteBatch(m, Bs.data(), Xs.data())) {
+            SetError("ERR009--Singular Matrix!");
+            break;
+        }
+        for (int r = 0; r < m; r++) {
+            const double* x = Xs.data() + (size_t)r * n;
+            for (int s = 0; s < ns; s++) OutputFile.Real(vals[(size_t)r * ns + s]);
+            for (const auto& pair : NodeList) OutputFile.Real((pair.second < 0) ? 0.0 : x[pair.second]);
+            for (const auto& pair : BranchList) OutputFile.Real(x[pair.second]);
+            OutputFile.EndRow();
+        }
+    }
+    OutputFile.EndPlot();
+}
+
+inline void Circuit::RunAC() {
+    if (ErrorFlag || AcCmd.Points <= 0) return;
+    // 频率点
+    Vect<double> freq;
+    if (AcCmd.Type == AC_LIN) {
+        for (int k = 0; k < AcCmd.Points; k++) {
+            double r = (AcCmd.Points == 1) ? 0 : (double)k / (AcCmd.Points - 1);
+            freq.push_back(AcCmd.Start + r * (AcCmd.Stop - AcCmd.Start));
+        }
+    }
+    else {
+        double ratio = std::pow((AcCmd.Type == AC_DEC) ? 10.0 : 2.0, 1.0 / AcCmd.Points);
+        int count = (int)std::floor(std::log(AcCmd.Stop / AcCmd.Start) / std::log(ratio) + 1e-9) + 1;
+        for (int k = 0; k < count; k++) freq.push_back(AcCmd.Start * std::pow(ratio, k));
+    }
+    int n = Xsize;
+    int nf = (int)freq.size();
+    const double twoPi = 2 * 3.14159265358979323846;
+    // 主方程：复制 MNA 的非零结构（槽位与实数方程一致），stamp 与频率无关的部分作为基准
+    ComplexEquation master(0);
+    master.CopyPattern(*MNA);
+    master.SetOrdering(Config.ORDERING);
+    std::complex<double>* a = master.DataA();
+    for (int s : NodeDiag) a[s] += Config.GMIN;
+    for (Element* elm : FixedList) elm->StampAC(this, &master, 0);
+    for (ElementGroup* grp : GroupList) grp->StampAC(this, &master, 0);
+    for (Element* elm : NonlinearList) elm->StampAC(this, &master, 0);
+    Vect<std::complex<double>> baseA(master.NNZ()), baseB(n);
+    master.SaveA(baseA.data());
+    master.SaveB(baseB.data());
+    // 在第一个频率点完成排序和主元选择，各线程复制后只做数值重分解
+    for (Element* elm : DynamicList) elm->StampAC(this, &master, twoPi * freq[0]);
+    if (!master.Analyze(Config.PIVTOL)) {
+        SetError("ERR021--Singular Matrix in .AC!");
+        return;
+    }
+    int workers = Pool ? std::min(Pool->Size(), nf) : 1;
+    Vect<std::complex<double>> res((size_t)nf * n);
+    Vect<int> full(workers, 0), failed(workers, -1);
+    std::function<void(int)> job = [&](int w) {
+        ComplexEquation equ(master);
+        int k0 = (int)((long long)nf * w / workers), k1 = (int)((long long)nf * (w + 1) / workers);
+        for (int k = k0; k < k1; k++) {
+            equ.LoadA(baseA.data());
+            equ.LoadB(baseB.data());
+            for (Element* elm : DynamicList) elm->StampAC(this, &equ, twoPi * freq[k]);
+            if (!equ.Refactorize(Config.PIVTOL) || !equ.Substitute()) {
+                failed[w] = k;
+                return;
+            }
+            equ.SaveX(res.data() + (size_t)k * n);
+        }
+        full[w] = equ.FullFactorCount() - master.FullFactorCount();
+    };
+    if (Pool) Pool->Run(workers, job);
+    else job(0);
+    for (int w = 0; w < workers; w++) {
+        if (failed[w] >= 0) {
+            SetError("ERR021--Singular Matrix in .AC at f=" + std::to_string(freq[failed[w]]));
+            return;
+        }
+        AcFullCount += full[w];
+    }
+    AcFullCount += master.FullFactorCount();
+    AcPoints = nf;
+    AcWorkers = workers;
+    // 输出幅度和相位（度）
+    OutputFile.BeginPlot("AC Analysis", true);
+    OutputFile.AddColumn("freq", "frequency");
+    for (const auto& pair : NodeList) OutputFile.AddVar('V', pair.first);
+    for (const auto& pair : BranchList) OutputFile.AddVar('I', pair.first);
+    OutputFile.EndHeader();
+    for (int k = 0; k < nf; k++) {
+        const std::complex<double>* x = res.data() + (size_t)k * n;
+        OutputFile.Real(freq[k]);
+        for (const auto& pair : NodeList) OutputFile.Complex((pair.second < 0) ? 0.0 : x[pair.second]);
+        for (const auto& pair : BranchList) OutputFile.Complex(x[pair.second]);
+        OutputFile.EndRow();
+    }
+    OutputFile.EndPlot();
+}
+
+inline Circuit* Circuit::Clone() {
+    Circuit* cir = new Circuit();
+    cir->Config = Config;
+    cir->Config.THREADS = 1;
+    cir->ElmCtor = ElmCtor;
+    cir->GrpCtor = GrpCtor;
+    cir->ModelDict = ModelDict;
+    cir->SubcktList = SubcktList; // 子电路定义只读，直接共用
+    for (int k = 0; k < SubcktNames.Size(); k++) cir->SubcktNames.Intern(SubcktNames.Name(k));
+    cir->MemoTokens = MemoTokens; // 单词仍指向本电路的文件映射
+    cir->MemoStart = MemoStart;
+    cir->CreateElement(); // 按相同顺序创建，节点和支路编号与本电路一致
+    cir->Xsize = Xsize;
+    cir->MNA = new Equation(*MNA);
+    cir->MNA->SetThreadPool(nullptr);
+    cir->CompileElements(); // 非零元均已存在，槽位与本电路一致
+    return cir;
+}
+
+inline void Circuit::RunStep() {
+    if (ErrorFlag || StepList.empty()) return;
+    int n = Xsize;
+    int nt = (int)StepList.size();
+    // 检查扫描对象，记录原值
+    Vect<double> nominal(nt);
+    for (int t = 0; t < nt; t++) {
+        ElmRef elm = FindElement(StepList[t].Name);
+        if (!elm.Valid() || !elm.SetParam(elm.GetParam())) {
+            SetError("ERR024--Invalid .STEP/.MC Element: " + StepList[t].Name);
+            return;
+        }
+        nominal[t] = elm.GetParam();
+    }
+    // 生成所有变体的取值：.STEP 部分为笛卡尔积（第一个变化最快），再乘以 .MC 的运行次数
+    long long stepCount = 1;
+    for (const StepSpec& st : StepList) {
+        if (st.Dist == STEP_VALUES) stepCount *= (long long)st.Values.size();
+    }
+    int runs = std::max(McRuns, 1);
+    int total = (int)(stepCount * runs);
+    Vect<double> vals((size_t)total * nt);
+    for (int v = 0; v < total; v++) {
+        long long idx = v % stepCount;
+        int r = (int)(v / stepCount);
+        // 每次运行的随机数只由种子和运行序号决定，与线程数无关
+        std::mt19937_64 gen(McSeed + 0x9E3779B97F4A7C15ull * (unsigned long long)(r + 1));
+        std::uniform_real_distribution<double> unif(-1.0, 1.0);
+        std::normal_distribution<double> gauss(0.0, 1.0);
+        for (int t = 0; t < nt; t++) {
+            const StepSpec& st = StepList[t];
+            double& x = vals[(size_t)v * nt + t];
+            if (st.Dist == STEP_VALUES) {
+                x = st.Values[idx % st.Values.size()];
+                idx /= (long long)st.Values.size();
+            }
+            else if (st.Dist == STEP_UNIF) x = nominal[t] * (1 + st.Tol * unif(gen));
+            else x = nominal[t] * (1 + st.Tol * gauss(gen));
+        }
+    }
+    // 各线程领取变体，在自己的工作电路上求解工作点
+    int workers = Pool ? Pool->Size() : 1;
+    Vect<Circuit*> clones(workers, nullptr);
+    Vect<double> res((size_t)total * n);
+    Vect<char> ok(total, 0);
+    std::function<void(int)> job = [&](int v) {
+        int w = Pool ? ThreadPool::WorkerId() : 0;
+        if (clones[w] == nullptr) clones[w] = Clone();
+        Circuit* cir = clones[w];
+        for (int t = 0; t < nt; t++) cir->FindElement(StepList[t].Name).SetParam(vals[(size_t)v * nt + t]);
+        cir->MNA->Clear();
+        double* a = cir->MNA->DataA();
+        for (int s : cir->NodeDiag) a[s] += Config.GMIN;
+        cir->MNA->LoadX(OpX.data());
+        cir->RunOP();
+        ok[v] = !cir->ErrorFlag;
+        cir->ErrorFlag = false;
+        cir->MNA->SaveX(res.data() + (size_t)v * n);
+    };
+    if (Pool) Pool->Run(total, job);
+    else for (int v = 0; v < total; v++) job(v);
+    StepVariants = total;
+    StepWorkers = 0;
+    for (Circuit* cir : clones) {
+        if (cir) StepWorkers++;
+        delete cir;
+    }
+    // 输出表头
+    OutputFile.BeginPlot("Parameter Step", false);
+    OutputFile.AddColumn("run", "notype");
+    for (const StepSpec& st : StepList) OutputFile.AddColumn(st.Name, "notype");
+    for (const auto& pair : NodeList) OutputFile.AddVar('V', pair.first);
+    for (const auto& pair : BranchList) OutputFile.AddVar('I', pair.first);
+    OutputFile.EndHeader();
+    for (int v = 0; v < total; v++) {
+        const double* x = res.data() + (size_t)v * n;
+        double nan = std::numeric_limits<double>::quiet_NaN(); // 不收敛的变体输出 nan
+        OutputFile.Int(v);
+        for (int t = 0; t < nt; t++) OutputFile.Real(vals[(size_t)v * nt + t]);
+        for (const auto& pair : NodeList) OutputFile.Real((pair.second < 0) ? 0.0 : (ok[v] ? x[pair.second] : nan));
+        for (const auto& pair : BranchList) OutputFile.Real(ok[v] ? x[pair.second] : nan);
+        OutputFile.EndRow();
+    }
+    OutputFile.EndPlot();
+}
+
+inline void Circuit::RunDCNewton(const Vect<double>& nominal, const Vect<double>& D) {
+    int n = Xsize;
+    int ns = (int)DcSweeps.size();
+    Vect<double> saveX(n), baseA(LinA), baseB(LinB), b(n);
+    MNA->SaveX(saveX.data());
+    // 输出表头
+    OutputFile.BeginPlot("DC transfer characteristic", false);
+    for (int s = 0; s < ns; s++) OutputFile.AddColumn(DcSweeps[s].Name, (TypeOf(DcSweeps[s].Name) == 'v') ? "voltage" : "current");
+    for (const auto& pair : NodeList) OutputFile.AddVar('V', pair.first);
+    for (const auto& pair : BranchList) OutputFile.AddVar('I', pair.first);
+    OutputFile.EndHeader();
+    long long total = 1;
+    for (const SweepSpec& sw : DcSweeps) total *= sw.Count;
+    Vect<double> vals(ns);
+    for (long long p = 0; p < total && !ErrorFlag; p++) {
+        long long idx = p;
+        for (int s = 0; s < ns; s++) { // 第一个扫描源变化最快
+            const SweepSpec& sw = DcSweeps[s];
+            vals[s] = sw.Start + (idx % sw.Count) * sw.Step;
+            idx /= sw.Count;
+        }
+        // 线性基准：A 不随扫描源变化，B = B0 + sum (v(s) - v0(s)) * D(s)
+        b = baseB;
+        for (int s = 0; s < ns; s++) {
+            double dv = vals[s] - nominal[s];
+            if (dv == 0) continue;
+            const double* d = D.data() + (size_t)s * n;
+            for (int i = 0; i < n; i++) b[i] += dv * d[i];
+        }
+        MNA->LoadA(baseA.data());
+        MNA->LoadB(b.data());
+        if (!SolveOP()) {
+            SetError("ERR042--No Convergence in .DC at point " + std::to_string(p));
+            break;
+        }
+        for (int s = 0; s < ns; s++) OutputFile.Real(vals[s]);
+        for (const auto& pair : NodeList) OutputFile.Real(MNA->GetX(pair.second));
+        for (const auto& pair : BranchList) OutputFile.Real(MNA->GetX(pair.second));
+        OutputFile.EndRow();
+    }
+    MNA->LoadX(saveX.data()); // 恢复工作点的解（瞬态分析从工作点出发）
+    OutputFile.EndPlot();
+}
+
+inline void Circuit::SetIntegration(double h) {
+    Tran.Ai1 = 0;
+    Tran.Ag[2] = 0;
+    if (Tran.Order == 1) { // 后向欧拉
+        Tran.Ag[0] = 1 / h;
+        Tran.Ag[1] = -1 / h;
+    }
+    else if (Config.METHOD == 0) { // 梯形法
+        Tran.Ag[0] = 2 / h;
+        Tran.Ag[1] = -2 / h;
+        Tran.Ai1 = -1;
+    }
+    else { // 变步长 BDF2
+        double r = h / (Tran.T[1] - Tran.T[2]);
+        Tran.Ag[0] = (1 + 2 * r) / ((1 + r) * h);
+        Tran.Ag[1] = -(1 + r) / h;
+        Tran.Ag[2] = r * r / ((1 + r) * h);
+    }
+}
+
+inline double Circuit::NextBreakpoint(double t) {
+    double tb = HUGE_VAL;
+    for (Element* elm : DynamicList) tb = std::min(tb, elm->Breakpoint(t));
+    return tb;
+}
+
+inline void Circuit::RunTRAN() {
+    if (ErrorFlag || TranCmd.Stop <= 0) return;
+    double tstop = TranCmd.Stop;
+    double hmax = (TranCmd.Max > 0) ? TranCmd.Max : std::min(TranCmd.Step, tstop / 50);
+    double hmin = tstop * 1e-12;
+    AlterReady = false; // 之后 MNA 中为瞬态分析的矩阵
+    // 由工作点初始化动态元件的历史
+    Tran = TranInfo();
+    for (Element* elm : DynamicList) elm->Accept(this, MNA);
+    XAccept.resize(Xsize);
+    MNA->SaveX(XAccept.data());
+    // 输出表头
+    OutputFile.BeginPlot("Transient Analysis", false);
+    OutputFile.AddColumn("time", "time");
+    for (const auto& pair : NodeList) OutputFile.AddVar('V', pair.first);
+    for (const auto& pair : BranchList) OutputFile.AddVar('I', pair.first);
+    OutputFile.EndHeader();
+    if (TranCmd.Start <= 0) PrintTRAN(0);
+    double t = 0;
+    double h = std::min(TranCmd.Step, hmax) / 10; // 第一步用后向欧拉，取较小步长
+    double lastAg0 = 0; // 上一次分解时的 Ag[0]（矩阵 A 只通过它随步长变化）
+    double tbreak = NextBreakpoint(hmin); // 下一个断点：步长不越过它，否则窄脉冲可能被整个跨过
+    bool restart = true; // 起点或刚越过断点：波形导数不连续，用后向欧拉重新起步
+    while (t < tstop * (1 - 1e-12)) {
+        if (t + h > tstop) h = tstop - t;
+        if (t + h > tbreak - hmin) h = tbreak - t; // 落在断点上
+        Tran.Order = restart ? 1 : 2;
+        Tran.T[0] = t + h;
+        Tran.Time = t + h;
+        SetIntegration(h);
+        // 恢复固定部分，只重新 stamp 动态元件
+        MNA->LoadA(FixedA.data());
+        MNA->LoadB(FixedB.data());
+        {
+            ScopedTimer phase(Timing.Stamp);
+            for (Element* elm : DynamicList) elm->Stamp(this, MNA, false);
+            Counters.DynamicStamps += (long long)DynamicList.size();
+        }
+        if (!NonlinearList.empty()) { // 非线性电路：以本步的线性部分为基准做牛顿迭代
+            MNA->LoadX(XAccept.data());
+            if (!SolveNewton(false, Config.ITL4)) {
+                if (h <= hmin) {
+                    SetError("ERR018--No Convergence in .TRAN at t=" + std::to_string(t + h));
+                    return;
+                }
+                TranRejected++; // 不收敛，缩小步长重算
+                h = std::max(h / 8, hmin);
+                continue;
+            }
+        }
+        else {
+            if (Tran.Ag[0] == lastAg0) TranReused++; // 线性电路且步长不变，矩阵未变，沿用 LU 分解
+            else if (MNA->Refactorize(Config.PIVTOL)) lastAg0 = Tran.Ag[0];
+            else {
+                SetError("ERR015--Singular Matrix in .TRAN at t=" + std::to_string(t + h));
+                return;
+            }
+            if (!MNA->Substitute()) {
+                SetError("ERR015--Singular Matrix in .TRAN at t=" + std::to_string(t + h));
+                return;
+            }
+        }
+        // 估计局部截断误差
+        double hnew = HUGE_VAL;
+        for (Element* elm : DynamicList) hnew = std::min(hnew, elm->Truncate(this, MNA));
+        if (hnew < 0.9 * h && h > hmin) { // 误差过大，缩小步长重算
+            TranRejected++;
+            h = std::max(hnew, hmin);
+            continue;
+        }
+        // 接受本步
+        for (Element* elm : DynamicList) elm->Accept(this, MNA);
+        MNA->SaveX(XAccept.data());
+        Tran.T[3] = Tran.T[2];
+        Tran.T[2] = Tran.T[1];
+        Tran.T[1] = Tran.T[0];
+        Tran.Steps++;
+        TranAccepted++;
+        bool atBreak = (t + h >= tbreak - hmin);
+        t = atBreak ? tbreak : t + h;
+        if (t >= TranCmd.Start) PrintTRAN(t);
+        restart = false;
+        if (atBreak) { // 越过断点后以小步长重新起步（取到下一断点距离的 1/10，同 SPICE）
+            tbreak = NextBreakpoint(t + hmin);
+            restart = true;
+            h = std::min(h, (tbreak - t) / 10);
+            continue;
+        }
+        // 步长只在误差允许时加倍，否则保持不变，使线性电路能沿用 LU 分解
+        if (hnew >= 2 * h) h = 2 * h;
+        h = std::min(h, hmax);
+    }
+    OutputFile.EndPlot();
+}
+
+inline void Circuit::PrintTRAN(double t) {
+    OutputFile.Real(t);
+    for (const auto& pair : NodeList) OutputFile.Real(MNA->GetX(pair.second));
+    for (const auto& pair : BranchList) OutputFile.Real(MNA->GetX(pair.second));
+    OutputFile.EndRow();
+}
+
+inline void Circuit::PrintAcct() {
+    if (ErrorFlag) return;
+    const char* orderName[] = { "natural", "amd", "colamd" };
+    long long nnz = MNA->NNZ();
+    long long pred = MNA->PredictedNNZ();
+    long long actual = MNA->FactorNNZ();
+    std::ostringstream os;
+    if (MNA->IsIterative()) { // 迭代求解：没有排序和填充，输出迭代次数与残差
+        const KrylovSolver& kry = MNA->Iterative();
+        os << "* SOLVER\titerative (" << kry.MethodName() << ", " << kry.PrecondName() << ")\n";
+        os << "* UNKNOWNS\t" << MNA->Size() << "\n";
+        os << "* NNZ(A)\t" << nnz << "\n";
+        os << "* NNZ(PRECOND)\t" << actual << "\t(" << kry.Shifts() << " shifted pivots)\n";
+        os << "* KRYLOV\t" << kry.Solves() << " solves, " << kry.Iterations() << " iterations (max ";
+        os << kry.MaxIterations() << "), max residual " << kry.MaxResidual() << "\n";
+    }
+    else {
+        if (MNA->IsTearing()) { // 撕裂求解：块数、最大块与界面的规模
+            const BBDSolver& bbd = MNA->Tearing();
+            os << "* SOLVER\tbbd (" << bbd.BlockCount() << " blocks, largest " << bbd.LargestBlock();
+            os << ", border " << bbd.BorderSize() << ")\n";
+        }
+        else os << "* SOLVER\t" << (MNA->IsDense() ? "dense" : "sparse") << "\n";
+        os << "* ORDERING\t" << orderName[Config.ORDERING] << "\n";
+        os << "* UNKNOWNS\t" << MNA->Size() << "\n";
+        os << "* NNZ(A)\t" << nnz << "\n";
+        os << "* NNZ(LU) PREDICTED\t" << pred << "\t(fill " << pred - nnz << ")\n";
+        os << "* NNZ(LU) ACTUAL\t" << actual << "\t(fill " << actual - nnz << ")\n";
+        if (MNA->IterFallbackCount() > 0) os << "* KRYLOV\tno convergence, fell back to sparse LU" << "\n";
+        if (MNA->TearFallbackCount() > 0) os << "* BBD\tborder too large or singular block, fell back to sparse LU" << "\n";
     }
-    for (const auto& pair : BranchDict) {
-        OutputFile << "I(" << pair.first << ")\t";
-        OutputFile << std::scientific << std::setprecision(Config.NUMDGT) 
-        << MNA->GetX(pair.second) << std::endl;
+    os << "* FACTORIZATIONS\t" << MNA->FullFactorCount() << " full, ";
+    os << MNA->RefactorCount() << " refactor" << "\n";
+    os << "* ARENA\t" << Mem.Allocations() << " allocations, " << Mem.BytesUsed() << " bytes used, ";
+    os << Mem.BytesReserved() << " bytes in " << Mem.BlockCount() << " blocks" << "\n";
+    if (TranCmd.Stop > 0) {
+        os << "* TRAN STEPS\t" << TranAccepted << " accepted, " << TranRejected << " rejected, ";
+        os << TranReused << " reused LU" << "\n";
     }
+    if (AcPoints > 0) {
+        os << "* AC POINTS\t" << AcPoints << " points, " << AcWorkers << " threads, ";
+        os << AcFullCount << " full factorizations" << "\n";
+    }
+    if (StepVariants > 0) {
+        os << "* STEP RUNS\t" << StepVariants << " variants, " << StepWorkers << " threads" << "\n";
+    }
+    if (AlterRuns > 0) {
+        os << "* ALTER\t" << AlterRuns << " runs, " << AlterUpdates << " low-rank solves (max rank ";
+        os << AlterMaxRank << "), " << AlterRefactors << " refactorizations" << "\n";
+    }
+    if (!NonlinearList.empty()) {
+        os << "* NEWTON\t" << Newton.Iterations << " iterations, " << Newton.ReusedLU << " reused LU" << "\n";
+        os << "* DEVICES\t" << Newton.Evaluated << " evaluated, " << Newton.Bypassed << " bypassed" << "\n";
+    }
+    if (OutputFile.IsText()) OutputFile.Put(os.str()); // 文本格式附加在输出文件末尾
+    else { // rawfile 格式写入同名的 .acct 文件
+        ResultWriter side;
+        if (side.Open(OutputFile.GetPath() + ".acct")) side.Put(os.str());
+    }
+}
+
+inline void Circuit::SamplePerf(int phase) {
+    if (!Perf.IsOpen()) return;
+    long long now[PERF_EVENT_COUNT];
+    Perf.Read(now);
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        if (phase >= 0 && now[e] >= 0) PerfPhase[phase][e] += now[e] - PerfLast[e];
+        PerfLast[e] = now[e];
+    }
+}
+
+inline void Circuit::RunPhase(void (Circuit::*fn)(), double& time, int phase) {
+    {
+        ScopedTimer timer(time);
+        (this->*fn)();
+    }
+    SamplePerf(phase);
+}
+
+inline void Circuit::PrintStats() {
+    static const char* phaseName[STATS_PHASE_COUNT] = { "create", "compile", "op", "print", "ac", "dc", "tran", "step", "alter" };
+    const char* orderName[] = { "natural", "amd", "colamd" };
+    std::ostringstream os;
+    os << "{\n";
+    os << "  \"title\": " << Json_Quote(Title) << ",\n";
+    os << "  \"netlist\": " << Json_Quote(SourcePaths.empty() ? StrView() : StrView(SourcePaths[0])) << ",\n";
+    os << "  \"output\": " << Json_Quote(OutputFile.GetPath()) << ",\n";
+    os << "  \"ok\": " << (ErrorFlag ? "false" : "true") << ",\n";
+    os << "  \"error\": " << Json_Quote(ErrorMsg) << ",\n";
+    os << "  \"threads\": " << (Pool ? Pool->Size() : 1) << ",\n";
+    // 各阶段耗时（秒），analysis 各项含输出，stamp/factor/solve 是分布在各分析中的合计
+    os << "  \"times\": {\"read\": " << Json_Number(Timing.Read) << ", \"create\": " << Json_Number(Timing.Create);
+    os << ", \"compile\": " << Json_Number(Timing.Compile) << ", \"op\": " << Json_Number(Timing.Op);
+    os << ", \"print\": " << Json_Number(Timing.Print) << ", \"ac\": " << Json_Number(Timing.Ac);
+    os << ", \"dc\": " << Json_Number(Timing.Dc) << ", \"tran\": " << Json_Number(Timing.Tran);
+    os << ", \"step\": " << Json_Number(Timing.Step) << ", \"alter\": " << Json_Number(Timing.Alter);
+    os << ", \"stamp\": " << Json_Number(Timing.Stamp) << ", \"factor\": " << Json_Number(Timing.Factor);
+    os << ", \"solve\": " << Json_Number(Timing.Solve) << ", \"run\": " << Json_Number(Timer_Now() - RunStart) << "},\n";
+    // 电路规模
+    int total = 0;
+    os << "  \"circuit\": {\"elements\": {";
+    for (int c = 0; c < 26; c++) {
+        if (Counters.Elements[c] == 0) continue;
+        os << (total ? ", " : "") << "\"" << (char)('a' + c) << "\": " << Counters.Elements[c];
+        total += Counters.Elements[c];
+    }
+    os << "}, \"element_total\": " << total << ", \"nodes\": " << NodeList.size();
+    os << ", \"branches\": " << BranchList.size() << ", \"unknowns\": " << Xsize;
+    os << ", \"fixed\": " << FixedList.size() << ", \"dynamic\": " << DynamicList.size();
+    os << ", \"nonlinear\": " << NonlinearList.size() << ", \"colors\": " << ColorCount << "},\n";
+    // 矩阵与分解
+    if (MNA) {
+        long long nnz = MNA->NNZ();
+        long long actual = MNA->FactorNNZ();
+        os << "  \"matrix\": {\"solver\": \"" << (MNA->IsIterative() ? "iterative" : MNA->IsTearing() ? "bbd" : MNA->IsDense() ? "dense" : "sparse") << "\"";
+        os << ", \"ordering\": \"" << orderName[Config.ORDERING] << "\", \"nnz\": " << nnz;
+        os << ", \"lu_nnz_predicted\": " << MNA->PredictedNNZ() << ", \"lu_nnz\": " << actual;
+        os << ", \"fill\": " << actual - nnz << ", \"full_factorizations\": " << MNA->FullFactorCount();
+        os << ", \"refactorizations\": " << MNA->RefactorCount();
+        double minPivot, maxPivot;
+        int offDiagonal;
+        if (MNA->PivotStats(minPivot, maxPivot, offDiagonal)) {
+            os << ", \"pivot_min\": " << Json_Number(minPivot) << ", \"pivot_max\": " << Json_Number(maxPivot);
+            os << ", \"pivot_off_diagonal\": " << offDiagonal;
+        }
+        if (MNA->IsIterative()) {
+            const KrylovSolver& kry = MNA->Iterative();
+            os << ", \"krylov\": {\"method\": \"" << kry.MethodName() << "\", \"precond\": \"" << kry.PrecondName() << "\"";
+            os << ", \"solves\": " << kry.Solves() << ", \"iterations\": " << kry.Iterations();
+            os << ", \"max_iterations\": " << kry.MaxIterations() << ", \"max_residual\": " << Json_Number(kry.MaxResidual());
+            os << ", \"shifts\": " << kry.Shifts() << ", \"fallbacks\": " << MNA->IterFallbackCount() << "}";
+        }
+        if (MNA->IsTearing() || MNA->TearFallbackCount() > 0) {
+            const BBDSolver& bbd = MNA->Tearing();
+            os << ", \"bbd\": {\"blocks\": " << bbd.BlockCount() << ", \"largest_block\": " << bbd.LargestBlock();
+            os << ", \"border\": " << bbd.BorderSize() << ", \"fallbacks\": " << MNA->TearFallbackCount() << "}";
+        }
+        os << "},\n";
+    }
+    // 计数
+    os << "  \"counters\": {\"stamps_fixed\": " << Counters.FixedStamps << ", \"stamps_dynamic\": " << Counters.DynamicStamps;
+    os << ", \"stamps_nonlinear\": " << Counters.NonlinearStamps << ", \"newton_iterations\": " << Newton.Iterations;
+    os << ", \"newton_reused_lu\": " << Newton.ReusedLU << ", \"devices_evaluated\": " << Newton.Evaluated;
+    os << ", \"devices_bypassed\": " << Newton.Bypassed << ", \"tran_accepted\": " << TranAccepted;
+    os << ", \"tran_rejected\": " << TranRejected << ", \"tran_reused_lu\": " << TranReused;
+    os << ", \"ac_points\": " << AcPoints << ", \"ac_full_factorizations\": " << AcFullCount;
+    os << ", \"step_variants\": " << StepVariants << ", \"alter_runs\": " << AlterRuns;
+    os << ", \"alter_low_rank\": " << AlterUpdates << ", \"alter_refactorizations\": " << AlterRefactors << "},\n";
+    // 内存（矩阵与分解按数值和行号估计）
+    long long entry = (long long)(sizeof(double) + sizeof(int));
+    // 使用工作区时（批处理/服务模式）同一进程中可能先后或同时运行多个电路，峰值内存只能按整个进程给出
+    if (Work) os << "  \"memory\": {\"peak_rss\": null, \"process_peak_rss\": " << Stats_PeakRSS();
+    else os << "  \"memory\": {\"peak_rss\": " << Stats_PeakRSS();
+    os << ", \"arena_used\": " << Mem.BytesUsed();
+    os << ", \"arena_reserved\": " << Mem.BytesReserved();
+    if (MNA) os << ", \"matrix_bytes\": " << MNA->NNZ() * entry << ", \"lu_bytes\": " << (long long)MNA->FactorNNZ() * entry;
+    os << "},\n";
+    // 硬件计数器（STATS=2）
+    os << "  \"hardware\": {";
+    if (Config.STATS < 2) os << "\"available\": false, \"reason\": \"not requested (STATS=2)\"";
+    else if (!Perf.IsOpen()) os << "\"available\": false, \"reason\": " << Json_Quote(Perf.Reason);
+    else {
+        // 计数器只继承打开之后创建的线程：工作区的线程池在此之前已创建，其工作线程的事件不计入
+        bool shared = Work && Pool && Pool->Size() > 1;
+        os << "\"available\": true, \"scope\": " << (shared ? "\"calling_thread\"" : "\"all_threads\"");
+        for (int k = 0; k < STATS_PHASE_COUNT; k++) {
+            os << ", \"" << phaseName[k] << "\": {";
+            for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+                os << (e ? ", " : "") << "\"" << PerfCounters::Name(e) << "\": ";
+                if (PerfLast[e] < 0) os << "null"; // 该事件不可用
+                else os << PerfPhase[k][e];
+            }
+            os << "}";
+        }
+    }
+    os << "}\n";
+    os << "}\n";
+    ResultWriter side;
+    if (side.Open(OutputFile.GetPath() + ".stats.json")) side.Put(os.str());
+}
+
+inline bool Circuit::BeginAlter() {
+    MNA->LoadA(FixedA.data());
+    MNA->LoadB(FixedB.data());
+    for (Element* elm : DynamicList) elm->Stamp(this, MNA, true);
+    if (NonlinearList.empty()) {
+        if (!MNA->Refactorize(Config.PIVTOL) || !MNA->Substitute()) {
+            SetError("ERR009--Singular Matrix!");
+            return false;
+        }
+    }
+    Alter.Reset(Xsize);
+    AlterReady = true;
+    return true;
+}
+
+inline bool Circuit::SetElementValue(StrView name, double value) {
+    if (ErrorFlag || MNA == nullptr) return false;
+    ElmRef ref = FindElement(name);
+    if (!ref.Valid() || !ref.SetParam(ref.GetParam())) return false;
+    if (!ref.Fixed) return false; // 只支持固定元件（类别在创建时记录，不必在 FixedList 中查找）
+    if (!AlterReady && !BeginAlter()) return false;
+    // 取得元件的槽位（已编译过，重新编译得到相同的槽位）
+    MNA->BeginRecord();
+    if (ref.Elm) ref.Elm->Compile(this, MNA);
+    else ref.Grp->CompileOne(this, MNA, ref.Id);
+    Vect<int> slots = MNA->EndRecord();
+    std::sort(slots.begin(), slots.end());
+    slots.erase(std::unique(slots.begin(), slots.end()), slots.end());
+    if (slots.empty()) return false; // 未编译的元件
+    // 在清零的槽位上单独 stamp 元件的旧值和新值，两者之差即为方程的变化
+    double* a = MNA->DataA();
+    double* b = MNA->DataB();
+    auto at = [&](int s) -> double& { return (s >= 0) ? a[s] : b[~s]; };
+    auto stamp = [&]() {
+        if (ref.Elm) ref.Elm->Stamp(this, MNA, true);
+        else ref.Grp->StampOne(this, MNA, ref.Id);
+    };
+    Vect<double> save(slots.size()), before(slots.size());
+    for (size_t k = 0; k < slots.size(); k++) {
+        save[k] = at(slots[k]);
+        at(slots[k]) = 0;
+    }
+    stamp();
+    for (size_t k = 0; k < slots.size(); k++) {
+        before[k] = at(slots[k]);
+        at(slots[k]) = 0;
+    }
+    ref.SetParam(value);
+    stamp();
+    for (size_t k = 0; k < slots.size(); k++) {
+        int s = slots[k];
+        double d = at(s) - before[k];
+        at(s) = save[k] + d;
+        if (s >= 0) { // 矩阵的变化：改写固定部分的快照，并记入低秩修正
+            FixedA[s - 1] += d;
+            Alter.Add(MNA->SlotRow(s), MNA->SlotCol(s), d);
+        }
+        else FixedB[~s] += d; // 常数向量的变化不影响分解
+    }
+    return true;
+}
+
+inline bool Circuit::SolveAltered() {
+    if (ErrorFlag || MNA == nullptr) return false;
+    if (!AlterReady && !BeginAlter()) return false;
+    AlterRuns++;
+    if (!NonlinearList.empty()) { // 非线性电路：由修改后的固定部分重新做牛顿迭代（以当前解为初值）
+        MNA->LoadA(FixedA.data());
+        MNA->LoadB(FixedB.data());
+        for (Element* elm : DynamicList) elm->Stamp(this, MNA, true);
+        if (!SolveOP()) {
+            SetError("ERR017--No Convergence in DC Operating Point!");
+            return false;
+        }
+        return true;
+    }
+    long long solveCost = MNA->FactorNNZ();
+    // 迭代求解总是用当前矩阵，不能在基准上做低秩修正
+    if (!MNA->IsIterative() && Alter.Rank() > 0 && Alter.Cost(solveCost) < MNA->FactorFlops() + solveCost) {
+        Vect<double> b(Xsize), x(Xsize);
+        MNA->SaveB(b.data());
+        if (Alter.Solve(MNA, b.data(), x.data())) {
+            MNA->LoadX(x.data());
+            AlterUpdates++;
+            AlterMaxRank = std::max(AlterMaxRank, Alter.Rank());
+            return true;
+        }
+    }
+    if (Alter.Rank() > 0) { // 秩过大或修正奇异：按当前矩阵重新分解，作为新的基准
+        if (!MNA->Refactorize(Config.PIVTOL)) {
+            SetError("ERR009--Singular Matrix!");
+            return false;
+        }
+        AlterRefactors++;
+        Alter.Reset(Xsize);
+    }
+    if (!MNA->Substitute()) { // 只有常数向量变化时直接沿用分解
+        SetError("ERR009--Singular Matrix!");
+        return false;
+    }
+    return true;
+}
+
+inline double Circuit::GetVoltage(StrView node) {
+    int id = Symbols.Find(node);
+    if (MNA == nullptr || id < 0 || NodeOf[id] == NO_INDEX) return std::numeric_limits<double>::quiet_NaN();
+    return MNA->GetX(NodeOf[id]);
+}
+
+inline double Circuit::GetCurrent(StrView branch) {
+    int id = Symbols.Find(branch);
+    if (MNA == nullptr || id < 0 || BranchOf[id] == NO_INDEX) return std::numeric_limits<double>::quiet_NaN();
+    return MNA->GetX(BranchOf[id]);
+}
+
+inline void Circuit::RunAlter() {
+    if (ErrorFlag || AlterList.empty()) return;
+    OutputFile.BeginPlot("Alter Operating Point", false);
+    OutputFile.AddColumn("alter", "notype");
+    for (const auto& pair : NodeList) OutputFile.AddVar('V', pair.first);
+    for (const auto& pair : BranchList) OutputFile.AddVar('I', pair.first);
+    OutputFile.EndHeader();
+    for (size_t k = 0; k < AlterList.size(); k++) {
+        for (const auto& change : AlterList[k]) {
+            if (!SetElementValue(change.first, change.second)) {
+                SetError("ERR033--Invalid .ALTER Element: " + change.first);
+                return;
+            }
+        }
+        if (!SolveAltered()) return;
+        OutputFile.Int((long long)k + 1);
+        for (const auto& pair : NodeList) OutputFile.Real(MNA->GetX(pair.second));
+        for (const auto& pair : BranchList) OutputFile.Real(MNA->GetX(pair.second));
+        OutputFile.EndRow();
+    }
+    OutputFile.EndPlot();
 }
 
 inline void Circuit::CmdOptions(const Vect<String>& tokens) {
@@ -297,7 +1994,7 @@ inline void Circuit::CmdOptions(const Vect<String>& tokens) {
         SetError("ERR006--Missing .OPTIONS Arguments!");
         return;
     }
-    for (int i = 1; i < tokens.size(); i+=2) { // 两个一组
+    for (int i = 1; i < (int)tokens.size(); i+=2) { // 两个一组
         String s = Str_ToLower(tokens[i]);
         if (s == "numdgt") {
             int n = GetValue(tokens[i+1]);
@@ -305,6 +2002,69 @@ inline void Circuit::CmdOptions(const Vect<String>& tokens) {
         }
         else if (s == "pivtol") Config.PIVTOL = GetValue(tokens[i+1]);
         else if (s == "gmin") Config.GMIN = GetValue(tokens[i+1]);
+        else if (s == "ordering") {
+            String t = Str_ToLower(tokens[i+1]);
+            if (t == "natural") Config.ORDERING = ORDER_NATURAL;
+            else if (t == "amd") Config.ORDERING = ORDER_AMD;
+            else if (t == "colamd") Config.ORDERING = ORDER_COLAMD;
+            else {
+                SetError("ERR010--Unknown Ordering: " + tokens[i+1]);
+                return;
+            }
+        }
+        else if (s == "acct") Config.ACCT = (GetValue(tokens[i+1]) != 0);
+        else if (s == "stats") Config.STATS = GetValue(tokens[i+1]);
+        else if (s == "solver") {
+            String t = Str_ToLower(tokens[i+1]);
+            if (t == "auto") Config.SOLVER = SOLVER_AUTO;
+            else if (t == "dense") Config.SOLVER = SOLVER_DENSE;
+            else if (t == "sparse") Config.SOLVER = SOLVER_SPARSE;
+            else if (t == "bbd" || t == "tearing") Config.SOLVER = SOLVER_BBD;
+            else if (t == "iterative" || t == "cg" || t == "gmres" || t == "bicgstab") {
+                Config.SOLVER = SOLVER_ITERATIVE;
+                if (t == "iterative") Config.KRYLOV = KRYLOV_AUTO;
+                else if (t == "cg") Config.KRYLOV = KRYLOV_CG;
+                else if (t == "gmres") Config.KRYLOV = KRYLOV_GMRES;
+                else Config.KRYLOV = KRYLOV_BICGSTAB;
+            }
+            else {
+                SetError("ERR011--Unknown Solver: " + tokens[i+1]);
+                return;
+            }
+        }
+        else if (s == "itertol") Config.ITERTOL = GetValue(tokens[i+1]);
+        else if (s == "itermax") Config.ITERMAX = GetValue(tokens[i+1]);
+        else if (s == "parts") Config.PARTS = GetValue(tokens[i+1]);
+        else if (s == "threads") Config.THREADS = GetValue(tokens[i+1]);
+        else if (s == "format") {
+            String t = Str_ToLower(tokens[i+1]);
+            if (t == "text") Config.FORMAT = OUT_TEXT;
+            else if (t == "raw" || t == "binary") Config.FORMAT = OUT_RAW;
+            else {
+                SetError("ERR025--Unknown Output Format: " + tokens[i+1]);
+                return;
+            }
+        }
+        else if (s == "delta") Config.DELTA = (GetValue(tokens[i+1]) != 0);
+        else if (s == "method") {
+            String t = Str_ToLower(tokens[i+1]);
+            if (t == "trap" || t == "trapezoidal") Config.METHOD = 0;
+            else if (t == "gear" || t == "bdf2") Config.METHOD = 1;
+            else {
+                SetError("ERR014--Unknown Integration Method: " + tokens[i+1]);
+                return;
+            }
+        }
+        else if (s == "reltol") Config.RELTOL = GetValue(tokens[i+1]);
+        else if (s == "abstol") Config.ABSTOL = GetValue(tokens[i+1]);
+        else if (s == "vntol") Config.VNTOL = GetValue(tokens[i+1]);
+        else if (s == "chgtol") Config.CHGTOL = GetValue(tokens[i+1]);
+        else if (s == "trtol") Config.TRTOL = GetValue(tokens[i+1]);
+        else if (s == "itl1") Config.ITL1 = GetValue(tokens[i+1]);
+        else if (s == "itl4") Config.ITL4 = GetValue(tokens[i+1]);
+        else if (s == "bypass") Config.BYPASS = (GetValue(tokens[i+1]) != 0);
+        else if (s == "gminsteps") Config.GMINSTEPS = GetValue(tokens[i+1]);
+        else if (s == "srcsteps") Config.SRCSTEPS = GetValue(tokens[i+1]);
         else {
             SetError("ERR007--Unknown Option: " + tokens[i]);
             return;
@@ -312,16 +2072,228 @@ inline void Circuit::CmdOptions(const Vect<String>& tokens) {
     }
 }
 
-Circuit::Circuit() {
-    NodeDict["0"] = -1;
+inline void Circuit::CmdDC(const Vect<String>& tokens) {
+    if (tokens.size() < 5 || (tokens.size() - 1) % 4 != 0) {
+        SetError("ERR012--Invalid .DC Arguments!");
+        return;
+    }
+    DcSweeps.clear();
+    for (size_t i = 1; i < tokens.size(); i += 4) { // 四个一组
+        SweepSpec sw;
+        sw.Name = Str_ToLower(tokens[i]);
+        sw.Start = GetValue(tokens[i+1]);
+        sw.Stop = GetValue(tokens[i+2]);
+        sw.Step = GetValue(tokens[i+3]);
+        if (ErrorFlag) return;
+        double span = (sw.Stop - sw.Start) / sw.Step;
+        if (sw.Step == 0 || span < -1e-9) {
+            SetError("ERR012--Invalid .DC Arguments!");
+            return;
+        }
+        sw.Count = (int)std::floor(span + 1e-9) + 1;
+        DcSweeps.push_back(sw);
+    }
 }
 
-Circuit::~Circuit() {
-    // 释放元件
-    for (auto iter = ElmDict.begin(); iter != ElmDict.end(); iter++) {
-        delete iter->second;
+inline void Circuit::CmdTran(const Vect<String>& tokens) {
+    if (tokens.size() < 3) {
+        SetError("ERR016--Invalid .TRAN Arguments!");
+        return;
+    }
+    TranCmd.Step = GetValue(tokens[1]);
+    TranCmd.Stop = GetValue(tokens[2]);
+    if (tokens.size() > 3 && tokens[3] != "uic") TranCmd.Start = GetValue(tokens[3]);
+    if (tokens.size() > 4 && tokens[4] != "uic") TranCmd.Max = GetValue(tokens[4]);
+    if (!ErrorFlag && (TranCmd.Step <= 0 || TranCmd.Stop <= 0)) {
+        SetError("ERR016--Invalid .TRAN Arguments!");
+    }
+}
+
+inline void Circuit::CmdModel(const Vect<String>& tokens) {
+    if (tokens.size() < 3 || tokens.size() % 2 == 0) {
+        SetError("ERR019--Invalid .MODEL Arguments!");
+        return;
+    }
+    ModelSpec& model = ModelDict[Str_ToLower(tokens[1])];
+    model.Type = Str_ToLower(tokens[2]);
+    model.Param.clear();
+    for (size_t i = 3; i + 1 < tokens.size(); i += 2) { // 两个一组
+        model.Param[Str_ToLower(tokens[i])] = GetValue(tokens[i+1]);
+    }
+}
+
+inline void Circuit::CmdAC(const Vect<String>& tokens) {
+    if (tokens.size() < 5) {
+        SetError("ERR020--Invalid .AC Arguments!");
+        return;
+    }
+    String t = Str_ToLower(tokens[1]);
+    if (t == "dec") AcCmd.Type = AC_DEC;
+    else if (t == "oct") AcCmd.Type = AC_OCT;
+    else if (t == "lin") AcCmd.Type = AC_LIN;
+    else {
+        SetError("ERR020--Invalid .AC Arguments!");
+        return;
+    }
+    AcCmd.Points = (int)GetValue(tokens[2]);
+    AcCmd.Start = GetValue(tokens[3]);
+    AcCmd.Stop = GetValue(tokens[4]);
+    if (!ErrorFlag && (AcCmd.Points <= 0 || AcCmd.Start <= 0 || AcCmd.Stop < AcCmd.Start)) {
+        SetError("ERR020--Invalid .AC Arguments!");
+    }
+}
+
+inline void Circuit::CmdStep(const Vect<String>& tokens) {
+    // .STEP [LIN] name start stop step | .STEP DEC|OCT name start stop points | .STEP name LIST v1 v2 ...
+    StepSpec st;
+    size_t i = 1;
+    String mode = (tokens.size() > 1) ? Str_ToLower(tokens[1]) : "";
+    if (mode == "lin" || mode == "dec" || mode == "oct") i++;
+    else mode = "lin";
+    if (i >= tokens.size()) {
+        SetError("ERR022--Invalid .STEP Arguments!");
+        return;
+    }
+    st.Name = Str_ToLower(tokens[i++]);
+    if (i < tokens.size() && Str_ToLower(tokens[i]) == "list") {
+        for (i++; i < tokens.size(); i++) st.Values.push_back(GetValue(tokens[i]));
+    }
+    else if (i + 3 == tokens.size()) {
+        double start = GetValue(tokens[i]), stop = GetValue(tokens[i+1]), step = GetValue(tokens[i+2]);
+        if (ErrorFlag) return;
+        if (mode == "lin" && step != 0 && (stop - start) / step > -1e-9) {
+            int count = (int)std::floor((stop - start) / step + 1e-9) + 1;
+            for (int k = 0; k < count; k++) st.Values.push_back(start + k * step);
+        }
+        else if (mode != "lin" && step >= 1 && start > 0 && stop >= start) {
+            double ratio = std::pow((mode == "dec") ? 10.0 : 2.0, 1.0 / step);
+            int count = (int)std::floor(std::log(stop / start) / std::log(ratio) + 1e-9) + 1;
+            for (int k = 0; k < count; k++) st.Values.push_back(start * std::pow(ratio, k));
+        }
+    }
+    if (ErrorFlag) return;
+    if (st.Values.empty()) {
+        SetError("ERR022--Invalid .STEP Arguments!");
+        return;
+    }
+    // .STEP 放在 .MC 的对象之前
+    auto pos = StepList.begin();
+    while (pos != StepList.end() && pos->Dist == STEP_VALUES) pos++;
+    StepList.insert(pos, st);
+}
+
+inline void Circuit::CmdMC(const Vect<String>& tokens) {
+    // .MC runs name UNIF|GAUSS tol [name UNIF|GAUSS tol ...] [SEED s]
+    if (tokens.size() < 5) {
+        SetError("ERR023--Invalid .MC Arguments!");
+        return;
     }
+    McRuns = (int)GetValue(tokens[1]);
+    size_t i = 2;
+    while (i < tokens.size() && !ErrorFlag) {
+        String key = Str_ToLower(tokens[i]);
+        if (key == "seed" && i + 1 < tokens.size()) {
+            McSeed = (unsigned long long)GetValue(tokens[i+1]);
+            i += 2;
+            continue;
+        }
+        if (i + 2 >= tokens.size()) {
+            SetError("ERR023--Invalid .MC Arguments!");
+            return;
+        }
+        StepSpec st;
+        st.Name = key;
+        String dist = Str_ToLower(tokens[i+1]);
+        if (dist == "unif") st.Dist = STEP_UNIF;
+        else if (dist == "gauss") st.Dist = STEP_GAUSS;
+        else {
+            SetError("ERR023--Invalid .MC Arguments!");
+            return;
+        }
+        st.Tol = GetValue(tokens[i+2]);
+        StepList.push_back(st);
+        i += 3;
+    }
+    if (!ErrorFlag && McRuns <= 0) SetError("ERR023--Invalid .MC Arguments!");
+}
+
+inline void Circuit::CmdAlter(const Vect<String>& tokens) {
+    // .ALTER 元件名 新值 [元件名 新值 ...]
+    if (tokens.size() < 3 || tokens.size() % 2 == 0) {
+        SetError("ERR032--Invalid .ALTER Arguments!");
+        return;
+    }
+    Vect<std::pair<String, double>> changes;
+    for (size_t i = 1; i < tokens.size(); i += 2) changes.emplace_back(tokens[i], GetValue(tokens[i+1]));
+    AlterList.push_back(std::move(changes));
+}
+
+inline void Circuit::CmdSubckt(const Vect<String>& tokens) {
+    if (tokens.size() < 2) {
+        SetError("ERR028--Missing .SUBCKT Name!");
+        return;
+    }
+    if (CurSubckt) {
+        SetError("ERR037--Nested .SUBCKT: " + tokens[1]);
+        return;
+    }
+    CurSubckt = Mem.New<SubcktDef>(Mem);
+    CurSubckt->Name = tokens[1];
+    CurSubckt->PortCount = (int)tokens.size() - 2;
+    for (size_t i = 2; i < tokens.size(); i++) CurSubckt->Locals.Intern(tokens[i]); // 端口占局部编号 0~n-1
+    if (CurSubckt->Locals.Size() != CurSubckt->PortCount) SetError("ERR038--Duplicate .SUBCKT Port: " + tokens[1]);
+}
+
+inline void Circuit::CmdEnds(const Vect<String>& tokens) {
+    if (!CurSubckt) {
+        SetError("ERR039--.ENDS without .SUBCKT!");
+        return;
+    }
+    int id = SubcktNames.Intern(CurSubckt->Name);
+    if (id == (int)SubcktList.size()) SubcktList.push_back(CurSubckt);
+    else SubcktList[id] = CurSubckt; // 同名定义以后出现的为准
+    CurSubckt = nullptr;
+}
+
+inline void Circuit::CmdInclude(const Vect<StrView>& line) {
+    // .INCLUDE file 或 .LIB file name（.LIB name 为库文件中段的开始，在 ReadLine 中处理）
+    bool isLib = (line[0] == ".lib");
+    if (line.size() != (isLib ? 3u : 2u)) {
+        SetError("ERR031--Invalid " + String(line[0]) + " Arguments!");
+        return;
+    }
+    String path = SourceText(line[1]);
+    if (path.size() >= 2 && (path[0] == '"' || path[0] == '\'') && path.back() == path[0]) path = path.substr(1, path.size() - 2);
+    bool absolute = !path.empty() && (path[0] == '/' || path[0] == '\\' || (path.size() > 1 && path[1] == ':'));
+    if (!absolute) path = DirPath + path; // 相对路径相对于包含它的文件所在的目录
+    String section = isLib ? String(line[2]) : String();
+    if (!Included.insert(path + "\n" + section).second) return; // 已读入过，定义和模型已登记
+    String wantSave = LibWant;
+    bool skipSave = LibSkip;
+    LibWant = section;
+    LibSkip = isLib; // 库文件在所要的段开始之前全部跳过
+    String dirSave = DirPath;
+    size_t pos = path.find_last_of("/\\");
+    DirPath = (pos != std::string::npos) ? path.substr(0, pos + 1) : String(); // 被包含文件中的相对路径以它的目录为基准
+    IncludeDepth++;
+    ReadFile(path, true);
+    IncludeDepth--;
+    DirPath = dirSave;
+    LibWant = wantSave;
+    LibSkip = skipSave;
+}
+
+Circuit::Circuit(Workspace* ws) : Work(ws) {
+    if (Work) Mem.SetCache(&Work->Blocks); // 在第一次分配之前设置
+    NodeOf[Intern("0")] = -1;
+}
+
+Circuit::~Circuit() {
+    // 释放方程和线程池
+    delete MNA;
+    if (Work == nullptr) delete Pool; // 工作区的线程池由工作区释放
+    // 元件、元件组和文件映射随内存池 Mem 一起析构和释放
 }
 
 } // namespace xespice
-#endif // !XE_CIRCUIT_H
\ No newline at end of file
+#endif // !XE_CIRCUIT_H
@@ -14,6 +14,30 @@ struct Configuration {
     int NUMDGT = 6; // 输出结果的有效数字位数（0~15）
     double PIVTOL = 1e-13; // 矩阵中可被接受为主元的最小值（Pivot Tolerance）
     double GMIN = 1e-12; // 各节点到地的附加电导
+    int ORDERING = 1; // 矩阵列排序方法（0=natural，1=amd，2=colamd）
+    int ACCT = 0; // 是否在输出文件末尾附加矩阵统计信息（0/1）
+    int STATS = 0; // 运行统计（0=关闭，1=写入 JSON 文件，2=另外采样硬件性能计数器）
+    int SOLVER = 0; // 线性求解器（0=auto，1=dense，2=sparse，3=iterative，4=bbd）
+    int PARTS = 0; // BBD 撕裂的块数（0 表示按线程数，至少 2 块）
+    int KRYLOV = 0; // 迭代求解的方法（0=auto，1=cg，2=gmres，3=bicgstab）
+    double ITERTOL = 1e-10; // 迭代求解的相对残差容限
+    int ITERMAX = 1000; // 迭代求解每次的最大迭代次数
+    int THREADS = 1; // 并行线程数（0 表示使用全部硬件线程）
+    int FORMAT = 0; // 输出格式（0=text 制表符分隔的文本，1=raw 二进制 rawfile）
+    int DELTA = 0; // rawfile 是否对相邻点做异或差分压缩（0/1）
+    /*//////////////////// 非线性迭代 ////////////////////*/
+    int ITL1 = 100; // 直流分析牛顿迭代的最大次数
+    int ITL4 = 10; // 瞬态分析每个时间点牛顿迭代的最大次数
+    int BYPASS = 1; // 端电压几乎不变的器件是否跳过重新计算（0/1）
+    int GMINSTEPS = 10; // gmin 步进的步数（0 表示不使用）
+    int SRCSTEPS = 10; // 电源步进的步数（0 表示不使用）
+    /*//////////////////// 瞬态分析 ////////////////////*/
+    int METHOD = 0; // 积分方法（0=trap 梯形法，1=gear 二阶 BDF）
+    double RELTOL = 1e-3; // 相对误差容限
+    double ABSTOL = 1e-12; // 电流的绝对误差容限
+    double VNTOL = 1e-6; // 电压的绝对误差容限
+    double CHGTOL = 1e-14; // 电荷的绝对误差容限
+    double TRTOL = 7; // 截断误差的放宽系数
 };
 
 }
@@ -0,0 +1,364 @@
+#ifndef XE_DENSELU_H
+#define XE_DENSELU_H
+/*
+* 文件名称：xe_DenseLU.h
+* 摘    要：稠密矩阵的分块 LU 分解（列选主元），内核按 CPU 指令集（AVX2/AVX-512）在运行时选择
+* 作    者：H.J.Xie
+* 完成日期：2025年9月5日
+*/
+#include <cstdint>
+#include <algorithm>
+#include "xe_StdType.h"
+#include "xe_ThreadPool.h"
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define XE_DENSE_SIMD 1 // 编译器支持按函数指定目标指令集
+#else
+#define XE_DENSE_SIMD 0
+#endif
+namespace xespice
+{
+// 稠密 LU 内核使用的指令集
+enum DenseIsa {
+    ISA_SCALAR = 0, // 标量（由编译器自动向量化）
+    ISA_AVX2 = 1,   // AVX2 + FMA
+    ISA_AVX512 = 2  // AVX-512F
+};
+
+// 检测当前 CPU 支持的最高指令集
+static inline int Dense_DetectIsa() {
+#if XE_DENSE_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return ISA_AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return ISA_AVX2;
+#endif
+    return ISA_SCALAR;
+}
+
+// 秩 kc 更新（标量版本）：C(r,j) -= sum_k L(r,k) * U(k,j)，共 nr 行 nc 列，各矩阵行距为 ld
+static inline void Dense_UpdateScalar(int nr, int kc, const double* L, const double* U, double* C, int ld, int nc) {
+    for (int r = 0; r < nr; r++) {
+        double* c = C + (size_t)r * ld;
+        for (int k = 0; k < kc; k++) {
+            double l = L[(size_t)r * ld + k];
+            if (l == 0) continue;
+            const double* u = U + (size_t)k * ld;
+            for (int j = 0; j < nc; j++) c[j] -= l * u[j];
+        }
+    }
+}
+
+// 点积（标量版本，4 路累加）
+static inline double Dense_DotScalar(const double* a, const double* b, int n) {
+    double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += a[i] * b[i];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    for (; i < n; i++) s0 += a[i] * b[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+#if XE_DENSE_SIMD
+// 4 行的秩 kc 更新（AVX2 版本，每次处理 4x8 的子块，8 个累加寄存器）
+__attribute__((target("avx2,fma")))
+static inline void Dense_Update4AVX2(int kc, const double* L, const double* U, double* C, int ld, int nc) {
+    const double* L0 = L; const double* L1 = L + ld; const double* L2 = L + 2 * (size_t)ld; const double* L3 = L + 3 * (size_t)ld;
+    double* C0 = C; double* C1 = C + ld; double* C2 = C + 2 * (size_t)ld; double* C3 = C + 3 * (size_t)ld;
+    int j = 0;
+    for (; j + 8 <= nc; j += 8) {
+        __m256d c00 = _mm256_loadu_pd(C0 + j), c01 = _mm256_loadu_pd(C0 + j + 4);
+        __m256d c10 = _mm256_loadu_pd(C1 + j), c11 = _mm256_loadu_pd(C1 + j + 4);
+        __m256d c20 = _mm256_loadu_pd(C2 + j), c21 = _mm256_loadu_pd(C2 + j + 4);
+        __m256d c30 = _mm256_loadu_pd(C3 + j), c31 = _mm256_loadu_pd(C3 + j + 4);
+        const double* u = U + j;
+        for (int k = 0; k < kc; k++, u += ld) {
+            __m256d u0 = _mm256_loadu_pd(u), u1 = _mm256_loadu_pd(u + 4);
+            __m256d l = _mm256_broadcast_sd(L0 + k);
+            c00 = _mm256_fnmadd_pd(l, u0, c00); c01 = _mm256_fnmadd_pd(l, u1, c01);
+            l = _mm256_broadcast_sd(L1 + k);
+            c10 = _mm256_fnmadd_pd(l, u0, c10); c11 = _mm256_fnmadd_pd(l, u1, c11);
+            l = _mm256_broadcast_sd(L2 + k);
+            c20 = _mm256_fnmadd_pd(l, u0, c20); c21 = _mm256_fnmadd_pd(l, u1, c21);
+            l = _mm256_broadcast_sd(L3 + k);
+            c30 = _mm256_fnmadd_pd(l, u0, c30); c31 = _mm256_fnmadd_pd(l, u1, c31);
+        }
+        _mm256_storeu_pd(C0 + j, c00); _mm256_storeu_pd(C0 + j + 4, c01);
+        _mm256_storeu_pd(C1 + j, c10); _mm256_storeu_pd(C1 + j + 4, c11);
+        _mm256_storeu_pd(C2 + j, c20); _mm256_storeu_pd(C2 + j + 4, c21);
+        _mm256_storeu_pd(C3 + j, c30); _mm256_storeu_pd(C3 + j + 4, c31);
+    }
+    if (j < nc) Dense_UpdateScalar(4, kc, L, U + j, C + j, ld, nc - j);
+}
+
+// 4 行的秩 kc 更新（AVX-512 版本，每次处理 4x16 的子块）
+__attribute__((target("avx512f")))
+static inline void Dense_Update4AVX512(int kc, const double* L, const double* U, double* C, int ld, int nc) {
+    const double* L0 = L; const double* L1 = L + ld; const double* L2 = L + 2 * (size_t)ld; const double* L3 = L + 3 * (size_t)ld;
+    double* C0 = C; double* C1 = C + ld; double* C2 = C + 2 * (size_t)ld; double* C3 = C + 3 * (size_t)ld;
+    int j = 0;
+    for (; j + 16 <= nc; j += 16) {
+        __m512d c00 = _mm512_loadu_pd(C0 + j), c01 = _mm512_loadu_pd(C0 + j + 8);
+        __m512d c10 = _mm512_loadu_pd(C1 + j), c11 = _mm512_loadu_pd(C1 + j + 8);
+        __m512d c20 = _mm512_loadu_pd(C2 + j), c21 = _mm512_loadu_pd(C2 + j + 8);
+        __m512d c30 = _mm512_loadu_pd(C3 + j), c31 = _mm512_loadu_pd(C3 + j + 8);
+        const double* u = U + j;
+        for (int k = 0; k < kc; k++, u += ld) {
+            __m512d u0 = _mm512_loadu_pd(u), u1 = _mm512_loadu_pd(u + 8);
+            __m512d l = _mm512_set1_pd(L0[k]);
+            c00 = _mm512_fnmadd_pd(l, u0, c00); c01 = _mm512_fnmadd_pd(l, u1, c01);
+            l = _mm512_set1_pd(L1[k]);
+            c10 = _mm512_fnmadd_pd(l, u0, c10); c11 = _mm512_fnmadd_pd(l, u1, c11);
+            l = _mm512_set1_pd(L2[k]);
+            c20 = _mm512_fnmadd_pd(l, u0, c20); c21 = _mm512_fnmadd_pd(l, u1, c21);
+            l = _mm512_set1_pd(L3[k]);
+            c30 = _mm512_fnmadd_pd(l, u0, c30); c31 = _mm512_fnmadd_pd(l, u1, c31);
+        }
+        _mm512_storeu_pd(C0 + j, c00); _mm512_storeu_pd(C0 + j + 8, c01);
+        _mm512_storeu_pd(C1 + j, c10); _mm512_storeu_pd(C1 + j + 8, c11);
+        _mm512_storeu_pd(C2 + j, c20); _mm512_storeu_pd(C2 + j + 8, c21);
+        _mm512_storeu_pd(C3 + j, c30); _mm512_storeu_pd(C3 + j + 8, c31);
+    }
+    if (j < nc) Dense_Update4AVX2(kc, L, U + j, C + j, ld, nc - j);
+}
+
+// 点积（AVX2 版本）
+__attribute__((target("avx2,fma")))
+static inline double Dense_DotAVX2(const double* a, const double* b, int n) {
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), s0);
+        s1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), s1);
+    }
+    double t[4];
+    _mm256_storeu_pd(t, _mm256_add_pd(s0, s1));
+    double s = (t[0] + t[1]) + (t[2] + t[3]);
+    for (; i < n; i++) s += a[i] * b[i];
+    return s;
+}
+#endif
+
+// 稠密 LU 分解类：按行存储（行距对齐到 8 个 double），分块右视算法，分解得到 P*A = L*U
+// 每个面板（NB 列）先做带行交换的非分块分解，再对右侧行块做三角求解，最后对尾部子矩阵做秩 NB 更新；
+// 尾部更新按 (行块, 列块) 划分为任务，可在线程池上并行
+struct DenseLU {
+    int N = 0;              // 矩阵规模
+    int LD = 0;             // 行距
+    int Isa = ISA_SCALAR;   // 使用的指令集（DenseIsa）
+    ThreadPool* Pool = nullptr; // 并行更新所用线程池（nullptr 表示串行）
+    // 构造函数，检测 CPU 指令集
+    DenseLU() : Isa(Dense_DetectIsa()) {}
+    // 复制构造和赋值（重新对齐矩阵首地址）
+    DenseLU(const DenseLU& other);
+    DenseLU& operator=(const DenseLU& other);
+    // 设置规模为 n，并将矩阵清零
+    void Resize(int n);
+    // 将矩阵清零
+    void Zero();
+    // 获取第 i 行的首地址
+    double* Row(int i) { return M + (size_t)i * LD; }
+    // 获取行置换的逆（原始行号 -> 分解后的行位置）
+    const Vect<int>& RowPosition() { return Pinv; }
+    // 对矩阵进行列选主元分块 LU 分解，返回 true 表示成功
+    bool Factorize(double pivotTol);
+    // 沿用上次的行置换进行分解（矩阵须已按 RowPosition 排列），主元过小时返回 false
+    bool Refactorize(double pivotTol);
+    // 求解 Ax = b
+    void Solve(const double* b, double* x);
+    // 同时求解 m 个右端项（b 和 x 按行交织存储：第 i 行第 r 个右端项位于 [i*m+r]）
+    void SolveBatch(int m, const double* b, double* x);
+private:
+    static const int NB = 64;  // 面板宽度
+    static const int RB = 64;  // 尾部更新任务的行块大小
+    static const int CB = 256; // 尾部更新任务的列块大小
+    Vect<double> Buf;          // 矩阵存储（含对齐余量）
+    double* M = nullptr;       // 对齐后的矩阵首地址
+    Vect<int> Perm;            // 第 i 行位置上的原始行号
+    Vect<int> Pinv;            // 原始行号所在的行位置
+    Vect<double> Y;            // 替换时的临时向量
+    Vect<double> YBatch;       // 多右端项替换时的临时矩阵
+    // 分块分解主过程（pivoting 表示是否进行主元搜索）
+    bool Blocked(bool pivoting, double pivotTol);
+    // 对 [r0,r1) 行、[c0,c1) 列做秩 kc 更新，L 取自第 k0 列起，U 取自第 k0 行起
+    void Update(int r0, int r1, int c0, int c1, int k0, int kc);
+    // 点积
+    double Dot(const double* a, const double* b, int n);
+};
+
+inline void DenseLU::Resize(int n) {
+    N = n;
+    LD = (n + 7) & ~7;
+    Buf.assign((size_t)n * LD + 8, 0.0);
+    uintptr_t addr = (uintptr_t)Buf.data();
+    M = Buf.data() + ((64 - addr % 64) % 64) / sizeof(double); // 对齐到 64 字节
+    Perm.resize(n);
+    Pinv.resize(n);
+    Y.resize(n);
+    for (int i = 0; i < n; i++) Perm[i] = Pinv[i] = i;
+}
+
+inline DenseLU::DenseLU(const DenseLU& other) {
+    *this = other;
+}
+
+inline DenseLU& DenseLU::operator=(const DenseLU& other) {
+    if (this == &other) return *this;
+    N = other.N;
+    LD = other.LD;
+    Isa = other.Isa;
+    Pool = other.Pool;
+    Perm = other.Perm;
+    Pinv = other.Pinv;
+    Y = other.Y;
+    Buf.assign(other.Buf.size(), 0.0);
+    M = nullptr;
+    if (!Buf.empty()) {
+        uintptr_t addr = (uintptr_t)Buf.data();
+        M = Buf.data() + ((64 - addr % 64) % 64) / sizeof(double);
+        std::copy(other.M, other.M + (size_t)N * LD, M);
+    }
+    return *this;
+}
+
+inline void DenseLU::Zero() {
+    std::fill(M, M + (size_t)N * LD, 0.0);
+}
+
+inline void DenseLU::Update(int r0, int r1, int c0, int c1, int k0, int kc) {
+    int i = r0;
+    double* base = M;
+#if XE_DENSE_SIMD
+    if (Isa != ISA_SCALAR) {
+        for (; i + 4 <= r1; i += 4) {
+            const double* L = base + (size_t)i * LD + k0;
+            const double* U = base + (size_t)k0 * LD + c0;
+            double* C = base + (size_t)i * LD + c0;
+            if (Isa == ISA_AVX512) Dense_Update4AVX512(kc, L, U, C, LD, c1 - c0);
+            else Dense_Update4AVX2(kc, L, U, C, LD, c1 - c0);
+        }
+    }
+#endif
+    if (i < r1) {
+        Dense_UpdateScalar(r1 - i, kc, base + (size_t)i * LD + k0, base + (size_t)k0 * LD + c0,
+            base + (size_t)i * LD + c0, LD, c1 - c0);
+    }
+}
+
+inline double DenseLU::Dot(const double* a, const double* b, int n) {
+#if XE_DENSE_SIMD
+    if (Isa != ISA_SCALAR) return Dense_DotAVX2(a, b, n);
+#endif
+    return Dense_DotScalar(a, b, n);
+}
+
+inline bool DenseLU::Blocked(bool pivoting, double pivotTol) {
+    for (int k0 = 0; k0 < N; k0 += NB) {
+        int k1 = std::min(k0 + NB, N);
+        // 面板分解：第 k0~k1 列
+        for (int k = k0; k < k1; k++) {
+            int ipiv = k;
+            double amax = 0;
+            for (int i = k; i < N; i++) {
+                double a = std::abs(Row(i)[k]);
+                if (a > amax) { amax = a; ipiv = i; }
+            }
+            if (pivoting && ipiv != k) { // 交换整行
+                std::swap_ranges(Row(k), Row(k) + N, Row(ipiv));
+                std::swap(Perm[k], Perm[ipiv]);
+            }
+            double* rk = Row(k);
+            double pivot = rk[k];
+            double apiv = std::abs(pivot);
+            if (apiv < pivotTol) return false; // 主元过小，矩阵奇异
+            if (!pivoting && apiv < 1e-3 * amax) return false; // 沿用的主元相对过小
+            for (int i = k + 1; i < N; i++) {
+                double* ri = Row(i);
+                if (ri[k] == 0) continue;
+                double l = (ri[k] /= pivot); // L(i,k)
+                for (int j = k + 1; j < k1; j++) ri[j] -= l * rk[j];
+            }
+        }
+        if (k1 >= N) break;
+        // 右侧行块的三角求解：U12 = L11^-1 * A12，按列块并行
+        int nct = (N - k1 + CB - 1) / CB;
+        std::function<void(int)> trsm = [&](int t) {
+            int c0 = k1 + t * CB, c1 = std::min(c0 + CB, N);
+            for (int i = k0 + 1; i < k1; i++) Update(i, i + 1, c0, c1, k0, i - k0);
+        };
+        // 尾部子矩阵更新：A22 -= L21 * U12，按 (行块, 列块) 并行
+        int nrt = (N - k1 + RB - 1) / RB;
+        std::function<void(int)> gemm = [&](int t) {
+            int r0 = k1 + (t / nct) * RB, r1 = std::min(r0 + RB, N);
+            int c0 = k1 + (t % nct) * CB, c1 = std::min(c0 + CB, N);
+            Update(r0, r1, c0, c1, k0, k1 - k0);
+        };
+        if (Pool && Pool->Size() > 1 && N - k1 > CB) {
+            Pool->Run(nct, trsm);
+            Pool->Run(nrt * nct, gemm);
+        }
+        else {
+            for (int t = 0; t < nct; t++) trsm(t);
+            for (int t = 0; t < nrt * nct; t++) gemm(t);
+        }
+    }
+    for (int i = 0; i < N; i++) Pinv[Perm[i]] = i;
+    return true;
+}
+
+inline bool DenseLU::Factorize(double pivotTol) {
+    for (int i = 0; i < N; i++) Perm[i] = i;
+    return Blocked(true, pivotTol);
+}
+
+inline bool DenseLU::Refactorize(double pivotTol) {
+    return Blocked(false, pivotTol);
+}
+
+inline void DenseLU::Solve(const double* b, double* x) {
+    double* y = Y.data();
+    // 前向替换，求解 L * y = P*b
+    for (int i = 0; i < N; i++) y[i] = b[Perm[i]] - Dot(Row(i), y, i);
+    // 后向替换，求解 U * x = y
+    for (int i = N - 1; i >= 0; i--) {
+        const double* ri = Row(i);
+        y[i] = (y[i] - Dot(ri + i + 1, y + i + 1, N - i - 1)) / ri[i];
+    }
+    std::copy(y, y + N, x);
+}
+
+inline void DenseLU::SolveBatch(int m, const double* b, double* x) {
+    YBatch.resize((size_t)N * m);
+    double* y = YBatch.data();
+    // 前向替换：y(i,:) = b(P(i),:) - sum_k L(i,k) * y(k,:)
+    for (int i = 0; i < N; i++) {
+        double* yi = y + (size_t)i * m;
+        std::copy(b + (size_t)Perm[i] * m, b + (size_t)(Perm[i] + 1) * m, yi);
+        const double* ri = Row(i);
+        for (int k = 0; k < i; k++) {
+            double l = ri[k];
+            if (l == 0) continue;
+            const double* yk = y + (size_t)k * m;
+            for (int r = 0; r < m; r++) yi[r] -= l * yk[r];
+        }
+    }
+    // 后向替换：y(i,:) = (y(i,:) - sum_k U(i,k) * y(k,:)) / U(i,i)
+    for (int i = N - 1; i >= 0; i--) {
+        double* yi = y + (size_t)i * m;
+        const double* ri = Row(i);
+        for (int k = i + 1; k < N; k++) {
+            double u = ri[k];
+            if (u == 0) continue;
+            const double* yk = y + (size_t)k * m;
+            for (int r = 0; r < m; r++) yi[r] -= u * yk[r];
+        }
+        for (int r = 0; r < m; r++) yi[r] /= ri[i];
+    }
+    std::copy(y, y + (size_t)N * m, x);
+}
+
+} // namespace xespice
+#endif // !XE_DENSELU_H
@@ -7,167 +7,681 @@
 * 完成日期：2025年8月28日
 */
 #include <cstring>
-namespace xespice 
+#include <complex>
+#include <type_traits>
+#include "xe_StdType.h"
+#include "xe_SparseLU.h"
+#include "xe_Ordering.h"
+#include "xe_DenseLU.h"
+#include "xe_Krylov.h"
+#include "xe_BBD.h"
+#include "xe_Timer.h"
+namespace xespice
 {
-// 实数线性方程组类，使用列选主元法 LU 分解求解 Ax = B
-struct Equation {
+// 线性求解器类型
+enum SolverType {
+    SOLVER_AUTO = 0,  // 自动选择（规模很小或预测填充接近稠密时使用稠密 LU）
+    SOLVER_DENSE = 1, // 稠密分块 LU
+    SOLVER_SPARSE = 2, // 稀疏 LU
+    SOLVER_ITERATIVE = 3, // 预条件 Krylov 迭代（不分解，只用于实数方程；不收敛时改用稀疏 LU）
+    SOLVER_BBD = 4 // 撕裂为加边块对角形式，各块并行分解、界面用 Schur 补求解（只用于实数方程；分解失败时改用稀疏 LU）
+};
+// 线性方程组类（T 为 double 或 std::complex<double>），系数矩阵以稀疏格式存储，使用列选主元法稀疏 LU 分解求解 Ax = B
+// 矩阵的非零结构由 AddA/SetA 的调用（即各元件的 stamp）自动建立
+// 反复 stamp 时可先用 SlotA/SlotB 取得各元素的槽位，再直接写入 DataA/DataB（接地元素得到哑槽位：A 为 0 号，B 为 N 号）
+// （并行 stamp 的元件必须跳过哑槽位，不能写入：哑槽位不参与写冲突着色，多个线程同时写入是数据竞争）
+// 对于规模较小或填充后接近稠密的实数矩阵，可改用稠密分块 LU 分解
+// 对于规模很大的实数矩阵（如电源网格），可改用预条件 Krylov 迭代：Refactorize 只更新预条件子，Substitute 迭代求解
+// 也可撕裂为多个互不耦合的块和界面，在线程池上并行分解各块（见 BBDSolver）
+template<typename T>
+struct EquationT {
 private:
+    template<typename U> friend struct EquationT;
+    static constexpr bool IsReal = std::is_same<T, double>::value; // 是否为实数方程
     int N = 0;           // 方程组的规模（未知数个数）
-    int* P = nullptr;    // 用于列主元法的行交换记录（N）
-    double* A = nullptr; // 系数矩阵（N*N）
-    double* X = nullptr; // 解向量（N）
-    double* B = nullptr; // 常数向量（N）
-    double* Y = nullptr; // 用于存储中间结果 Y 的临时向量（N）
-    double* LU = nullptr; // 用于存储 LU 分解结果的临时矩阵（N*N）
+    Vect<int> Ei;        // 各非零元的行号（按首次出现的顺序，0 号为接地哑槽位）
+    Vect<int> Ej;        // 各非零元的列号
+    Vect<T> Ax;          // 各非零元的数值（Ax[0] 为哑槽位，不属于矩阵）
+    Vect<int> EntryHash; // (i,j) -> 非零元序号的开放寻址散列表（0 表示空位，键取自 Ei/Ej，容量为 2 的幂）
+    bool PatternDirty = true; // 非零结构是否有变化（需要重建 CSC）
+    Vect<int> Ap;        // CSC 格式的列指针（N+1）
+    Vect<int> Ai;        // CSC 格式的行号
+    Vect<int> Ae;        // CSC 格式各位置对应的非零元序号
+    Vect<T> Cx;          // CSC 格式的数值（分解时由 Ax 收集而来）
+    int Ordering = ORDER_AMD; // 列排序方法（OrderType）
+    Vect<int> Q;         // 填充缩减排序得到的列顺序（N）
+    long long PredNNZ = 0; // 符号分析预测的 L+U 非零元个数
+    SparseLU<T> LU;      // 稀疏 LU 分解结果
+    int Solver = SOLVER_AUTO; // 求解器类型（SolverType）
+    bool UseDense = false; // 本次分析选用的是否为稠密 LU
+    DenseLU Dense;       // 稠密 LU 分解结果（只用于实数方程）
+    bool UseIter = false; // 本次分析选用的是否为 Krylov 迭代
+    bool IterDirty = true; // 非零结构变化后是否需要重建迭代求解器的结构
+    int IterFallback = 0; // 迭代不收敛而改用稀疏 LU 的次数
+    double PivTol = 1e-13; // 最近一次分析的主元容忍度（迭代不收敛改用 LU 时使用）
+    KrylovSolver Krylov; // Krylov 迭代求解器（只用于实数方程）
+    bool UseBBD = false; // 本次分析选用的是否为 BBD 撕裂求解
+    bool BBDDirty = true; // 非零结构变化后是否需要重新划分
+    int Parts = 0;       // BBD 撕裂的块数（0 表示按线程数，至少 2 块）
+    int BBDFallback = 0; // BBD 分解失败而改用稀疏 LU 的次数
+    BBDSolver Tear;      // BBD 撕裂求解器（只用于实数方程）
+    bool Analyzed = false; // 是否已完成符号分析（排序与主元选择）
+    int FullCount = 0;   // 完整分解（含主元选择）的次数
+    int RefactCount = 0; // 数值重分解的次数
+    double FactorTime = 0; // 分解（含符号分析）累计耗时（秒）
+    double SolveTime = 0;  // 替换求解累计耗时（秒）
+    bool Recording = false; // 是否记录 SlotA/SlotB 返回的槽位
+    Vect<int> Record;    // 记录的槽位（A 的槽位为非负数，B 的槽位 s 记为 ~s，不含哑槽位）
+    // 收集 CSC 格式的数值
+    void Gather();
+    // 将非零元散布到稠密矩阵（permuted 为 true 时按已记录的行置换放置）
+    void Scatter(bool permuted);
+    Vect<T> X;           // 解向量（N）
+    Vect<T> BatchB;      // 多右端项替换时交织存储的常数向量
+    Vect<T> BatchX;      // 多右端项替换时交织存储的解向量
+    Vect<T> B;           // 常数向量（N+1，B[N] 为哑槽位）
+    // 查找非零元 (i,j) 的序号，若不存在则创建
+    int Entry(int i, int j);
+    // 查找非零元 (i,j) 在散列表中的位置，不存在时返回应插入的空位
+    size_t Probe(int i, int j) const;
+    // 以新的容量重建散列表
+    void Rehash(size_t cap);
+    // 由非零元列表建立 CSC 结构（每列行号升序）
+    void BuildCSC();
+    // 用 Krylov 迭代求解 Ax = b（x 为初值），不收敛时改用稀疏 LU 分解求解（分解失败即矩阵奇异时返回 false）
+    bool IterSolve(const T* b, T* x);
 public:
     //构造函数，初始化方程组规模为 n，矩阵 A 和 向量 B 会初始化为 0
-    Equation(int n);
+    EquationT(int n);
+    //复制另一个方程组（可为不同数值类型）的非零结构，数值清零，使两者的槽位一一对应
+    template<typename U> void CopyPattern(const EquationT<U>& other);
     // 获取方程组规模（未知数个数）
-    int Size(); 
+    int Size();
+    // 获取系数矩阵 A 的非零元个数（结构非零元，含数值为 0 的元素）
+    int NNZ();
+    // 获取最近一次分解得到的 L 和 U 的非零元个数
+    int FactorNNZ();
+    // 获取一次数值重分解的乘加次数（估计值，用于与替换求解的代价比较）
+    long long FactorFlops();
+    // 获取符号分析预测的 L 和 U 的非零元个数
+    long long PredictedNNZ();
+    // 设置列排序方法（OrderType），在下一次分解时生效
+    void SetOrdering(int type);
+    // 设置求解器类型（SolverType），在下一次分析时生效
+    void SetSolver(int type);
+    // 设置 Krylov 迭代的方法（KrylovMethod）、相对残差容限和最大迭代次数
+    void SetKrylov(int method, double tol, int maxIter);
+    // 设置稠密 LU 尾部更新所用的线程池（nullptr 表示串行）
+    void SetThreadPool(ThreadPool* pool);
+    // 本次分析是否选用了稠密 LU
+    bool IsDense();
+    // 本次分析是否选用了 Krylov 迭代
+    bool IsIterative();
+    // 获取 Krylov 迭代求解器（统计迭代次数与残差）
+    const KrylovSolver& Iterative();
+    // 获取迭代不收敛而改用稀疏 LU 的次数
+    int IterFallbackCount();
+    // 设置 BBD 撕裂的块数（0 表示按线程数），在下一次分析时生效
+    void SetTearing(int parts);
+    // 本次分析是否选用了 BBD 撕裂求解
+    bool IsTearing();
+    // 获取 BBD 撕裂求解器（统计块数与界面规模）
+    const BBDSolver& Tearing();
+    // 获取 BBD 分解失败而改用稀疏 LU 的次数
+    int TearFallbackCount();
+    // 获取稀疏 LU 的主元统计（最小、最大主元绝对值，偏离对角的主元个数），未使用稀疏 LU 时返回 false
+    bool PivotStats(double& minPivot, double& maxPivot, int& offDiagonal);
     //获取系数矩阵 A 的元素 A(i,j)
-    double GetA(int i, int j);
+    T GetA(int i, int j);
     //获取常数向量 B 的元素 B(i)
-    double GetB(int i); 
+    T GetB(int i);
     //获取解向量 X 的元素 X(i)
-    double GetX(int i);
+    T GetX(int i);
     //设置系数矩阵 A 的元素 A(i,j) = val
-    void SetA(int i, int j, double val);
+    void SetA(int i, int j, T val);
     //设置常数向量 B 的元素 B(i) = val
-    void SetB(int i, double val);
+    void SetB(int i, T val);
     //系数矩阵 A 的元素 A(i,j) 增加 val
-    void AddA(int i, int j, double val);
+    void AddA(int i, int j, T val);
     //常数向量 B 的元素 B(i) 增加 val
-    void AddB(int i, double val);
+    void AddB(int i, T val);
+    //获取 A(i,j) 的槽位（即在 DataA 中的下标），不存在则创建；行或列接地时返回哑槽位
+    int SlotA(int i, int j);
+    //获取 B(i) 的槽位（即在 DataB 中的下标）；接地时返回哑槽位
+    int SlotB(int i);
+    //获取 A 的槽位 slot 所在的行号和列号（哑槽位为 -1）
+    int SlotRow(int slot);
+    int SlotCol(int slot);
+    //获取 A 的数值存储首地址（按槽位访问；调用 SlotA 后可能失效，需重新获取）
+    T* DataA();
+    //获取 B 的数值存储首地址（按槽位访问）
+    T* DataB();
+    //开始记录 SlotA/SlotB 返回的槽位（用于分析元件之间的写冲突）
+    void BeginRecord();
+    //结束记录，返回记录到的槽位（A 的槽位为非负数，B 的槽位 s 记为 ~s）
+    const Vect<int>& EndRecord();
     //对系数矩阵 A 进行列选主元法 LU 分解（pivotTol为最小主元容忍度，返回true表示分解成功）
-    bool Factorize(double pivotTol = 1e-13); 
+    //每次调用都会重新进行排序（结构变化时）和主元选择
+    bool Factorize(double pivotTol = 1e-13);
+    //符号分析：建立 CSC 结构、计算填充缩减排序并选取主元（同时完成一次数值分解）
+    bool Analyze(double pivotTol = 1e-13);
+    //数值重分解：沿用已记录的排序和主元，只重新消去（结构未变时只需数值计算）
+    //尚未分析、结构已变化或主元小于容忍度时，自动退回到完整的 Analyze
+    bool Refactorize(double pivotTol = 1e-13);
+    //获取完整分解和数值重分解的次数
+    int FullFactorCount();
+    int RefactorCount();
+    //获取分解和替换求解的累计耗时（秒）
+    double FactorSeconds();
+    double SolveSeconds();
+    //将 A 的非零元数值和向量 B 清零（保留非零结构），用于重新 stamp
+    void Clear();
     //对分解后的矩阵进行前向和后向替换，求解线性方程组
-    void Substitute();
-    //保存当前的矩阵 A
-    void SaveA(double* outA);
+    //Krylov 迭代不收敛而改用的 LU 分解失败（矩阵奇异）时返回 false，此时解向量无效
+    bool Substitute();
+    //对 nrhs 个常数向量同时进行替换（Bs 和 Xs 按列存储：第 r 个向量位于 [r*N, (r+1)*N)）
+    //多个右端项分块交织后一起消去，共用 L 和 U 的每次访问（返回值同 Substitute）
+    bool SubstituteBatch(int nrhs, const T* Bs, T* Xs);
+    //保存当前的矩阵 A 的非零元数值（NNZ 个，要求保存与加载之间非零结构不变）
+    void SaveA(T* outA);
     //保存当前的向量 B
-    void SaveB(double* outB); 
+    void SaveB(T* outB);
     //保存当前的向量 X
-    void SaveX(double* outX); 
-    //加载输入的矩阵 A
-    void LoadA(double* inA);
+    void SaveX(T* outX);
+    //加载输入的矩阵 A 的非零元数值（NNZ 个）
+    void LoadA(T* inA);
     //加载输入的向量 B
-    void LoadB(double* inB); 
-    //析构函数，释放内存
-    ~Equation(); 
+    void LoadB(T* inB);
+    //加载输入的向量 X（作为非线性迭代的初值）
+    void LoadX(T* inX);
 };
 
-inline Equation::Equation(int n) : N(n) {
-    A = new double[n * n](); // 初始化为 0
-    B = new double[n](); // 初始化为 0
-    X = new double[n]();
-    P = new int[n];
-    Y = new double[n];
-    LU = new double[n * n];
+template<typename T>
+inline EquationT<T>::EquationT(int n) : N(n) {
+    X.assign(n, 0);
+    B.assign(n + 1, 0); // 初始化为 0
+    Ei.push_back(-1); // 0 号为接地哑槽位
+    Ej.push_back(-1);
+    Ax.push_back(0);
+}
+
+template<typename T>
+template<typename U>
+inline void EquationT<T>::CopyPattern(const EquationT<U>& other) {
+    N = other.N;
+    Ei = other.Ei;
+    Ej = other.Ej;
+    EntryHash = other.EntryHash;
+    Ax.assign(Ei.size(), T(0));
+    X.assign(N, T(0));
+    B.assign(N + 1, T(0));
+    Ordering = other.Ordering;
+    PatternDirty = true;
+    Analyzed = false;
+}
+
+template<typename T>
+inline size_t EquationT<T>::Probe(int i, int j) const {
+    unsigned long long key = (unsigned long long)(unsigned)i << 32 | (unsigned)j;
+    key *= 0x9E3779B97F4A7C15ull; // 乘法散列，取高位
+    size_t mask = EntryHash.size() - 1;
+    size_t p = (size_t)(key >> 32) & mask;
+    while (EntryHash[p] != 0) {
+        int e = EntryHash[p];
+        if (Ei[e] == i && Ej[e] == j) return p;
+        p = (p + 1) & mask;
+    }
+    return p;
 }
 
-inline int Equation::Size() { 
-    return N; 
+template<typename T>
+inline void EquationT<T>::Rehash(size_t cap) {
+    EntryHash.assign(cap, 0);
+    for (int e = 1; e < (int)Ei.size(); e++) EntryHash[Probe(Ei[e], Ej[e])] = e;
+}
+
+template<typename T>
+inline int EquationT<T>::Entry(int i, int j) {
+    if (Ax.size() * 2 > EntryHash.size()) Rehash(std::max<size_t>(EntryHash.size() * 2, 64)); // 装载率不超过 1/2
+    size_t p = Probe(i, j);
+    if (EntryHash[p] != 0) return EntryHash[p];
+    int e = (int)Ax.size();
+    EntryHash[p] = e;
+    Ei.push_back(i);
+    Ej.push_back(j);
+    Ax.push_back(0);
+    PatternDirty = true;
+    return e;
+}
+
+template<typename T>
+inline void EquationT<T>::BuildCSC() {
+    int nnz = (int)Ax.size() - 1;
+    // 先按行分桶，再按列分桶，得到每列行号升序的 CSC 结构（跳过哑槽位）
+    Vect<int> rowPtr(N + 1, 0), rowOrder(nnz);
+    for (int e = 1; e <= nnz; e++) rowPtr[Ei[e] + 1]++;
+    for (int i = 0; i < N; i++) rowPtr[i + 1] += rowPtr[i];
+    for (int e = 1; e <= nnz; e++) rowOrder[rowPtr[Ei[e]]++] = e;
+    Ap.assign(N + 1, 0);
+    for (int e = 1; e <= nnz; e++) Ap[Ej[e] + 1]++;
+    for (int j = 0; j < N; j++) Ap[j + 1] += Ap[j];
+    Vect<int> next(Ap.begin(), Ap.end() - 1);
+    Ai.resize(nnz);
+    Ae.resize(nnz);
+    for (int e : rowOrder) {
+        int p = next[Ej[e]]++;
+        Ai[p] = Ei[e];
+        Ae[p] = e;
+    }
+    Cx.resize(nnz);
+    PatternDirty = false;
+}
+
+template<typename T>
+inline int EquationT<T>::Size() {
+    return N;
+}
+template<typename T>
+inline int EquationT<T>::NNZ() {
+    return (int)Ax.size() - 1;
+}
+template<typename T>
+inline int EquationT<T>::FactorNNZ() {
+    if (UseIter) return (int)Krylov.PrecondNNZ();
+    if (UseBBD) return Tear.FactorNNZ();
+    return UseDense ? N * N : LU.FactorNNZ();
+}
+template<typename T>
+inline long long EquationT<T>::FactorFlops() {
+    if (UseIter) return Krylov.PrecondNNZ();
+    if (UseBBD) return Tear.FactorFlops();
+    return UseDense ? (long long)N * N * N / 3 : LU.FactorFlops();
+}
+template<typename T>
+inline long long EquationT<T>::PredictedNNZ() {
+    return PredNNZ;
+}
+template<typename T>
+inline void EquationT<T>::SetOrdering(int type) {
+    if (type != Ordering) PatternDirty = true; // 需要重新排序
+    Ordering = type;
+}
+template<typename T>
+inline void EquationT<T>::SetSolver(int type) {
+    if (type != Solver) Analyzed = false; // 需要重新分析
+    Solver = type;
+}
+template<typename T>
+inline void EquationT<T>::SetKrylov(int method, double tol, int maxIter) {
+    Krylov.SetMethod(method);
+    Krylov.Tol = tol;
+    Krylov.Limit = maxIter;
+    Analyzed = false; // 需要重新计算预条件子
+}
+template<typename T>
+inline void EquationT<T>::SetThreadPool(ThreadPool* pool) {
+    Dense.Pool = pool;
 }
-inline double Equation::GetA(int i, int j) { 
+template<typename T>
+inline bool EquationT<T>::IsDense() {
+    return UseDense;
+}
+template<typename T>
+inline bool EquationT<T>::IsIterative() {
+    return UseIter;
+}
+template<typename T>
+inline const KrylovSolver& EquationT<T>::Iterative() {
+    return Krylov;
+}
+template<typename T>
+inline int EquationT<T>::IterFallbackCount() {
+    return IterFallback;
+}
+template<typename T>
+inline void EquationT<T>::SetTearing(int parts) {
+    if (parts != Parts) BBDDirty = true; // 需要重新划分
+    Parts = parts;
+}
+template<typename T>
+inline bool EquationT<T>::IsTearing() {
+    return UseBBD;
+}
+template<typename T>
+inline const BBDSolver& EquationT<T>::Tearing() {
+    return Tear;
+}
+template<typename T>
+inline int EquationT<T>::TearFallbackCount() {
+    return BBDFallback;
+}
+template<typename T>
+inline bool EquationT<T>::PivotStats(double& minPivot, double& maxPivot, int& offDiagonal) {
+    if (!Analyzed || UseDense || UseIter || UseBBD) return false;
+    LU.PivotStats(minPivot, maxPivot, offDiagonal);
+    return true;
+}
+template<typename T>
+inline T EquationT<T>::GetA(int i, int j) {
     if ((i | j) < 0) return 0; // 忽略负索引
-    else return A[i * N + j]; 
+    if (EntryHash.empty()) return 0;
+    int e = EntryHash[Probe(i, j)];
+    return (e == 0) ? 0 : Ax[e];
 }
-inline double Equation::GetB(int i) { 
-    return (i < 0) ? 0 : B[i]; 
+template<typename T>
+inline T EquationT<T>::GetB(int i) {
+    return (i < 0) ? 0 : B[i];
 }
-inline double Equation::GetX(int i) { 
-    return (i < 0) ? 0 : X[i]; 
+template<typename T>
+inline T EquationT<T>::GetX(int i) {
+    return (i < 0) ? 0 : X[i];
 }
-inline void Equation::SetA(int i, int j, double val) {
+template<typename T>
+inline void EquationT<T>::SetA(int i, int j, T val) {
     if ((i | j) < 0) return;
-    A[i * N + j] = val; 
+    Ax[Entry(i, j)] = val;
 }
-inline void Equation::SetB(int i, double val) {
-    if (i < 0) return; 
-    B[i] = val; 
+template<typename T>
+inline void EquationT<T>::SetB(int i, T val) {
+    if (i < 0) return;
+    B[i] = val;
 }
-inline void Equation::AddA(int i, int j, double val) {
+template<typename T>
+inline void EquationT<T>::AddA(int i, int j, T val) {
     if ((i | j) < 0) return;
-    A[i * N + j] += val; 
-}
-inline void Equation::AddB(int i, double val) {
-    if (i < 0) return; 
-    B[i] += val; 
-}
-
-inline bool Equation::Factorize(double pivotTol) {
-    // 初始化行交换记录
-    for (int i = 0; i < N; i++) P[i] = i;
-    // 列选主元 
-    for (int j = 0; j < N; j++) {
-        double pivot = 0;
-        int k = j; // 记录当前列主元所在行
-        for (int i = j; i < N; i++) {
-            int ij = P[i] * N + j; //计算 A[P[i], j] 的线性索引
-            double a = (A[ij] >= 0) ? A[ij] : -A[ij]; // 计算绝对值
-            if (a > pivot) {
-                pivot = a; // 选取最大列主元
-                k = i; // 记录最大列主元所在行
+    Ax[Entry(i, j)] += val;
+}
+template<typename T>
+inline void EquationT<T>::AddB(int i, T val) {
+    if (i < 0) return;
+    B[i] += val;
+}
+template<typename T>
+inline int EquationT<T>::SlotA(int i, int j) {
+    if ((i | j) < 0) return 0;
+    int e = Entry(i, j);
+    if (Recording) Record.push_back(e);
+    return e;
+}
+template<typename T>
+inline int EquationT<T>::SlotB(int i) {
+    if (i < 0) return N;
+    if (Recording) Record.push_back(~i);
+    return i;
+}
+template<typename T>
+inline int EquationT<T>::SlotRow(int slot) {
+    return Ei[slot];
+}
+template<typename T>
+inline int EquationT<T>::SlotCol(int slot) {
+    return Ej[slot];
+}
+template<typename T>
+inline void EquationT<T>::BeginRecord() {
+    Record.clear();
+    Recording = true;
+}
+template<typename T>
+inline const Vect<int>& EquationT<T>::EndRecord() {
+    Recording = false;
+    return Record;
+}
+template<typename T>
+inline T* EquationT<T>::DataA() {
+    return Ax.data();
+}
+template<typename T>
+inline T* EquationT<T>::DataB() {
+    return B.data();
+}
+
+template<typename T>
+inline void EquationT<T>::Gather() {
+    for (int p = 0; p < (int)Cx.size(); p++) Cx[p] = Ax[Ae[p]];
+}
+
+template<typename T>
+inline void EquationT<T>::Scatter(bool permuted) {
+    if constexpr (IsReal) {
+        Dense.Zero();
+        const int* pos = Dense.RowPosition().data();
+        for (int e = 1; e < (int)Ax.size(); e++) {
+            int i = permuted ? pos[Ei[e]] : Ei[e];
+            Dense.Row(i)[Ej[e]] += Ax[e];
+        }
+    }
+}
+
+template<typename T>
+inline bool EquationT<T>::Factorize(double pivotTol) {
+    return Analyze(pivotTol);
+}
+
+template<typename T>
+inline bool EquationT<T>::Analyze(double pivotTol) {
+    ScopedTimer timer(FactorTime);
+    PivTol = pivotTol;
+    UseIter = IsReal && Solver == SOLVER_ITERATIVE;
+    UseBBD = IsReal && Solver == SOLVER_BBD;
+    if (PatternDirty) { // 非零结构变化时重建 CSC 并重新排序（迭代求解不需要填充缩减排序，撕裂求解在各块内排序）
+        BuildCSC();
+        PredNNZ = UseIter ? (long long)Ap[N] : UseBBD ? 0 : Ord_Compute(Q, N, Ap.data(), Ai.data(), Ordering);
+        IterDirty = true;
+        BBDDirty = true;
+    }
+    if constexpr (IsReal) {
+        if (UseBBD) {
+            UseDense = false;
+            FullCount++;
+            Gather();
+            if (BBDDirty) {
+                int parts = Parts > 0 ? Parts : std::max(2, Dense.Pool ? Dense.Pool->Size() : 1);
+                PredNNZ = Tear.Setup(N, Ap.data(), Ai.data(), Cx.data(), parts, Ordering);
+                BBDDirty = false;
             }
+            Analyzed = PredNNZ >= 0 && Tear.Factorize(Cx.data(), pivotTol, false, Dense.Pool);
+            if (Analyzed) return true;
+            // 界面过大，或块、界面奇异（如支路方程落在块内且对角元为 0）：改用稀疏 LU，之后不再撕裂
+            BBDFallback++;
+            Solver = SOLVER_SPARSE;
+            UseBBD = false;
+            BBDDirty = true;
+            PredNNZ = Ord_Compute(Q, N, Ap.data(), Ai.data(), Ordering);
+        }
+        if (UseIter) {
+            UseDense = false;
+            FullCount++;
+            Gather();
+            if (IterDirty) Krylov.Setup(N, Ap.data(), Ai.data(), Cx.data());
+            IterDirty = false;
+            Krylov.Precondition(Cx.data());
+            Analyzed = true;
+            return true;
         }
-        if (pivot < pivotTol) return false; // 主元绝对值小于容忍度，矩阵奇异，无法分解
-        int temp = P[j]; P[j] = P[k]; P[k] = temp; // 交换行记录
     }
-    // 根据行交换记录重排矩阵 A' 到 LU
-    for (int i = 0; i < N; i++)
-        for (int j = 0; j < N; j++)
-            LU[i * N + j] = A[P[i] * N + j];
-    // 对重排后的 A' 进行 LU 分解，存储结果在 LU 中
-    for (int j = 0; j < N; j++) {
-        for (int i = j + 1; i < N; i++)
-            LU[i * N + j] /= LU[j * N + j]; // 计算 L 的元素 L(i,j) = U(i,j) / U(j,j)
-        for (int i = j + 1; i < N; i++)
-            for (int k = j + 1; k < N; k++)
-                LU[i * N + k] -= LU[i * N + j] * LU[j * N + k]; // 更新 U 的元素 U(i,k) -= L(i,j) * U(j,k)
+    // 规模很小，或预测的填充超过稠密矩阵的 1/4 时，稠密 LU 更快
+    UseDense = IsReal && ((Solver == SOLVER_DENSE) ||
+        (Solver == SOLVER_AUTO && (N <= 32 || (N <= 5000 && PredNNZ * 4 > (long long)N * N))));
+    FullCount++;
+    if (UseDense) {
+        if (Dense.N != N) Dense.Resize(N);
+        Scatter(false);
+        Analyzed = Dense.Factorize(pivotTol);
     }
-    return true; // 分解成功
+    else {
+        Gather();
+        Analyzed = LU.Factorize(N, Ap.data(), Ai.data(), Cx.data(), Q.data(), pivotTol);
+    }
+    return Analyzed;
 }
 
-inline void Equation::Substitute() {
-    // 前向替换，求解 L * Y = B'
-    for (int i = 0; i < N; i++) {
-        Y[i] = B[P[i]]; // 初始化 Y(i) = B'(i)
-        for (int j = 0; j < i; j++)
-            Y[i] -= LU[i * N + j] * Y[j]; // 更新 Y(i) -= L(i,j) * Y(j)
+template<typename T>
+inline bool EquationT<T>::Refactorize(double pivotTol) {
+    if (!Analyzed || PatternDirty) return Analyze(pivotTol);
+    bool ok = false;
+    {
+        ScopedTimer timer(FactorTime); // 退回 Analyze 时由其自己计时
+        if constexpr (IsReal) {
+            if (UseIter) { // 只更新预条件子
+                Gather();
+                Krylov.Precondition(Cx.data());
+                RefactCount++;
+                return true;
+            }
+            if (UseBBD) { // 各块沿用主元顺序，失效的块和界面在内部重新选取主元
+                Gather();
+                ok = Tear.Factorize(Cx.data(), pivotTol, true, Dense.Pool);
+            }
+        }
+        if (UseDense) {
+            Scatter(true);
+            ok = Dense.Refactorize(pivotTol);
+        }
+        else if (!UseBBD) {
+            Gather();
+            ok = LU.Refactorize(Ap.data(), Ai.data(), Cx.data(), pivotTol);
+        }
     }
-    // 后向替换，求解 U * X = Y
-    for (int i = N - 1; i >= 0; i--) {
-        X[i] = Y[i]; // 初始化 X(i) = Y(i)
-        for (int j = N - 1; j > i; j--)
-            X[i] -= LU[i * N + j] * X[j]; // 更新 X(i) -= U(i,j) * X(j)
-        X[i] /= LU[i * N + i]; // 计算 X(i) /= U(i,i)
+    if (ok) {
+        RefactCount++;
+        return true;
     }
+    return Analyze(pivotTol); // 主元失效，重新选取主元
 }
 
-inline void Equation::SaveA(double* outA) {
-    std::memcpy(outA, A, sizeof(double) * N * N);
+template<typename T>
+inline int EquationT<T>::FullFactorCount() {
+    return FullCount;
+}
+template<typename T>
+inline int EquationT<T>::RefactorCount() {
+    return RefactCount;
 }
-inline void Equation::SaveB(double* outB) {
-    std::memcpy(outB, B, sizeof(double) * N);
+template<typename T>
+inline double EquationT<T>::FactorSeconds() {
+    return FactorTime;
 }
-inline void Equation::SaveX(double* outX) {
-    std::memcpy(outX, X, sizeof(double) * N);
+template<typename T>
+inline double EquationT<T>::SolveSeconds() {
+    return SolveTime;
+}
+
+template<typename T>
+inline void EquationT<T>::Clear() {
+    std::fill(Ax.begin(), Ax.end(), T(0));
+    std::fill(B.begin(), B.end(), T(0));
+}
+
+template<typename T>
+inline bool EquationT<T>::IterSolve(const T* b, T* x) {
+    if constexpr (IsReal) {
+        if (UseIter) {
+            Gather(); // 迭代总是使用当前矩阵（沿用的只有预条件子）
+            if (Krylov.Solve(Cx.data(), b, x)) return true;
+            // 不收敛：改用稀疏 LU，之后不再迭代
+            IterFallback++;
+            Solver = SOLVER_SPARSE;
+            PatternDirty = true;
+            double factor = FactorTime;
+            bool ok = Analyze(PivTol);
+            SolveTime -= FactorTime - factor; // 分解只计入 FactorTime（调用者的 SolveTime 计时包含了这段时间）
+            if (!ok) return false;
+        }
+        LU.Solve(b, x);
+    }
+    return true;
 }
-inline void Equation::LoadA(double* inA) {
-    std::memcpy(A, inA, sizeof(double) * N * N);
+
+template<typename T>
+inline bool EquationT<T>::Substitute() {
+    ScopedTimer timer(SolveTime);
+    if constexpr (IsReal) {
+        if (UseIter) return IterSolve(B.data(), X.data());
+        if (UseBBD) {
+            Tear.Solve(B.data(), X.data(), Dense.Pool);
+            return true;
+        }
+        if (UseDense) {
+            Dense.Solve(B.data(), X.data());
+            return true;
+        }
+    }
+    LU.Solve(B.data(), X.data());
+    return true;
 }
-inline void Equation::LoadB(double* inB) {
-    std::memcpy(B, inB, sizeof(double) * N);
+
+template<typename T>
+inline bool EquationT<T>::SubstituteBatch(int nrhs, const T* Bs, T* Xs) {
+    ScopedTimer timer(SolveTime);
+    if (UseIter) { // 迭代求解逐个右端项进行，以当前解为初值（中途改用 LU 时其余右端项直接替换）
+        for (int r = 0; r < nrhs; r++) {
+            T* x = Xs + (size_t)r * N;
+            std::copy(X.begin(), X.end(), x);
+            if (!IterSolve(Bs + (size_t)r * N, x)) return false;
+        }
+        return true;
+    }
+    if constexpr (IsReal) {
+        if (UseBBD) { // 撕裂求解逐个右端项进行（每次替换内部已在各块间并行）
+            for (int r = 0; r < nrhs; r++) Tear.Solve(Bs + (size_t)r * N, Xs + (size_t)r * N, Dense.Pool);
+            return true;
+        }
+    }
+    const int blk = 16; // 每次一起消去的右端项个数
+    for (int r0 = 0; r0 < nrhs; r0 += blk) {
+        int m = std::min(blk, nrhs - r0);
+        BatchB.resize((size_t)N * m);
+        BatchX.resize((size_t)N * m);
+        for (int r = 0; r < m; r++) { // 按列存储 -> 按行交织
+            const T* b = Bs + (size_t)(r0 + r) * N;
+            for (int i = 0; i < N; i++) BatchB[(size_t)i * m + r] = b[i];
+        }
+        bool done = false;
+        if constexpr (IsReal) {
+            if (UseDense) {
+                Dense.SolveBatch(m, BatchB.data(), BatchX.data());
+                done = true;
+            }
+        }
+        if (!done) LU.SolveBatch(m, BatchB.data(), BatchX.data());
+        for (int r = 0; r < m; r++) { // 按行交织 -> 按列存储
+            T* x = Xs + (size_t)(r0 + r) * N;
+            for (int i = 0; i < N; i++) x[i] = BatchX[(size_t)i * m + r];
+        }
+    }
+    return true;
 }
 
-Equation::~Equation() {
-    delete[] P;
-    delete[] A;
-    delete[] X;
-    delete[] B;
-    delete[] LU;
-    delete[] Y;
+template<typename T>
+inline void EquationT<T>::SaveA(T* outA) {
+    std::memcpy(outA, Ax.data() + 1, sizeof(T) * NNZ());
+}
+template<typename T>
+inline void EquationT<T>::SaveB(T* outB) {
+    std::memcpy(outB, B.data(), sizeof(T) * N);
 }
+template<typename T>
+inline void EquationT<T>::SaveX(T* outX) {
+    std::memcpy(outX, X.data(), sizeof(T) * N);
+}
+template<typename T>
+inline void EquationT<T>::LoadA(T* inA) {
+    std::memcpy(Ax.data() + 1, inA, sizeof(T) * NNZ());
+}
+template<typename T>
+inline void EquationT<T>::LoadB(T* inB) {
+    std::memcpy(B.data(), inB, sizeof(T) * N);
+}
+template<typename T>
+inline void EquationT<T>::LoadX(T* inX) {
+    std::memcpy(X.data(), inX, sizeof(T) * N);
+}
+
+// 实数方程组（MNA 的直流与瞬态分析）
+using Equation = EquationT<double>;
+// 复数方程组（交流小信号分析，只使用稀疏 LU）
+using ComplexEquation = EquationT<std::complex<double>>;
 
 } // namespace xespice
-#endif // !XE_EQUATION_H
\ No newline at end of file
+#endif // !XE_EQUATION_H
@@ -0,0 +1,433 @@
+#ifndef XE_KRYLOV_H
+#define XE_KRYLOV_H
+/*
+* 文件名称：xe_Krylov.h
+* 摘    要：预条件 Krylov 子空间迭代求解（CG、GMRES、BiCGSTAB，ILU(0)/IC(0) 预条件）
+* 作    者：H.J.Xie
+* 完成日期：2025年9月25日
+*/
+#include <cmath>
+#include <algorithm>
+#include "xe_StdType.h"
+namespace xespice
+{
+// Krylov 迭代方法
+enum KrylovMethod {
+    KRYLOV_AUTO = 0,    // 自动选择（对称且对角元为正时用 CG，否则用 GMRES）
+    KRYLOV_CG = 1,      // 共轭梯度法（只适用于对称正定矩阵，IC(0) 预条件）
+    KRYLOV_GMRES = 2,   // 重启 GMRES（ILU(0) 右预条件）
+    KRYLOV_BICGSTAB = 3 // BiCGSTAB（ILU(0) 右预条件）
+};
+
+// Krylov 迭代求解器：矩阵来自方程组的 CSC 数值，内部以对称置换后的 CSR 格式存放
+// 对角元为 0 的行（电压源、电感等的支路方程）置换到最后，使 ILU(0) 消去节点行后在其对角位置产生非零值
+// 预条件子与矩阵共用非零结构（另补齐对角位置），内存只与 A 的非零元个数成正比
+// 对称矩阵的 ILU(0) 即 LDL^T 形式的不完全 Cholesky 分解 IC(0)，CG 直接使用
+struct KrylovSolver {
+private:
+    static const int RESTART = 30; // GMRES 的重启长度
+    int N = 0;            // 方程组规模
+    int Method = KRYLOV_AUTO; // 指定的迭代方法（KrylovMethod）
+    int Active = KRYLOV_GMRES; // 本次预条件后实际使用的方法
+    Vect<int> Perm;       // 迭代次序 -> 方程序号
+    Vect<int> Rp;         // CSR 行指针（置换后）
+    Vect<int> Ri;         // CSR 列号（置换后，每行升序）
+    Vect<int> Re;         // CSR 各位置对应的 CSC 位置（-1 表示补齐的对角元）
+    Vect<int> Rt;         // CSR 各位置的转置位置（-1 表示结构不对称）
+    Vect<int> Diag;       // 各行对角元的位置
+    Vect<double> Rx;      // 矩阵数值（CSR）
+    Vect<double> Mx;      // ILU(0) 因子（单位下三角 L 与上三角 U 共用 Rx 的结构）
+    Vect<double> R, Z, P, Q, S, T, U, V0; // 迭代用的工作向量
+    Vect<double> Basis;   // GMRES 的 Krylov 基（(RESTART+1)*N）
+    Vect<double> PreZ;    // GMRES 的预条件后向量（RESTART*N）
+    Vect<double> Bp, Xp;  // 置换后的右端项和解
+    long long SolveCount = 0; // 求解次数
+    long long IterCount = 0;  // 累计迭代次数
+    int MaxIter = 0;          // 单次求解的最大迭代次数
+    double WorstResidual = 0; // 收敛时的最大相对残差
+    int ShiftCount = 0;       // 预条件时替换的零主元个数
+    // 由 CSC 数值收集 CSR 数值
+    void Load(const double* Cx);
+    // y = A x（置换后）
+    void Multiply(const double* x, double* y) const;
+    // z = M^{-1} r（先解单位下三角 L，再解上三角 U）
+    void Apply(const double* r, double* z) const;
+    // 各迭代方法，x 为初值并返回解，iters 返回迭代次数，res 返回相对残差
+    bool SolveCG(const double* b, double* x, double tol, int maxIter, int& iters, double& res);
+    bool SolveGMRES(const double* b, double* x, double tol, int maxIter, int& iters, double& res);
+    bool SolveBiCGSTAB(const double* b, double* x, double tol, int maxIter, int& iters, double& res);
+public:
+    double Tol = 1e-10;  // 收敛判据：相对残差 ||b-Ax||/||b||
+    int Limit = 1000;    // 单次求解的最大迭代次数
+    // 设置迭代方法（KrylovMethod）
+    void SetMethod(int method);
+    // 由 n 阶矩阵的 CSC 结构和数值建立置换与 CSR 结构（非零结构变化时调用）
+    void Setup(int n, const int* Ap, const int* Ai, const double* Cx);
+    // 由当前数值重新计算预条件子（结构与 Setup 时相同）
+    void Precondition(const double* Cx);
+    // 以当前数值（CSC）求解 Ax = b，x 为初值并返回解，未收敛时返回 false
+    bool Solve(const double* Cx, const double* b, double* x);
+    // 获取实际使用的方法名称和预条件子名称
+    const char* MethodName() const;
+    const char* PrecondName() const;
+    // 获取预条件子的非零元个数
+    long long PrecondNNZ() const;
+    // 获取求解次数、累计迭代次数、单次最大迭代次数、最大相对残差和替换的零主元个数
+    long long Solves() const;
+    long long Iterations() const;
+    int MaxIterations() const;
+    double MaxResidual() const;
+    int Shifts() const;
+};
+
+static inline double Krylov_Dot(const double* a, const double* b, int n) {
+    double s = 0;
+    for (int i = 0; i < n; i++) s += a[i] * b[i];
+    return s;
+}
+
+static inline double Krylov_Norm(const double* a, int n) {
+    return std::sqrt(Krylov_Dot(a, a, n));
+}
+
+inline void KrylovSolver::SetMethod(int method) {
+    Method = method;
+}
+
+inline void KrylovSolver::Setup(int n, const int* Ap, const int* Ai, const double* Cx) {
+    N = n;
+    // 对角元非零的行在前（保持原有次序），其余行在后
+    Vect<char> hasDiag(n, 0);
+    for (int j = 0; j < n; j++) {
+        for (int p = Ap[j]; p < Ap[j + 1]; p++) {
+            if (Ai[p] == j && Cx[p] != 0) hasDiag[j] = 1;
+        }
+    }
+    Perm.clear();
+    for (int i = 0; i < n; i++) if (hasDiag[i]) Perm.push_back(i);
+    for (int i = 0; i < n; i++) if (!hasDiag[i]) Perm.push_back(i);
+    Vect<int> pinv(n);
+    for (int k = 0; k < n; k++) pinv[Perm[k]] = k;
+    // CSC -> 置换后的 CSR（补齐对角元），每行按列号升序
+    Rp.assign(n + 1, 0);
+    Vect<char> diag(n, 0);
+    for (int j = 0; j < n; j++) {
+        for (int p = Ap[j]; p < Ap[j + 1]; p++) {
+            Rp[pinv[Ai[p]] + 1]++;
+            if (Ai[p] == j) diag[j] = 1;
+        }
+    }
+    for (int i = 0; i < n; i++) if (!diag[i]) Rp[pinv[i] + 1]++;
+    for (int i = 0; i < n; i++) Rp[i + 1] += Rp[i];
+    Vect<int> next(Rp.begin(), Rp.end() - 1);
+    Ri.resize(Rp[n]);
+    Re.resize(Rp[n]);
+    for (int k = 0; k < n; k++) { // 按置换后的列序扫描，各行的列号自然升序
+        int j = Perm[k];
+        if (!diag[j]) { // 补齐的对角元
+            Ri[next[k]] = k;
+            Re[next[k]++] = -1;
+        }
+        for (int p = Ap[j]; p < Ap[j + 1]; p++) {
+            int r = pinv[Ai[p]];
+            Ri[next[r]] = k;
+            Re[next[r]++] = p;
+        }
+    }
+    Diag.resize(n);
+    for (int i = 0; i < n; i++) {
+        Diag[i] = (int)(std::lower_bound(Ri.begin() + Rp[i], Ri.begin() + Rp[i + 1], i) - Ri.begin());
+    }
+    // 转置位置（用于对称性检查）
+    Rt.assign(Rp[n], -1);
+    for (int i = 0; i < n; i++) {
+        for (int p = Rp[i]; p < Rp[i + 1]; p++) {
+            int j = Ri[p];
+            auto it = std::lower_bound(Ri.begin() + Rp[j], Ri.begin() + Rp[j + 1], i);
+            if (it != Ri.begin() + Rp[j + 1] && *it == i) Rt[p] = (int)(it - Ri.begin());
+        }
+    }
+    Rx.assign(Rp[n], 0);
+    Mx.assign(Rp[n], 0);
+    for (Vect<double>* w : { &R, &Z, &P, &Q, &S, &T, &U, &V0, &Bp, &Xp }) w->assign(n, 0);
+}
+
+inline void KrylovSolver::Load(const double* Cx) {
+    for (size_t p = 0; p < Rx.size(); p++) Rx[p] = (Re[p] < 0) ? 0.0 : Cx[Re[p]];
+}
+
+inline void KrylovSolver::Precondition(const double* Cx) {
+    Load(Cx);
+    // 选择方法：对称且对角元为正时可用 CG
+    Active = Method;
+    if (Method == KRYLOV_AUTO || Method == KRYLOV_CG) {
+        bool spd = true;
+        for (int i = 0; i < N && spd; i++) {
+            if (Rx[Diag[i]] <= 0) spd = false;
+            for (int p = Rp[i]; p < Rp[i + 1] && spd; p++) {
+                int t = Rt[p];
+                double a = Rx[p];
+                if (t < 0) spd = (a == 0);
+                else spd = (std::abs(a - Rx[t]) <= 1e-12 * (std::abs(a) + std::abs(Rx[t])));
+            }
+        }
+        Active = spd ? KRYLOV_CG : KRYLOV_GMRES; // 不对称时 CG 不适用，改用 GMRES
+    }
+    // ILU(0)：按行消去（IKJ 次序），只保留原有非零位置
+    // 第 i 行减去 U 的第 k 行时只更新两行共有的列：U 的第 k 行较短时扫描它（用 pos 定位），
+    // 较长时（如连接大量节点的电源线）改为在其中二分查找第 i 行剩余的各列，避免枢纽行造成 O(度数^2) 的代价
+    Mx = Rx;
+    ShiftCount = 0;
+    Vect<int> pos(N, -1);
+    for (int i = 0; i < N; i++) {
+        double rowMax = 0;
+        for (int p = Rp[i]; p < Rp[i + 1]; p++) {
+            pos[Ri[p]] = p;
+            rowMax = std::max(rowMax, std::abs(Mx[p]));
+        }
+        for (int p = Rp[i]; p < Diag[i]; p++) {
+            int k = Ri[p];
+            double l = Mx[p] / Mx[Diag[k]];
+            Mx[p] = l;
+            if (l == 0) continue;
+            int uBegin = Diag[k] + 1, uEnd = Rp[k + 1];
+            if (uEnd - uBegin <= 8 * (Rp[i + 1] - p)) {
+                for (int q = uBegin; q < uEnd; q++) {
+                    int t = pos[Ri[q]];
+                    if (t >= 0) Mx[t] -= l * Mx[q];
+                }
+            }
+            else {
+                for (int t = p + 1; t < Rp[i + 1]; t++) { // 第 i 行在 k 之后的列
+                    auto it = std::lower_bound(Ri.begin() + uBegin, Ri.begin() + uEnd, Ri[t]);
+                    if (it != Ri.begin() + uEnd && *it == Ri[t]) Mx[t] -= l * Mx[it - Ri.begin()];
+                }
+            }
+        }
+        double& d = Mx[Diag[i]];
+        if (std::abs(d) <= 1e-14 * rowMax || (Active == KRYLOV_CG && d <= 0)) { // 零主元（或 IC(0) 失效）：以小的对角值代替
+            if (Active == KRYLOV_CG) Active = KRYLOV_GMRES;
+            d = (rowMax > 0) ? 1e-8 * rowMax : 1.0;
+            ShiftCount++;
+        }
+        for (int p = Rp[i]; p < Rp[i + 1]; p++) pos[Ri[p]] = -1;
+    }
+}
+
+inline void KrylovSolver::Multiply(const double* x, double* y) const {
+    for (int i = 0; i < N; i++) {
+        double s = 0;
+        for (int p = Rp[i]; p < Rp[i + 1]; p++) s += Rx[p] * x[Ri[p]];
+        y[i] = s;
+    }
+}
+
+inline void KrylovSolver::Apply(const double* r, double* z) const {
+    for (int i = 0; i < N; i++) { // L y = r
+        double s = r[i];
+        for (int p = Rp[i]; p < Diag[i]; p++) s -= Mx[p] * z[Ri[p]];
+        z[i] = s;
+    }
+    for (int i = N - 1; i >= 0; i--) { // U z = y
+        double s = z[i];
+        for (int p = Diag[i] + 1; p < Rp[i + 1]; p++) s -= Mx[p] * z[Ri[p]];
+        z[i] = s / Mx[Diag[i]];
+    }
+}
+
+inline bool KrylovSolver::SolveCG(const double* b, double* x, double tol, int maxIter, int& iters, double& res) {
+    double bn = Krylov_Norm(b, N);
+    Multiply(x, R.data());
+    for (int i = 0; i < N; i++) R[i] = b[i] - R[i];
+    Apply(R.data(), Z.data());
+    P = Z;
+    double rz = Krylov_Dot(R.data(), Z.data(), N);
+    res = Krylov_Norm(R.data(), N) / bn;
+    for (iters = 0; iters < maxIter && res > tol; iters++) {
+        Multiply(P.data(), Q.data());
+        double pq = Krylov_Dot(P.data(), Q.data(), N);
+        if (pq <= 0) return false; // 矩阵不正定
+        double alpha = rz / pq;
+        for (int i = 0; i < N; i++) {
+            x[i] += alpha * P[i];
+            R[i] -= alpha * Q[i];
+        }
+        res = Krylov_Norm(R.data(), N) / bn;
+        Apply(R.data(), Z.data());
+        double rz1 = Krylov_Dot(R.data(), Z.data(), N);
+        double beta = rz1 / rz;
+        rz = rz1;
+        for (int i = 0; i < N; i++) P[i] = Z[i] + beta * P[i];
+    }
+    return res <= tol;
+}
+
+inline bool KrylovSolver::SolveGMRES(const double* b, double* x, double tol, int maxIter, int& iters, double& res) {
+    const int m = RESTART;
+    double bn = Krylov_Norm(b, N);
+    Basis.resize((size_t)(m + 1) * N);
+    PreZ.resize((size_t)m * N);
+    Vect<double> H((size_t)(m + 1) * m), cs(m), sn(m), g(m + 1), y(m);
+    iters = 0;
+    while (true) {
+        // 重启：r = b - A x
+        double* v = Basis.data();
+        Multiply(x, v);
+        for (int i = 0; i < N; i++) v[i] = b[i] - v[i];
+        double beta = Krylov_Norm(v, N);
+        res = beta / bn;
+        if (res <= tol) return true;
+        if (iters >= maxIter) return false;
+        for (int i = 0; i < N; i++) v[i] /= beta;
+        std::fill(g.begin(), g.end(), 0.0);
+        g[0] = beta;
+        int k = 0;
+        for (; k < m && iters < maxIter; k++, iters++) {
+            // 右预条件的 Arnoldi 过程：w = A M^{-1} v_k，对已有基做修正 Gram-Schmidt 正交化
+            double* z = PreZ.data() + (size_t)k * N;
+            double* w = Basis.data() + (size_t)(k + 1) * N;
+            Apply(Basis.data() + (size_t)k * N, z);
+            Multiply(z, w);
+            for (int j = 0; j <= k; j++) {
+                const double* vj = Basis.data() + (size_t)j * N;
+                double h = Krylov_Dot(w, vj, N);
+                H[(size_t)j * m + k] = h;
+                for (int i = 0; i < N; i++) w[i] -= h * vj[i];
+            }
+            double hn = Krylov_Norm(w, N);
+            H[(size_t)(k + 1) * m + k] = hn;
+            if (hn > 0) for (int i = 0; i < N; i++) w[i] /= hn;
+            // 以 Givens 旋转将 H 化为上三角，g 的末项即为残差范数
+            for (int j = 0; j < k; j++) {
+                double a = H[(size_t)j * m + k], c = H[(size_t)(j + 1) * m + k];
+                H[(size_t)j * m + k] = cs[j] * a + sn[j] * c;
+                H[(size_t)(j + 1) * m + k] = -sn[j] * a + cs[j] * c;
+            }
+            double a = H[(size_t)k * m + k], c = H[(size_t)(k + 1) * m + k];
+            double r = std::hypot(a, c);
+            cs[k] = (r == 0) ? 1 : a / r;
+            sn[k] = (r == 0) ? 0 : c / r;
+            H[(size_t)k * m + k] = r;
+            H[(size_t)(k + 1) * m + k] = 0;
+            g[k + 1] = -sn[k] * g[k];
+            g[k] = cs[k] * g[k];
+            if (std::abs(g[k + 1]) <= tol * bn || hn == 0) {
+                k++;
+                iters++;
+                break;
+            }
+        }
+        // 回代求 y，x += M^{-1} V y
+        for (int j = k - 1; j >= 0; j--) {
+            double s = g[j];
+            for (int t = j + 1; t < k; t++) s -= H[(size_t)j * m + t] * y[t];
+            y[j] = (H[(size_t)j * m + j] == 0) ? 0 : s / H[(size_t)j * m + j];
+        }
+        for (int j = 0; j < k; j++) {
+            const double* z = PreZ.data() + (size_t)j * N;
+            for (int i = 0; i < N; i++) x[i] += y[j] * z[i];
+        }
+        if (k == 0) return false;
+    }
+}
+
+inline bool KrylovSolver::SolveBiCGSTAB(const double* b, double* x, double tol, int maxIter, int& iters, double& res) {
+    double bn = Krylov_Norm(b, N);
+    Multiply(x, R.data());
+    for (int i = 0; i < N; i++) R[i] = b[i] - R[i];
+    V0 = R; // 影子残差
+    std::fill(P.begin(), P.end(), 0.0);
+    std::fill(Q.begin(), Q.end(), 0.0); // Q = A M^{-1} p
+    double rho = 1, alpha = 1, omega = 1;
+    res = Krylov_Norm(R.data(), N) / bn;
+    for (iters = 0; iters < maxIter && res > tol; iters++) {
+        double rho1 = Krylov_Dot(V0.data(), R.data(), N);
+        if (rho1 == 0 || omega == 0) return false; // 方法失效
+        double beta = (rho1 / rho) * (alpha / omega);
+        rho = rho1;
+        for (int i = 0; i < N; i++) P[i] = R[i] + beta * (P[i] - omega * Q[i]);
+        Apply(P.data(), Z.data()); // Z = M^{-1} p
+        Multiply(Z.data(), Q.data());
+        double vq = Krylov_Dot(V0.data(), Q.data(), N);
+        if (vq == 0) return false;
+        alpha = rho / vq;
+        for (int i = 0; i < N; i++) {
+            S[i] = R[i] - alpha * Q[i];
+            x[i] += alpha * Z[i];
+        }
+        res = Krylov_Norm(S.data(), N) / bn;
+        if (res <= tol) {
+            R = S;
+            iters++;
+            break;
+        }
+        Apply(S.data(), U.data()); // U = M^{-1} s
+        Multiply(U.data(), T.data());
+        double tt = Krylov_Dot(T.data(), T.data(), N);
+        omega = (tt == 0) ? 0 : Krylov_Dot(T.data(), S.data(), N) / tt;
+        for (int i = 0; i < N; i++) {
+            x[i] += omega * U[i];
+            R[i] = S[i] - omega * T[i];
+        }
+        res = Krylov_Norm(R.data(), N) / bn;
+    }
+    return res <= tol;
+}
+
+inline bool KrylovSolver::Solve(const double* Cx, const double* b, double* x) {
+    Load(Cx); // 预条件子可以是旧的，矩阵总是用当前数值
+    for (int k = 0; k < N; k++) {
+        Bp[k] = b[Perm[k]];
+        Xp[k] = x[Perm[k]];
+    }
+    SolveCount++;
+    bool ok = true;
+    int iters = 0;
+    double res = 0;
+    if (Krylov_Norm(Bp.data(), N) == 0) std::fill(Xp.begin(), Xp.end(), 0.0);
+    else if (Active == KRYLOV_CG) ok = SolveCG(Bp.data(), Xp.data(), Tol, Limit, iters, res);
+    else if (Active == KRYLOV_BICGSTAB) ok = SolveBiCGSTAB(Bp.data(), Xp.data(), Tol, Limit, iters, res);
+    else ok = SolveGMRES(Bp.data(), Xp.data(), Tol, Limit, iters, res);
+    IterCount += iters;
+    MaxIter = std::max(MaxIter, iters);
+    if (!ok) return false;
+    WorstResidual = std::max(WorstResidual, res);
+    for (int k = 0; k < N; k++) x[Perm[k]] = Xp[k];
+    return true;
+}
+
+inline const char* KrylovSolver::MethodName() const {
+    const char* names[] = { "auto", "cg", "gmres", "bicgstab" };
+    return names[Active];
+}
+
+inline const char* KrylovSolver::PrecondName() const {
+    return (Active == KRYLOV_CG) ? "ic0" : "ilu0";
+}
+
+inline long long KrylovSolver::PrecondNNZ() const {
+    return (long long)Mx.size();
+}
+
+inline long long KrylovSolver::Solves() const {
+    return SolveCount;
+}
+
+inline long long KrylovSolver::Iterations() const {
+    return IterCount;
+}
+
+inline int KrylovSolver::MaxIterations() const {
+    return MaxIter;
+}
+
+inline double KrylovSolver::MaxResidual() const {
+    return WorstResidual;
+}
+
+inline int KrylovSolver::Shifts() const {
+    return ShiftCount;
+}
+
+} // namespace xespice
+#endif // !XE_KRYLOV_H
@@ -0,0 +1,131 @@
+#ifndef XE_LOWRANK_H
+#define XE_LOWRANK_H
+/*
+* 文件名称：xe_LowRank.h
+* 摘    要：已分解矩阵的低秩修正求解（Sherman-Morrison-Woodbury 公式）
+* 作    者：H.J.Xie
+* 完成日期：2025年9月24日
+*/
+#include <cmath>
+#include <algorithm>
+#include "xe_StdType.h"
+#include "xe_Equation.h"
+namespace xespice
+{
+// 低秩修正类：基准矩阵 A0 已分解，当前矩阵 A = A0 + dA，dA 只涉及少数几行
+// 记 R 为 dA 涉及的行，dA = E_R * M（E_R 为这些行的单位列向量，M 为 dA 的这几行），则
+//   A^{-1} b = y - Z (I + M Z)^{-1} M y，其中 y = A0^{-1} b，Z = A0^{-1} E_R
+// Z 只依赖基准分解，每一列在其行首次出现时求一次；秩（行数）增大到替换求解不再划算时应重新分解
+struct LowRankUpdate {
+private:
+    int N = 0; // 方程组规模
+    Vect<int> Rows; // dA 涉及的行（依次出现的顺序）
+    Vect<int> RowPos; // 行号 -> 在 Rows 中的位置（-1 表示不涉及）
+    Vect<int> Ei, Ej; // dA 各项的行号和列号（同一位置可出现多次，求和即为 dA）
+    Vect<double> Ex; // dA 各项的数值
+    Vect<double> Z; // A0^{-1} E_R（按列存放，第 c 列位于 [c*N, (c+1)*N)）
+    int ZCols = 0; // Z 中已求出的列数
+    Vect<double> K; // 容量矩阵 I + M Z（r*r，按行存放）
+public:
+    // 以 n 阶方程的当前分解为基准，清空修正
+    void Reset(int n);
+    // 累加一项修正 dA(i,j) += v（i、j 为负数表示接地，忽略）
+    void Add(int i, int j, double v);
+    // 获取修正涉及的行数（dA 的秩的上界）
+    int Rank() const;
+    // 估计求解一次的乘加次数（solveCost 为用基准分解替换求解一次的代价）
+    long long Cost(long long solveCost) const;
+    // 用基准分解 equ 求解 (A0 + dA) x = b，容量矩阵奇异或基准替换失败时返回 false
+    bool Solve(Equation* equ, const double* b, double* x);
+};
+
+inline void LowRankUpdate::Reset(int n) {
+    N = n;
+    Rows.clear();
+    RowPos.assign(n, -1);
+    Ei.clear();
+    Ej.clear();
+    Ex.clear();
+    Z.clear();
+    ZCols = 0;
+}
+
+inline void LowRankUpdate::Add(int i, int j, double v) {
+    if (i < 0 || j < 0 || v == 0) return;
+    if (RowPos[i] < 0) {
+        RowPos[i] = (int)Rows.size();
+        Rows.push_back(i);
+    }
+    Ei.push_back(i);
+    Ej.push_back(j);
+    Ex.push_back(v);
+}
+
+inline int LowRankUpdate::Rank() const {
+    return (int)Rows.size();
+}
+
+inline long long LowRankUpdate::Cost(long long solveCost) const {
+    long long r = (long long)Rows.size();
+    // 新增的 Z 列、y 的替换求解、M Z 与 M y、容量矩阵的分解、x = y - Z w
+    return (r - ZCols + 1) * solveCost + (long long)Ex.size() * r + r * r * r / 3 + r * N;
+}
+
+inline bool LowRankUpdate::Solve(Equation* equ, const double* b, double* x) {
+    int r = (int)Rows.size();
+    // 补齐 Z 的新列：A0 z = e_i
+    if (ZCols < r) {
+        Vect<double> E((size_t)(r - ZCols) * N, 0.0);
+        for (int c = ZCols; c < r; c++) E[(size_t)(c - ZCols) * N + Rows[c]] = 1;
+        Z.resize((size_t)r * N);
+        if (!equ->SubstituteBatch(r - ZCols, E.data(), Z.data() + (size_t)ZCols * N)) return false;
+        ZCols = r;
+    }
+    if (!equ->SubstituteBatch(1, b, x)) return false; // x = y = A0^{-1} b
+    if (r == 0) return true;
+    // K = I + M Z，w = M y
+    K.assign((size_t)r * r, 0.0);
+    Vect<double> w(r, 0.0);
+    for (int c = 0; c < r; c++) K[(size_t)c * r + c] = 1;
+    for (size_t e = 0; e < Ex.size(); e++) {
+        int p = RowPos[Ei[e]], j = Ej[e];
+        double v = Ex[e];
+        double* k = K.data() + (size_t)p * r;
+        for (int c = 0; c < r; c++) k[c] += v * Z[(size_t)c * N + j];
+        w[p] += v * x[j];
+    }
+    // 列选主元高斯消去求解 K w = M y
+    for (int c = 0; c < r; c++) {
+        int piv = c;
+        for (int i = c + 1; i < r; i++) {
+            if (std::abs(K[(size_t)i * r + c]) > std::abs(K[(size_t)piv * r + c])) piv = i;
+        }
+        if (K[(size_t)piv * r + c] == 0) return false;
+        if (piv != c) {
+            std::swap_ranges(K.begin() + (size_t)c * r, K.begin() + (size_t)(c + 1) * r, K.begin() + (size_t)piv * r);
+            std::swap(w[c], w[piv]);
+        }
+        const double* kc = K.data() + (size_t)c * r;
+        for (int i = c + 1; i < r; i++) {
+            double* ki = K.data() + (size_t)i * r;
+            double f = ki[c] / kc[c];
+            if (f == 0) continue;
+            for (int t = c; t < r; t++) ki[t] -= f * kc[t];
+            w[i] -= f * w[c];
+        }
+    }
+    for (int c = r - 1; c >= 0; c--) {
+        const double* kc = K.data() + (size_t)c * r;
+        for (int t = c + 1; t < r; t++) w[c] -= kc[t] * w[t];
+        w[c] /= kc[c];
+    }
+    // x = y - Z w
+    for (int c = 0; c < r; c++) {
+        const double* z = Z.data() + (size_t)c * N;
+        for (int i = 0; i < N; i++) x[i] -= z[i] * w[c];
+    }
+    return true;
+}
+
+} // namespace xespice
+#endif // !XE_LOWRANK_H
@@ -0,0 +1,133 @@
+#ifndef XE_MAPPEDFILE_H
+#define XE_MAPPEDFILE_H
+/*
+* 文件名称：xe_MappedFile.h
+* 摘    要：以写时复制方式映射到内存的只读文件
+* 作    者：H.J.Xie
+* 完成日期：2025年9月16日
+*/
+#include <cstddef>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include "xe_StdType.h"
+namespace xespice
+{
+// 内存映射文件类：文件内容映射为一段可写的私有内存（写时复制，修改不会写回文件）
+// 解析器可直接在映射上原地改写（如转小写），只有被改写的页才会复制
+struct MappedFile {
+private:
+    char* Data = nullptr; // 映射首地址（空文件为 nullptr）
+    size_t Length = 0;    // 文件长度
+#ifdef _WIN32
+    HANDLE Mapping = nullptr; // 文件映射对象
+#endif
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    // 映射文件，返回 true 表示成功
+    bool Open(const String& filepath);
+    // 解除映射
+    void Close();
+    // 获取映射首地址
+    char* Begin() { return Data; }
+    // 获取映射末尾（最后一个字符之后）
+    char* End() { return Data + Length; }
+    // 获取文件长度
+    size_t Size() { return Length; }
+    // 析构函数，解除映射
+    ~MappedFile() { Close(); }
+};
+
+inline bool MappedFile::Open(const String& filepath) {
+    Close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return false;
+    }
+    Length = (size_t)size.QuadPart;
+    if (Length > 0) {
+        Mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        if (Mapping != nullptr) Data = (char*)MapViewOfFile(Mapping, FILE_MAP_COPY, 0, 0, 0);
+    }
+    CloseHandle(file);
+    if (Length > 0 && Data == nullptr) {
+        Close();
+        return false;
+    }
+#else
+    int fd = open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    Length = (size_t)st.st_size;
+    if (Length > 0) {
+        void* p = mmap(nullptr, Length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            Data = (char*)p;
+            madvise(p, Length, MADV_SEQUENTIAL);
+        }
+    }
+    close(fd);
+    if (Length > 0 && Data == nullptr) {
+        Length = 0;
+        return false;
+    }
+#endif
+    return true;
+}
+
+inline void MappedFile::Close() {
+#ifdef _WIN32
+    if (Data) UnmapViewOfFile(Data);
+    if (Mapping) CloseHandle(Mapping);
+    Mapping = nullptr;
+#else
+    if (Data) munmap(Data, Length);
+#endif
+    Data = nullptr;
+    Length = 0;
+}
+
+// 获取文件的大小和修改时间（用于判断缓存的文件内容是否仍然有效），返回 true 表示成功
+static inline bool File_Stamp(const String& filepath, long long& size, long long& mtime) {
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA info;
+    if (!GetFileAttributesExA(filepath.c_str(), GetFileExInfoStandard, &info)) return false;
+    size = ((long long)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+    mtime = ((long long)info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime;
+#else
+    struct stat st;
+    if (stat(filepath.c_str(), &st) != 0) return false;
+    size = (long long)st.st_size;
+#if defined(__linux__)
+    mtime = (long long)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec; // 纳秒精度
+#else
+    mtime = (long long)st.st_mtime;
+#endif
+#endif
+    return true;
+}
+
+} // namespace xespice
+#endif // !XE_MAPPEDFILE_H
@@ -0,0 +1,358 @@
+#ifndef XE_ORDERING_H
+#define XE_ORDERING_H
+/*
+* 文件名称：xe_Ordering.h
+* 摘    要：稀疏矩阵的填充缩减排序（商图上的近似最小度算法 AMD/COLAMD）及填充预测
+* 作    者：H.J.Xie
+* 完成日期：2025年9月3日
+*/
+#include <cmath>
+#include <algorithm>
+#include "xe_StdType.h"
+namespace xespice
+{
+// 排序方法
+enum OrderType {
+    ORDER_NATURAL = 0, // 自然顺序（未知数的编号顺序）
+    ORDER_AMD = 1,     // 在 A+A' 的图上做近似最小度排序（适合结构对称的 MNA 矩阵）
+    ORDER_COLAMD = 2   // 以 A 的各行为初始元素做列近似最小度排序（相当于 A'A 的图，但不显式建立，适合结构不对称的矩阵）
+};
+
+// 由 CSC 矩阵建立 A+A' 的无向图（CSR 格式的邻接表，不含自环，邻接点升序）
+static inline void Ord_Graph(Vect<int>& xadj, Vect<int>& adj, int n, const int* Ap, const int* Ai) {
+    xadj.assign(n + 1, 0);
+    for (int j = 0; j < n; j++) {
+        for (int p = Ap[j]; p < Ap[j + 1]; p++) {
+            int i = Ai[p];
+            if (i == j) continue;
+            xadj[i + 1]++;
+            xadj[j + 1]++;
+        }
+    }
+    for (int i = 0; i < n; i++) xadj[i + 1] += xadj[i];
+    Vect<int> next(xadj.begin(), xadj.end() - 1);
+    adj.resize(xadj[n]);
+    for (int j = 0; j < n; j++) {
+        for (int p = Ap[j]; p < Ap[j + 1]; p++) {
+            int i = Ai[p];
+            if (i == j) continue;
+            adj[next[i]++] = j;
+            adj[next[j]++] = i;
+        }
+    }
+    // 排序去重（(i,j) 与 (j,i) 同时存在时各出现两次）
+    int q = 0;
+    for (int i = 0; i < n; i++) {
+        int begin = xadj[i], end = xadj[i + 1];
+        std::sort(adj.begin() + begin, adj.begin() + end);
+        xadj[i] = q;
+        for (int p = begin; p < end; p++) {
+            if (p > begin && adj[p] == adj[p - 1]) continue;
+            adj[q++] = adj[p];
+        }
+    }
+    xadj[n] = q;
+    adj.resize(q);
+}
+
+// 稠密行/列的阈值：非零元超过 max(16, 10*sqrt(n)) 的行或列不参与最小度排序
+static inline int Ord_DenseLimit(int n) {
+    return std::max(16, (int)(10 * std::sqrt((double)n)));
+}
+
+// 商图上的近似最小度排序（Amestoy、Davis、Duff 的 AMD 算法）
+// 共 n 个变量（0~n-1）和若干初始元素（n 以后的编号，COLAMD 中为 A 的各行）
+//   adj[i]   变量 i 的相邻变量，或初始元素的变量表
+//   elem[i]  变量 i 所属的初始元素
+//   degree   各变量的初始（近似）外部度数
+//   dense    不参与排序、最后消去的变量（其他变量的表中不应含有它们）
+// 消去的变量成为元素（其变量表为消去时的邻接变量），相邻的元素被吸收，不显式形成消去图的团，
+// 内存与 A 的非零元个数成正比；度数取近似外部度数的上界；邻接结构相同的变量合并为超变量一起消去；
+// 只与新元素相邻的变量随主元一起消去（质量消去）。结果存于 perm（perm[k] 为第 k 个消去的变量）
+static inline void Ord_QuotientMinDegree(Vect<int>& perm, int n, Vect<Vect<int>>& adj, Vect<Vect<int>>& elem,
+    Vect<int>& degree, const Vect<char>& dense) {
+    enum { VAR = 0, ELEMENT = 1, DEAD = 2 }; // 变量、元素、已吸收的元素或已合并/消去的非主变量
+    int total = (int)adj.size();
+    Vect<char> kind(total, VAR);
+    Vect<int> nv(total, 0);      // 超变量的规模（非主变量为 0）
+    Vect<int> esize(total, 0);   // 元素的变量总规模（按超变量规模加权）
+    Vect<int> w(total, 0);       // |Le \ Lp|
+    Vect<int> wmark(total, -1);  // w 的有效标记
+    Vect<int> mark(total, -1);   // 是否在当前主元的变量表 Lp 中
+    Vect<int> head(n + 1, -1), next(n, -1), prev(n, -1); // 按度数分桶的双向链表
+    Vect<int> chainNext(n, -1), chainTail(n); // 超变量的成员链
+    Vect<int> hhead(n, -1), hnext(n, -1), hval(n, 0); // 超变量检测的散列桶
+    perm.clear();
+    perm.reserve(n);
+    int live = 0;
+    for (int e = n; e < total; e++) {
+        kind[e] = ELEMENT;
+        esize[e] = (int)adj[e].size();
+    }
+    auto insert = [&](int i, int d) {
+        next[i] = head[d];
+        prev[i] = -1;
+        if (head[d] >= 0) prev[head[d]] = i;
+        head[d] = i;
+    };
+    auto remove = [&](int i) {
+        if (prev[i] >= 0) next[prev[i]] = next[i];
+        else head[degree[i]] = next[i];
+        if (next[i] >= 0) prev[next[i]] = prev[i];
+    };
+    auto output = [&](int i) {
+        for (int v = i; v >= 0; v = chainNext[v]) perm.push_back(v);
+    };
+    int mindeg = n;
+    for (int i = 0; i < n; i++) {
+        chainTail[i] = i;
+        if (dense[i]) {
+            kind[i] = DEAD;
+            continue;
+        }
+        nv[i] = 1;
+        live++;
+        degree[i] = std::min(std::max(degree[i], 0), n - 1);
+        insert(i, degree[i]);
+        mindeg = std::min(mindeg, degree[i]);
+    }
+    Vect<int> Lp;
+    int nel = 0, tag = 0;
+    while (nel < live) {
+        // 选取度数最小的主变量 p
+        while (head[mindeg] < 0) mindeg++;
+        int p = head[mindeg];
+        remove(p);
+        int nvp = nv[p];
+        output(p);
+        // 新元素 p 的变量表 Lp = (A_p ∪ 各相邻元素的变量表) \ {p}，相邻元素被吸收
+        tag++;
+        mark[p] = tag;
+        Lp.clear();
+        for (int j : adj[p]) {
+            if (kind[j] == VAR && nv[j] > 0 && mark[j] != tag) {
+                mark[j] = tag;
+                Lp.push_back(j);
+            }
+        }
+        for (int e : elem[p]) {
+            if (kind[e] != ELEMENT) continue;
+            for (int j : adj[e]) {
+                if (kind[j] == VAR && nv[j] > 0 && mark[j] != tag) {
+                    mark[j] = tag;
+                    Lp.push_back(j);
+                }
+            }
+            kind[e] = DEAD;
+            Vect<int>().swap(adj[e]);
+        }
+        Vect<int>().swap(elem[p]);
+        kind[p] = ELEMENT;
+        nel += nvp;
+        int degme = 0;
+        for (int i : Lp) {
+            remove(i);
+            degme += nv[i];
+        }
+        // 各相邻元素在 Lp 之外的规模 |Le \ Lp|
+        for (int i : Lp) {
+            for (int e : elem[i]) {
+                if (kind[e] != ELEMENT) continue;
+                if (wmark[e] != tag) {
+                    wmark[e] = tag;
+                    w[e] = esize[e];
+                }
+                w[e] -= nv[i];
+            }
+        }
+        // 近似外部度数：去掉已吸收的元素（含被 Lp 覆盖的元素）和 Lp 中的变量
+        int keep = 0;
+        for (int i : Lp) {
+            int deg = 0;
+            unsigned long long hash = (unsigned long long)p;
+            Vect<int>& E = elem[i];
+            int k2 = 0;
+            for (int e : E) {
+                if (kind[e] != ELEMENT) continue;
+                if (w[e] == 0) { // Le 包含于 Lp：吸收到 p
+                    kind[e] = DEAD;
+                    Vect<int>().swap(adj[e]);
+                    continue;
+                }
+                deg += w[e];
+                hash += (unsigned long long)e;
+                E[k2++] = e;
+            }
+            E.resize(k2);
+            E.push_back(p);
+            Vect<int>& A = adj[i];
+            k2 = 0;
+            for (int j : A) {
+                if (kind[j] != VAR || nv[j] == 0 || mark[j] == tag) continue;
+                deg += nv[j];
+                hash += (unsigned long long)j;
+                A[k2++] = j;
+            }
+            A.resize(k2);
+            if (E.size() == 1 && A.empty()) { // 只与 p 相邻：与 p 一起消去
+                output(i);
+                nel += nv[i];
+                degme -= nv[i];
+                nv[i] = 0;
+                kind[i] = DEAD;
+                Vect<int>().swap(E);
+                continue;
+            }
+            degree[i] = std::min(degree[i], deg); // 之后再加上 |Lp \ i|
+            hval[i] = (int)(hash % (unsigned long long)n);
+            Lp[keep++] = i;
+        }
+        Lp.resize(keep);
+        // 超变量检测：散列值相同的变量比较元素表和变量表，相同时合并
+        for (int i : Lp) {
+            hnext[i] = hhead[hval[i]];
+            hhead[hval[i]] = i;
+        }
+        for (int i : Lp) {
+            int h = hval[i];
+            if (hhead[h] < 0) continue;
+            for (int a = hhead[h]; a >= 0; a = hnext[a]) {
+                if (nv[a] == 0 || hnext[a] < 0) continue;
+                tag++; // 借用 mark 标记 a 的表
+                for (int e : elem[a]) mark[e] = tag;
+                for (int j : adj[a]) mark[j] = tag;
+                for (int b = hnext[a]; b >= 0; b = hnext[b]) {
+                    if (nv[b] == 0 || elem[b].size() != elem[a].size() || adj[b].size() != adj[a].size()) continue;
+                    bool same = true;
+                    for (int e : elem[b]) if (mark[e] != tag) { same = false; break; }
+                    for (int j : adj[b]) if (same && mark[j] != tag) { same = false; break; }
+                    if (!same) continue;
+                    nv[a] += nv[b]; // b 并入 a
+                    nv[b] = 0;
+                    kind[b] = DEAD;
+                    chainNext[chainTail[a]] = b;
+                    chainTail[a] = chainTail[b];
+                    Vect<int>().swap(elem[b]);
+                    Vect<int>().swap(adj[b]);
+                }
+            }
+            hhead[h] = -1;
+        }
+        // 更新度数并放回桶中，新元素的变量表只保留主变量
+        keep = 0;
+        int remaining = live - nel;
+        for (int i : Lp) {
+            if (nv[i] == 0) continue;
+            int d = std::min(degree[i] + degme - nv[i], remaining - nv[i]);
+            degree[i] = std::max(d, 0);
+            insert(i, degree[i]);
+            mindeg = std::min(mindeg, degree[i]);
+            Lp[keep++] = i;
+        }
+        Lp.resize(keep);
+        esize[p] = 0;
+        for (int i : Lp) esize[p] += nv[i];
+        if (Lp.empty()) kind[p] = DEAD; // 没有剩余的邻接变量：消去树的根
+        adj[p].assign(Lp.begin(), Lp.end());
+        nv[p] = 0;
+    }
+    for (int i = 0; i < n; i++) if (dense[i]) perm.push_back(i); // 稠密变量最后消去
+}
+
+// AMD：在 A+A' 的图上做近似最小度排序，度数超过阈值的稠密节点（如电源线、接地网）最后消去
+static inline void Ord_AMD(Vect<int>& perm, int n, const Vect<int>& xadj, const Vect<int>& adjc) {
+    int limit = Ord_DenseLimit(n);
+    Vect<char> dense(n, 0);
+    for (int i = 0; i < n; i++) if (xadj[i + 1] - xadj[i] > limit) dense[i] = 1;
+    Vect<Vect<int>> adj(n), elem(n);
+    Vect<int> degree(n, 0);
+    for (int i = 0; i < n; i++) {
+        if (dense[i]) continue;
+        for (int p = xadj[i]; p < xadj[i + 1]; p++) if (!dense[adjc[p]]) adj[i].push_back(adjc[p]);
+        degree[i] = (int)adj[i].size();
+    }
+    Ord_QuotientMinDegree(perm, n, adj, elem, degree, dense);
+}
+
+// COLAMD：A 的各行作为初始元素（行中各列构成团），做列的近似最小度排序，不建立 A'A
+// 非零元过多的稠密行不作为元素（否则其各列在 A'A 中两两相连），稠密列最后消去
+static inline void Ord_COLAMD(Vect<int>& perm, int n, const int* Ap, const int* Ai) {
+    int limit = Ord_DenseLimit(n);
+    Vect<char> dense(n, 0);
+    Vect<int> rowCount(n, 0);
+    for (int j = 0; j < n; j++) {
+        if (Ap[j + 1] - Ap[j] > limit) dense[j] = 1;
+        else for (int p = Ap[j]; p < Ap[j + 1]; p++) rowCount[Ai[p]]++;
+    }
+    Vect<int> rowId(n, -1); // 行号 -> 元素编号（稠密行和空行为 -1）
+    int m = 0;
+    for (int i = 0; i < n; i++) if (rowCount[i] > 0 && rowCount[i] <= limit) rowId[i] = n + m++;
+    Vect<Vect<int>> adj(n + m), elem(n);
+    for (int j = 0; j < n; j++) {
+        if (dense[j]) continue;
+        for (int p = Ap[j]; p < Ap[j + 1]; p++) {
+            int e = rowId[Ai[p]];
+            if (e < 0) continue;
+            elem[j].push_back(e);
+            adj[e].push_back(j);
+        }
+    }
+    // 初始度数取各行其他列数之和（A'A 中邻接点个数的上界）
+    Vect<int> degree(n, 0);
+    for (int j = 0; j < n; j++) {
+        long long d = 0;
+        for (int e : elem[j]) d += (long long)adj[e].size() - 1;
+        degree[j] = (int)std::min<long long>(d, n - 1);
+    }
+    Ord_QuotientMinDegree(perm, n, adj, elem, degree, dense);
+}
+
+// 在给定排序下对 A+A' 的图做符号 Cholesky 分析，返回预测的 L+U 非零元个数（含对角元）
+// 即按对角主元消去时 LU 的非零元个数；利用消去树计算 L 的各行非零元个数，计算量与 L 的非零元个数成正比
+static inline long long Ord_PredictNNZ(const Vect<int>& xadj, const Vect<int>& adj, const Vect<int>& perm) {
+    int n = (int)perm.size();
+    Vect<int> pinv(n), parent(n, -1), ancestor(n, -1), mark(n, -1);
+    for (int k = 0; k < n; k++) pinv[perm[k]] = k;
+    // 建立消去树
+    for (int k = 0; k < n; k++) {
+        int v0 = perm[k];
+        for (int q = xadj[v0]; q < xadj[v0 + 1]; q++) {
+            for (int i = pinv[adj[q]]; i != -1 && i < k; ) {
+                int inext = ancestor[i];
+                ancestor[i] = k; // 路径压缩
+                if (inext == -1) parent[i] = k;
+                i = inext;
+            }
+        }
+    }
+    // 第 k 行的非零结构为其各非零元在消去树中到 k 的路径之并
+    long long lnz = 0;
+    for (int k = 0; k < n; k++) {
+        mark[k] = k;
+        int v0 = perm[k];
+        for (int q = xadj[v0]; q < xadj[v0 + 1]; q++) {
+            for (int i = pinv[adj[q]]; i < k && mark[i] != k; i = parent[i]) {
+                mark[i] = k;
+                lnz++;
+            }
+        }
+    }
+    return 2 * lnz + n;
+}
+
+// 计算 CSC 矩阵的列排序，结果存于 perm，返回预测的 L+U 非零元个数
+// 预测总是在 A+A' 的图上按对角主元估计（各排序方法可比，也供稠密/稀疏求解器的选择使用）
+static inline long long Ord_Compute(Vect<int>& perm, int n, const int* Ap, const int* Ai, int type) {
+    Vect<int> xadj, adj;
+    Ord_Graph(xadj, adj, n, Ap, Ai);
+    if (type == ORDER_AMD) Ord_AMD(perm, n, xadj, adj);
+    else if (type == ORDER_COLAMD) Ord_COLAMD(perm, n, Ap, Ai);
+    else {
+        perm.resize(n);
+        for (int k = 0; k < n; k++) perm[k] = k;
+    }
+    return Ord_PredictNNZ(xadj, adj, perm);
+}
+
+} // namespace xespice
+#endif // !XE_ORDERING_H
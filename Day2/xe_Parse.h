@@ -9,6 +9,36 @@
 #include "xe_StdType.h"
 namespace xespice 
 {
+// 字符类别（读取网表时使用）
+enum CharClass {
+    CH_OTHER = 0,   // 普通字符
+    CH_BLANK = 1,   // 空白符（普通模式和表达式中都是空白）
+    CH_SEP = 2,     // 分隔符 ,=()[]（只在普通模式中视为空白）
+    CH_NEWLINE = 3, // 换行符
+    CH_LBRACE = 4,  // 左大括号
+    CH_RBRACE = 5   // 右大括号
+};
+// 字符分类表和小写转换表
+struct CharTable {
+    unsigned char Class[256]; // 字符类别（CharClass）
+    char Lower[256];          // 转为小写后的字符
+    CharTable() {
+        for (int c = 0; c < 256; c++) {
+            Class[c] = CH_OTHER;
+            Lower[c] = (char)((c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c);
+        }
+        for (unsigned char c : String(" \t\f\v\r")) Class[c] = CH_BLANK;
+        for (unsigned char c : String(",=()[]")) Class[c] = CH_SEP;
+        Class[(unsigned char)'\n'] = CH_NEWLINE;
+        Class[(unsigned char)'{'] = CH_LBRACE;
+        Class[(unsigned char)'}'] = CH_RBRACE;
+    }
+};
+// 获取字符表（只构造一次）
+static inline const CharTable& Str_CharTable() {
+    static const CharTable table;
+    return table;
+}
 // 将字符串按空格分解
 static inline void Str_Split(Vect<String>& res, const String& s) {
     String token = "";
@@ -17,90 +47,74 @@ static inline void Str_Split(Vect<String>& res, const String& s) {
             if (token.size() > 0) res.push_back(token);
             token = "";
         }
-        else token += std::tolower(ch);
+        else token += Str_CharTable().Lower[(unsigned char)ch];
     }
 }
-// 将字符串字母转小写
+// 将字符串字母转小写（只转换 ASCII 字母，与区域设置无关，可在多个线程中同时调用）
 static inline String Str_ToLower(const String& s) {
-    String res = "";
-    for (char ch : s) res += std::tolower(ch);
+    const CharTable& table = Str_CharTable();
+    String res = s;
+    for (char& ch : res) ch = table.Lower[(unsigned char)ch];
     return res;
 }
-// 将字符串转为数值（返回 NaN 表示错误）
-static inline double Str_ToValue(const String& s) {
-    String state = "";
-    String numstr = "";
-    bool isSci = false; // 是否为科学计数法
-    // 分割数字和数量级单位
-    for (char ch : s) {
-        if (std::isdigit(ch) || ch == '+' || ch == '-' || ch == '.') {
-            if (state == "") numstr += ch;
-            else if (state == "e" && !isSci) {
-                isSci = true;
-                state = "";
-                numstr += 'e';
-                numstr += ch;
-            }
-            else break;
-        }
-        else if (std::isalpha(ch)) {
-            char c = std::tolower(ch); // 转小写
-            if (state == "") {
-                if (c == 't') { state = "t"; break; }
-                else if (c == 'g') { state = "g"; break; }
-                else if (c == 'k') { state = "k"; break; }
-                else if (c == 'u') { state = "u"; break; }
-                else if (c == 'n') { state = "n"; break; }
-                else if (c == 'p') { state = "p"; break; }
-                else if (c == 'f') { state = "f"; break; }
-                else if (c == 'e') { state = "e"; }
-                else if (c == 'm') { state = "m"; }
-                else break;
-            }
-            else if (state == "m") {
-                if (c == 'e') { state = "me"; }
-                else if (c == 'i') { state = "mi"; }
-                else break;
-            }
-            else if (state == "me") {
-                if (c == 'g') { state = "M"; break; }
-                else break;
-            }
-            else if (state == "mi") {
-                if (c == 'l') { state = "l"; break; }
-                else break;
-            }
-            else break;
-        }
-        else break;
+// 数值解析的结果
+enum ValueStatus {
+    VAL_OK = 0,      // 成功
+    VAL_INVALID = 1, // 不是合法数值
+    VAL_RANGE = 2    // 超出 double 的表示范围
+};
+// 是否为数字部分的字符
+static inline bool Str_IsNumChar(char ch) {
+    return (ch >= '0' && ch <= '9') || ch == '+' || ch == '-' || ch == '.';
+}
+// 识别数字之后的数量级单位（t g meg k m mil u n p f，不区分大小写），其余字母视为单位名称忽略
+static inline double Str_ScaleOf(const char* p, const char* end) {
+    auto at = [&](int k) { return (p + k < end) ? (char)(p[k] | 0x20) : '\0'; };
+    switch (at(0)) {
+    case 't': return 1e12;
+    case 'g': return 1e9;
+    case 'k': return 1e3;
+    case 'u': return 1e-6;
+    case 'n': return 1e-9;
+    case 'p': return 1e-12;
+    case 'f': return 1e-15;
+    case 'm':
+        if (at(1) == 'e' && at(2) == 'g') return 1e6;
+        if (at(1) == 'i' && at(2) == 'l') return 25.4e-6;
+        return 1e-3;
+    default: return 1;
     }
-    // 识别数量级单位
-    double scale = 1;
-    if (state.size() > 0) {
-        switch (state[0]) {
-        case 't': scale = 1e12; break;
-        case 'g': scale = 1e9; break;
-        case 'M': scale = 1e6; break;
-        case 'k': scale = 1e3; break;
-        case 'm': scale = 1e-3; break;
-        case 'l': scale = 25.4e-6; break;
-        case 'u': scale = 1e-6; break;
-        case 'n': scale = 1e-9; break;
-        case 'p': scale = 1e-12; break;
-        case 'f': scale = 1e-15; break;
-        default: break;
+}
+// 将字符串解析为数值，结果存入 value，返回 ValueStatus（不分配内存，不抛出异常）
+static inline int Str_ParseValue(StrView s, double& value) {
+    const char* p = s.data();
+    const char* end = p + s.size();
+    // 数字部分：由 0-9 + - . 组成，其后可带一个 e 指数
+    const char* q = p;
+    while (q < end && Str_IsNumChar(*q)) q++;
+    double scale;
+    if (q < end && (*q | 0x20) == 'e') {
+        if (q + 1 < end && Str_IsNumChar(q[1])) {
+            for (q++; q < end && Str_IsNumChar(*q); q++);
+            // 指数之后再出现 e 时不识别数量级单位
+            scale = (q < end && (*q | 0x20) == 'e') ? 1 : Str_ScaleOf(q, end);
         }
+        else scale = 1; // 不构成指数的 e 视为单位名称
     }
-    // 识别数字
+    else scale = Str_ScaleOf(q, end);
+    // 识别数字（from_chars 不接受前导 '+'，与 strtod 一致地跳过一个）
+    if (p < q && *p == '+' && !(p + 1 < q && (p[1] == '+' || p[1] == '-'))) p++;
     double number;
-    try {
-        number = std::stod(numstr) * scale;
-    }
-    catch (...) {
-        number = std::nan("");
-    }
-    return number;
+    std::from_chars_result r = std::from_chars(p, q, number);
+    if (r.ec == std::errc::invalid_argument) return VAL_INVALID;
+    if (r.ec == std::errc::result_out_of_range) return VAL_RANGE;
+    value = number * scale;
+    return VAL_OK;
+}
+// 将字符串转为数值（返回 NaN 表示错误）
+static inline double Str_ToValue(StrView s) {
+    double value;
+    return (Str_ParseValue(s, value) == VAL_OK) ? value : std::nan("");
 }
-
 }
 #endif // !XE_PARSE_H
\ No newline at end of file
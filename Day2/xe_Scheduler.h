@@ -0,0 +1,240 @@
+#ifndef XE_SCHEDULER_H
+#define XE_SCHEDULER_H
+/*
+* 文件名称：xe_Scheduler.h
+* 摘    要：作业调度器：在工作窃取的线程池上并行运行大量相互独立的网表，同时运行的作业受内存预算限制
+* 作    者：H.J.Xie
+* 完成日期：2025年9月26日
+*/
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include "xe_Batch.h"
+namespace xespice
+{
+// 作业完成的回调（作业编号、一行 JSON 报告、是否成功），各次调用互斥，可直接写同一个输出流
+using JobCallback = std::function<void(int id, const String& report, bool ok)>;
+
+// 作业调度器：n 个工作线程各有一个作业队列和一个工作区，每个电路在一个线程上单线程运行（电路之间并行）
+// 提交的作业轮流放入各队列；线程先从自己队列的头部取作业，队列为空时从其他队列的尾部窃取，
+// 运行时间相差很大的作业也能均衡到各线程
+// 内存预算：作业的内存用量按网表文件大小估计，正在运行的作业的估计值之和不超过预算，
+// 估计值超过整个预算的作业等其他作业都结束后单独运行
+struct JobScheduler {
+private:
+    // 排队的作业
+    struct Task {
+        int Id = 0;
+        BatchJob Job;
+    };
+    // 一个工作线程的作业队列
+    struct WorkQueue {
+        std::mutex Mtx;
+        std::deque<Task> Tasks;
+    };
+    Vect<std::thread> Workers; // 工作线程
+    Vect<std::unique_ptr<WorkQueue>> Queues; // 各工作线程的作业队列
+    Vect<std::unique_ptr<Workspace>> Spaces; // 各工作线程的工作区
+    std::mutex Mtx; // 保护以下计数
+    std::condition_variable CvWork; // 有新作业或要求停止
+    std::condition_variable CvIdle; // 有作业结束（释放内存预算或全部完成）
+    std::mutex DoneMtx; // 回调互斥
+    JobCallback OnDone; // 作业完成的回调
+    std::atomic<int> Queued{0}; // 排队中的作业数
+    std::atomic<long long> Steals{0}; // 窃取的次数
+    int Unfinished = 0; // 已提交但未完成的作业数
+    int NextId = 0; // 下一个作业的编号
+    size_t NextQueue = 0; // 下一个作业放入的队列
+    size_t Budget = 0; // 内存预算（字节，0 表示不限制）
+    size_t InUse = 0; // 正在运行的作业的估计内存之和
+    int Stats = 0; // 各作业至少按该级别写运行统计
+    bool Stop = false; // 是否停止
+    // 取一个作业（先取自己队列的头部，再从其他队列的尾部窃取），没有时返回 false
+    bool TakeTask(int w, Task& task);
+    // 估计作业的内存用量
+    size_t Estimate(const BatchJob& job) const;
+    // 等待内存预算足够后占用 bytes 字节（返回实际占用的字节数）
+    size_t Acquire(size_t bytes);
+    // 归还占用的内存预算
+    void Release(size_t bytes);
+    // 工作线程主循环
+    void Loop(int w);
+public:
+    double BytesPerInputByte = 64; // 每字节网表估计的内存用量（元件对象、矩阵与 LU 分解）
+    size_t MinJobBytes = (size_t)1 << 20; // 每个作业估计内存用量的下限
+    // 构造函数，threads 为工作线程数（<=0 表示全部硬件线程），memoryBudget 为内存预算（字节，0 表示不限制）
+    JobScheduler(int threads, size_t memoryBudget = 0, int stats = 0, JobCallback onDone = nullptr);
+    JobScheduler(const JobScheduler&) = delete;
+    JobScheduler& operator=(const JobScheduler&) = delete;
+    // 获取工作线程数
+    int Size() const;
+    // 提交一个作业，返回作业编号（从 1 开始，按提交顺序）
+    int Submit(const BatchJob& job);
+    // 等待已提交的作业全部完成
+    void Wait();
+    // 获取窃取作业的次数
+    long long StealCount() const;
+    // 析构函数，等待全部作业完成后结束工作线程
+    ~JobScheduler();
+};
+
+inline JobScheduler::JobScheduler(int threads, size_t memoryBudget, int stats, JobCallback onDone)
+    : OnDone(onDone), Budget(memoryBudget), Stats(stats) {
+    if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0) threads = 1;
+    for (int w = 0; w < threads; w++) {
+        Queues.emplace_back(new WorkQueue());
+        Spaces.emplace_back(new Workspace());
+        if (Budget) { // 缓存的内存块和库文件也计入预算
+            Spaces.back()->Blocks.Limit = Budget / (4 * (size_t)threads);
+            Spaces.back()->SourceLimit = Budget / (4 * (size_t)threads);
+        }
+    }
+    for (int w = 0; w < threads; w++) Workers.emplace_back(&JobScheduler::Loop, this, w);
+}
+
+inline int JobScheduler::Size() const {
+    return (int)Workers.size();
+}
+
+inline int JobScheduler::Submit(const BatchJob& job) {
+    Task task;
+    task.Job = job;
+    size_t q;
+    {
+        std::lock_guard<std::mutex> lock(Mtx);
+        task.Id = ++NextId;
+        q = NextQueue++ % Queues.size();
+        Unfinished++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(Queues[q]->Mtx);
+        Queues[q]->Tasks.push_back(task);
+    }
+    {
+        std::lock_guard<std::mutex> lock(Mtx);
+        Queued++;
+    }
+    CvWork.notify_one();
+    return task.Id;
+}
+
+inline void JobScheduler::Wait() {
+    std::unique_lock<std::mutex> lock(Mtx);
+    CvIdle.wait(lock, [&] { return Unfinished == 0; });
+}
+
+inline long long JobScheduler::StealCount() const {
+    return Steals.load();
+}
+
+inline bool JobScheduler::TakeTask(int w, Task& task) {
+    int n = (int)Queues.size();
+    for (int k = 0; k < n; k++) {
+        WorkQueue& q = *Queues[(w + k) % n];
+        std::lock_guard<std::mutex> lock(q.Mtx);
+        if (q.Tasks.empty()) continue;
+        if (k == 0) { // 自己的队列：取头部（提交顺序）
+            task = std::move(q.Tasks.front());
+            q.Tasks.pop_front();
+        }
+        else { // 其他队列：取尾部（与队列的主人在两端，较少争用）
+            task = std::move(q.Tasks.back());
+            q.Tasks.pop_back();
+            Steals++;
+        }
+        Queued--;
+        return true;
+    }
+    return false;
+}
+
+inline size_t JobScheduler::Estimate(const BatchJob& job) const {
+    long long size = 0, mtime = 0;
+    if (!File_Stamp(job.Input, size, mtime)) size = 0;
+    return std::max(MinJobBytes, (size_t)(size * BytesPerInputByte));
+}
+
+inline size_t JobScheduler::Acquire(size_t bytes) {
+    std::unique_lock<std::mutex> lock(Mtx);
+    if (Budget) {
+        bytes = std::min(bytes, Budget); // 超出整个预算的作业在没有其他作业运行时单独运行
+        CvIdle.wait(lock, [&] { return InUse + bytes <= Budget; });
+    }
+    InUse += bytes;
+    return bytes;
+}
+
+inline void JobScheduler::Release(size_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(Mtx);
+        InUse -= bytes;
+    }
+    CvIdle.notify_all();
+}
+
+inline void JobScheduler::Loop(int w) {
+    while (true) {
+        Task task;
+        if (!TakeTask(w, task)) {
+            std::unique_lock<std::mutex> lock(Mtx);
+            CvWork.wait(lock, [&] { return Stop || Queued > 0; });
+            if (Stop && Queued == 0) return;
+            continue;
+        }
+        size_t bytes = Acquire(Estimate(task.Job));
+        bool ok = false;
+        String report = Batch_RunJob(*Spaces[w], task.Job, task.Id, Stats, ok, 1); // 电路之间并行，电路内部单线程
+        Release(bytes);
+        if (OnDone) {
+            std::lock_guard<std::mutex> lock(DoneMtx);
+            OnDone(task.Id, report, ok);
+        }
+        {
+            std::lock_guard<std::mutex> lock(Mtx);
+            Unfinished--;
+        }
+        CvIdle.notify_all();
+    }
+}
+
+inline JobScheduler::~JobScheduler() {
+    Wait();
+    {
+        std::lock_guard<std::mutex> lock(Mtx);
+        Stop = true;
+    }
+    CvWork.notify_all();
+    for (std::thread& t : Workers) t.join();
+}
+
+// 用调度器并行运行输入流中的作业（每行一个），每个作业完成时写一行报告到 out（按完成顺序），
+// 最后写一行汇总，返回失败的作业个数
+static inline int Sched_RunStream(std::istream& in, std::ostream& out, int stats, int threads, size_t memoryBudget) {
+    double t0 = Timer_Now();
+    int failed = 0;
+    JobCallback done = [&](int id, const String& report, bool ok) {
+        out << report << std::endl;
+        if (!ok) failed++;
+    };
+    JobScheduler sched(threads, memoryBudget, stats, done);
+    String line;
+    BatchJob job;
+    int count = 0;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!Batch_ParseJob(line, job)) continue;
+        sched.Submit(job);
+        count++;
+    }
+    sched.Wait();
+    out << "{\"jobs\": " << count << ", \"failed\": " << failed << ", \"total\": " << Json_Number(Timer_Now() - t0);
+    out << ", \"threads\": " << sched.Size() << ", \"steals\": " << sched.StealCount() << "}" << std::endl;
+    return failed;
+}
+
+} // namespace xespice
+#endif // !XE_SCHEDULER_H
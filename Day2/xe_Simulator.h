@@ -6,6 +6,8 @@
 * 作    者：H.J.Xie
 * 完成日期：2025年8月29日
 */
+#include <memory>
+#include <exception>
 #include "xe_Circuit.h"
 #include "element/xe_ElmResistor.h"
 #include "element/xe_ElmVoltageSource.h"
@@ -14,29 +16,79 @@
 #include "element/xe_ElmVCCS.h"
 #include "element/xe_ElmCCVS.h"
 #include "element/xe_ElmCCCS.h"
+#include "element/xe_ElmCapacitor.h"
+#include "element/xe_ElmInductor.h"
+#include "element/xe_ElmDiode.h"
+#include "element/xe_ElmMOSFET.h"
 namespace xespice 
 {
 
 // 元器件构造函数
-static inline Element* NewElement(char ch) {
+static inline Element* NewElement(char ch, Arena& arena) {
     switch (ch) {
-    case 'r': return new ElmResistor();
-    case 'v': return new ElmVoltageSource();
-    case 'i': return new ElmCurrentSource();
-    case 'e': return new ElmVCVS();
-    case 'g': return new ElmVCCS();
-    case 'h': return new ElmCCVS();
-    case 'f': return new ElmCCCS();
+    case 'v': return arena.New<ElmVoltageSource>();
+    case 'i': return arena.New<ElmCurrentSource>();
+    case 'c': return arena.New<ElmCapacitor>();
+    case 'l': return arena.New<ElmInductor>();
+    case 'd': return arena.New<ElmDiode>();
+    case 'm': return arena.New<ElmMOSFET>();
+    default: return nullptr;
+    }
+}
+
+// 元件组构造函数（固定线性元件按类型成组存放）
+static inline ElementGroup* NewGroup(char ch, Arena& arena) {
+    switch (ch) {
+    case 'r': return arena.New<GrpResistor>();
+    case 'e': return arena.New<GrpVCVS>();
+    case 'g': return arena.New<GrpVCCS>();
+    case 'h': return arena.New<GrpCCVS>();
+    case 'f': return arena.New<GrpCCCS>();
     default: return nullptr;
     }
 }
 
 // 供外部调用
-static inline Circuit* NewCircuit() {
-    Circuit* cir = new Circuit();
+static inline Circuit* NewCircuit(Workspace* ws = nullptr) {
+    Circuit* cir = new Circuit(ws);
     cir->SetElementCtor(NewElement);
+    cir->SetGroupCtor(NewGroup);
     return cir; 
 }
 
+// 一次仿真的结果
+struct SimResult {
+    bool Ok = false;   // 是否成功
+    String Error = ""; // 错误信息（ERRxxx--...）
+    PhaseTimes Timing; // 各阶段的耗时
+};
+
+// 可重入的仿真入口：在调用线程上读取网表 input，仿真并写出 output，电路用完即释放
+// 电路的全部状态（错误信息、输出文件、内存池、方程）都在电路对象内，元件构造函数和字符表是无状态的，
+// 因此不同线程可以同时调用，只要各自使用不同的工作区 ws（或为 nullptr）和不同的输出文件
+// threads > 0 时覆盖网表中的 THREADS（多个电路并行时通常为 1），stats 为命令行要求的最低 STATS 级别
+// 异常（如内存不足）只使本次仿真失败
+static inline SimResult Simulate(const String& input, const String& output, Workspace* ws = nullptr,
+    int threads = 0, int stats = 0) {
+    SimResult res;
+    try {
+        std::unique_ptr<Circuit> cir(NewCircuit(ws));
+        cir->ReadFile(input);
+        if (threads > 0) cir->Config.THREADS = threads;
+        cir->Config.STATS = std::max(cir->Config.STATS, stats);
+        cir->SetOutputPath(output);
+        cir->Run();
+        res.Timing = cir->Timing;
+        res.Ok = !cir->ErrorFlag;
+        res.Error = cir->ErrorMsg;
+    }
+    catch (const std::exception& e) {
+        res.Ok = false;
+        res.Error = String("ERR034--Job Aborted: ") + e.what();
+    }
+    if (ws) ws->EndJob();
+    return res;
+}
+
 }
 #endif // !XE_SIMULATOR_H
\ No newline at end of file
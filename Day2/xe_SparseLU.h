@@ -0,0 +1,268 @@
+#ifndef XE_SPARSELU_H
+#define XE_SPARSELU_H
+/*
+* 文件名称：xe_SparseLU.h
+* 摘    要：稀疏矩阵的 LU 分解（Gilbert-Peierls 左视算法，列选主元）
+* 作    者：H.J.Xie
+* 完成日期：2025年9月2日
+*/
+#include <algorithm>
+#include "xe_StdType.h"
+namespace xespice
+{
+// 稀疏 LU 分解类，输入为 CSC（压缩列）格式的矩阵，分解得到 P*A*Q = L*U
+// L 为单位下三角矩阵（每列首元素为对角元 1），U 为上三角矩阵（每列末元素为对角元）
+// 内存和计算量只与非零元及填充元的个数有关
+template<typename T>
+struct SparseLU {
+    int N = 0;      // 矩阵规模
+    Vect<int> Lp;   // L 的列指针（N+1）
+    Vect<int> Li;   // L 的行号（分解完成后为主元序号）
+    Vect<T> Lx;     // L 的数值
+    Vect<int> Up;   // U 的列指针（N+1）
+    Vect<int> Ui;   // U 的行号（主元序号）
+    Vect<T> Ux;     // U 的数值
+    Vect<int> Pinv; // 行置换：原始行号 -> 主元序号
+    Vect<int> Q;    // 列顺序：第 k 步消去的原始列号
+    // 进行数值分解（n 为规模，Ap/Ai/Ax 为 CSC 矩阵，q 为列顺序，可为 nullptr 表示自然顺序）
+    // pivotTol 为最小主元容忍度，返回 true 表示分解成功
+    bool Factorize(int n, const int* Ap, const int* Ai, const T* Ax, const int* q, double pivotTol);
+    // 沿用上一次分解的行置换、列顺序和 L/U 非零结构，只重新进行数值消去
+    // （要求矩阵非零结构不变；若主元绝对值小于 pivotTol 或相对其所在列过小，返回 false）
+    bool Refactorize(const int* Ap, const int* Ai, const T* Ax, double pivotTol);
+    // 利用分解结果求解 Ax = b（b 为输入常数向量，x 为输出解向量）
+    void Solve(const T* b, T* x);
+    // 同时求解 m 个右端项（b 和 x 按行交织存储：第 i 行第 r 个右端项位于 [i*m+r]）
+    void SolveBatch(int m, const T* b, T* x);
+    // L 和 U 的非零元总数（U 的对角元计入，L 的单位对角元不计入）
+    int FactorNNZ() const { return (int)(Li.size() + Ui.size()) - N; }
+    // 一次数值重分解的乘加次数（由 L 和 U 的非零结构估计）
+    long long FactorFlops() const;
+    // 主元统计：主元绝对值的最小值和最大值，以及主元不在原对角位置的列数
+    void PivotStats(double& minPivot, double& maxPivot, int& offDiagonal) const;
+private:
+    Vect<T> Work;    // 稠密工作向量（N）
+    Vect<T> WorkBatch; // 多右端项求解的工作矩阵（N*m）
+    Vect<int> Xi;    // 可达集合及深度优先搜索栈（2N）
+    Vect<char> Mark; // 深度优先搜索的访问标记（N）
+    // 从第 j 行出发在 L 的图中进行深度优先搜索，返回新的栈顶
+    int DFS(int j, int top);
+    // 计算 A 的第 col 列在 L 的图中的可达集合（按拓扑序存于 Xi[top..N)），返回 top
+    int Reach(const int* Ap, const int* Ai, int col);
+};
+
+template<typename T>
+inline int SparseLU<T>::DFS(int j, int top) {
+    int* xi = Xi.data();
+    int* pstack = Xi.data() + N;
+    int head = 0;
+    xi[0] = j;
+    while (head >= 0) {
+        j = xi[head];
+        int jnew = Pinv[j]; // 该行若已成为主元，则对应 L 的第 jnew 列
+        if (!Mark[j]) {
+            Mark[j] = 1;
+            pstack[head] = (jnew < 0) ? 0 : Lp[jnew];
+        }
+        bool done = true;
+        int p2 = (jnew < 0) ? 0 : Lp[jnew + 1];
+        for (int p = pstack[head]; p < p2; p++) {
+            int i = Li[p];
+            if (Mark[i]) continue;
+            pstack[head] = p; // 记录搜索位置，返回时从此继续
+            xi[++head] = i;
+            done = false;
+            break;
+        }
+        if (done) { // 所有子节点均已访问，出栈
+            head--;
+            xi[--top] = j;
+        }
+    }
+    return top;
+}
+
+template<typename T>
+inline int SparseLU<T>::Reach(const int* Ap, const int* Ai, int col) {
+    int top = N;
+    for (int p = Ap[col]; p < Ap[col + 1]; p++) {
+        if (!Mark[Ai[p]]) top = DFS(Ai[p], top);
+    }
+    for (int p = top; p < N; p++) Mark[Xi[p]] = 0; // 清除标记
+    return top;
+}
+
+template<typename T>
+inline bool SparseLU<T>::Factorize(int n, const int* Ap, const int* Ai, const T* Ax, const int* q, double pivotTol) {
+    N = n;
+    Lp.assign(1, 0); Li.clear(); Lx.clear();
+    Up.assign(1, 0); Ui.clear(); Ux.clear();
+    Pinv.assign(n, -1);
+    Q.resize(n);
+    for (int k = 0; k < n; k++) Q[k] = q ? q[k] : k;
+    Work.assign(n, T(0));
+    Xi.assign(2 * n, 0);
+    Mark.assign(n, 0);
+    T* x = Work.data();
+    for (int k = 0; k < n; k++) {
+        int col = Q[k];
+        // 求解稀疏下三角方程组 L*x = A(:,col)
+        int top = Reach(Ap, Ai, col);
+        for (int p = top; p < n; p++) x[Xi[p]] = T(0);
+        for (int p = Ap[col]; p < Ap[col + 1]; p++) x[Ai[p]] += Ax[p];
+        for (int px = top; px < n; px++) {
+            int j = Xi[px];
+            int J = Pinv[j];
+            if (J < 0) continue; // 该行尚未成为主元
+            for (int p = Lp[J] + 1; p < Lp[J + 1]; p++)
+                x[Li[p]] -= Lx[p] * x[j]; // 更新 x(i) -= L(i,J) * x(j)
+        }
+        // 选取列主元，并将已消去的部分存入 U
+        int ipiv = -1;
+        double amax = -1;
+        for (int p = top; p < n; p++) {
+            int i = Xi[p];
+            if (Pinv[i] < 0) {
+                double a = std::abs(x[i]);
+                if (a > amax) { amax = a; ipiv = i; }
+            }
+            else {
+                Ui.push_back(Pinv[i]);
+                Ux.push_back(x[i]);
+            }
+        }
+        if (ipiv < 0 || amax < pivotTol) return false; // 主元过小，矩阵奇异
+        // 对角元足够大时优先选取对角元，以保持原有结构
+        if (Pinv[col] < 0 && std::abs(x[col]) >= 1e-3 * amax) ipiv = col;
+        T pivot = x[ipiv];
+        Ui.push_back(k);
+        Ux.push_back(pivot);
+        Pinv[ipiv] = k;
+        // 存储 L 的第 k 列
+        Li.push_back(ipiv);
+        Lx.push_back(T(1));
+        for (int p = top; p < n; p++) {
+            int i = Xi[p];
+            if (Pinv[i] < 0) {
+                Li.push_back(i);
+                Lx.push_back(x[i] / pivot);
+            }
+            x[i] = T(0);
+        }
+        Lp.push_back((int)Li.size());
+        Up.push_back((int)Ui.size());
+    }
+    for (int& i : Li) i = Pinv[i]; // 将 L 的行号转为主元序号
+    return true;
+}
+
+template<typename T>
+inline bool SparseLU<T>::Refactorize(const int* Ap, const int* Ai, const T* Ax, double pivotTol) {
+    if ((int)Lp.size() != N + 1) return false; // 尚未进行过完整分解
+    std::fill(Work.begin(), Work.end(), T(0));
+    T* x = Work.data(); // 按主元序号索引的工作向量
+    for (int k = 0; k < N; k++) {
+        int col = Q[k];
+        for (int p = Ap[col]; p < Ap[col + 1]; p++) x[Pinv[Ai[p]]] += Ax[p];
+        // U 的第 k 列按拓扑序存储，依次消去
+        int uend = Up[k + 1] - 1;
+        for (int p = Up[k]; p < uend; p++) {
+            int j = Ui[p];
+            T xj = x[j];
+            Ux[p] = xj;
+            x[j] = T(0);
+            for (int q = Lp[j] + 1; q < Lp[j + 1]; q++) x[Li[q]] -= Lx[q] * xj;
+        }
+        T pivot = x[k];
+        x[k] = T(0);
+        double apiv = std::abs(pivot);
+        double amax = apiv;
+        for (int q = Lp[k] + 1; q < Lp[k + 1]; q++) {
+            double a = std::abs(x[Li[q]]);
+            if (a > amax) amax = a;
+        }
+        if (apiv < pivotTol || apiv < 1e-3 * amax) { // 原主元不再可用
+            for (int q = Lp[k] + 1; q < Lp[k + 1]; q++) x[Li[q]] = T(0);
+            return false;
+        }
+        Ux[uend] = pivot;
+        for (int q = Lp[k] + 1; q < Lp[k + 1]; q++) {
+            Lx[q] = x[Li[q]] / pivot;
+            x[Li[q]] = T(0);
+        }
+    }
+    return true;
+}
+
+template<typename T>
+inline void SparseLU<T>::PivotStats(double& minPivot, double& maxPivot, int& offDiagonal) const {
+    minPivot = HUGE_VAL;
+    maxPivot = 0;
+    offDiagonal = 0;
+    int done = (int)Up.size() - 1; // 已完成分解的列数（分解中途失败时少于 N）
+    for (int k = 0; k < done; k++) {
+        double a = std::abs(Ux[Up[k + 1] - 1]); // U 每列末元素为对角元
+        minPivot = std::min(minPivot, a);
+        maxPivot = std::max(maxPivot, a);
+        if (Pinv[Q[k]] != k) offDiagonal++; // 第 k 列的主元行不是该列自己的行
+    }
+}
+
+template<typename T>
+inline long long SparseLU<T>::FactorFlops() const {
+    long long flops = 0;
+    for (int k = 0; k < N; k++) {
+        for (int p = Up[k]; p < Up[k + 1] - 1; p++) flops += Lp[Ui[p] + 1] - Lp[Ui[p]] - 1; // 用 L 的第 j 列消去
+        flops += Lp[k + 1] - Lp[k] - 1; // 除以主元
+    }
+    return flops;
+}
+
+template<typename T>
+inline void SparseLU<T>::Solve(const T* b, T* x) {
+    T* y = Work.data();
+    for (int i = 0; i < N; i++) y[Pinv[i]] = b[i]; // y = P*b
+    // 前向替换，求解 L * Z = y
+    for (int j = 0; j < N; j++) {
+        T yj = y[j];
+        for (int p = Lp[j] + 1; p < Lp[j + 1]; p++) y[Li[p]] -= Lx[p] * yj;
+    }
+    // 后向替换，求解 U * W = Z
+    for (int j = N - 1; j >= 0; j--) {
+        y[j] /= Ux[Up[j + 1] - 1];
+        T yj = y[j];
+        for (int p = Up[j]; p < Up[j + 1] - 1; p++) y[Ui[p]] -= Ux[p] * yj;
+    }
+    for (int k = 0; k < N; k++) x[Q[k]] = y[k]; // x = Q*W
+}
+
+template<typename T>
+inline void SparseLU<T>::SolveBatch(int m, const T* b, T* x) {
+    WorkBatch.resize((size_t)N * m);
+    T* y = WorkBatch.data();
+    for (int i = 0; i < N; i++) std::copy(b + (size_t)i * m, b + (size_t)(i + 1) * m, y + (size_t)Pinv[i] * m);
+    // 前向替换，每个 L 元素同时作用于 m 个右端项
+    for (int j = 0; j < N; j++) {
+        const T* yj = y + (size_t)j * m;
+        for (int p = Lp[j] + 1; p < Lp[j + 1]; p++) {
+            T l = Lx[p];
+            T* yi = y + (size_t)Li[p] * m;
+            for (int r = 0; r < m; r++) yi[r] -= l * yj[r];
+        }
+    }
+    // 后向替换
+    for (int j = N - 1; j >= 0; j--) {
+        T* yj = y + (size_t)j * m;
+        T d = Ux[Up[j + 1] - 1];
+        for (int r = 0; r < m; r++) yj[r] /= d;
+        for (int p = Up[j]; p < Up[j + 1] - 1; p++) {
+            T u = Ux[p];
+            T* yi = y + (size_t)Ui[p] * m;
+            for (int r = 0; r < m; r++) yi[r] -= u * yj[r];
+        }
+    }
+    for (int k = 0; k < N; k++) std::copy(y + (size_t)k * m, y + (size_t)(k + 1) * m, x + (size_t)Q[k] * m);
+}
+
+} // namespace xespice
+#endif // !XE_SPARSELU_H
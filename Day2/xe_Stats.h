@@ -0,0 +1,184 @@
+#ifndef XE_STATS_H
+#define XE_STATS_H
+/*
+* 文件名称：xe_Stats.h
+* 摘    要：运行统计的辅助功能：硬件性能计数器（Linux perf_event_open）、进程峰值内存、JSON 字符串转义
+* 作    者：H.J.Xie
+* 完成日期：2025年9月26日
+*/
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <system_error>
+#include "xe_StdType.h"
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/resource.h>
+#include <linux/perf_event.h>
+#define XE_PERF_EVENT 1 // 支持 perf_event_open
+#else
+#define XE_PERF_EVENT 0
+#endif
+namespace xespice
+{
+// 硬件计数器的种类
+enum PerfEvent {
+    PERF_CYCLES = 0,       // CPU 周期数
+    PERF_INSTRUCTIONS = 1, // 指令数
+    PERF_CACHE_REFS = 2,   // 末级缓存访问次数
+    PERF_CACHE_MISSES = 3, // 末级缓存缺失次数
+    PERF_BRANCH_MISSES = 4, // 分支预测失败次数
+    PERF_EVENT_COUNT = 5
+};
+
+// 硬件性能计数器：以一组计数器统计本线程（及其创建的线程）用户态的事件，读取时取各事件的累计值
+// 系统不允许（如 perf_event_paranoid 限制、虚拟机不支持）时 Open 返回 false，Reason 说明原因
+struct PerfCounters {
+private:
+    int Fd[PERF_EVENT_COUNT]; // 各事件的文件描述符（-1 表示未打开）
+public:
+    String Reason = ""; // 不可用的原因
+    PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+    // 打开并启动计数器，返回 true 表示至少有一个事件可用
+    bool Open();
+    // 读取各事件的累计值（不可用的事件为 -1）
+    void Read(long long* values) const;
+    // 关闭计数器
+    void Close();
+    // 是否已打开
+    bool IsOpen() const;
+    // 获取事件名称
+    static const char* Name(int event);
+    ~PerfCounters();
+};
+
+inline PerfCounters::PerfCounters() {
+    for (int& fd : Fd) fd = -1;
+}
+
+inline bool PerfCounters::Open() {
+    Close();
+#if XE_PERF_EVENT
+    static const unsigned long long config[PERF_EVENT_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_REFERENCES,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+    };
+    int err = 0;
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config[e];
+        attr.exclude_kernel = 1; // 只统计用户态（普通用户在 perf_event_paranoid <= 2 时允许）
+        attr.exclude_hv = 1;
+        attr.inherit = 1; // 包括之后创建的线程（线程池），之前已存在的线程不计入
+        Fd[e] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (Fd[e] < 0) err = errno;
+    }
+    if (!IsOpen()) {
+        Reason = "perf_event_open: " + std::generic_category().message(err); // strerror 不是线程安全的
+        return false;
+    }
+    return true;
+#else
+    Reason = "perf_event_open not supported on this platform";
+    return false;
+#endif
+}
+
+inline void PerfCounters::Read(long long* values) const {
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        values[e] = -1;
+#if XE_PERF_EVENT
+        long long v = 0;
+        if (Fd[e] >= 0 && read(Fd[e], &v, sizeof(v)) == (ssize_t)sizeof(v)) values[e] = v;
+#endif
+    }
+}
+
+inline void PerfCounters::Close() {
+    for (int& fd : Fd) {
+#if XE_PERF_EVENT
+        if (fd >= 0) close(fd);
+#endif
+        fd = -1;
+    }
+}
+
+inline bool PerfCounters::IsOpen() const {
+    for (int fd : Fd) if (fd >= 0) return true;
+    return false;
+}
+
+inline const char* PerfCounters::Name(int event) {
+    static const char* names[PERF_EVENT_COUNT] = { "cycles", "instructions", "cache_references", "cache_misses", "branch_misses" };
+    return names[event];
+}
+
+inline PerfCounters::~PerfCounters() {
+    Close();
+}
+
+// 获取进程的峰值常驻内存（字节），不支持时返回 0
+static inline long long Stats_PeakRSS() {
+#if XE_PERF_EVENT
+    rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) == 0) return (long long)ru.ru_maxrss * 1024; // Linux 以 KB 为单位
+#endif
+    return 0;
+}
+
+// 判断字符串是否为合法的 UTF-8 编码
+static inline bool Str_IsUtf8(StrView s) {
+    for (size_t i = 0; i < s.size(); ) {
+        unsigned char c = (unsigned char)s[i];
+        int len = (c < 0x80) ? 1 : ((c >> 5) == 0x6) ? 2 : ((c >> 4) == 0xE) ? 3 : ((c >> 3) == 0x1E) ? 4 : 0;
+        if (len == 0 || i + len > s.size()) return false;
+        for (int k = 1; k < len; k++) {
+            if (((unsigned char)s[i + k] >> 6) != 0x2) return false;
+        }
+        i += len;
+    }
+    return true;
+}
+
+// 将字符串转义为 JSON 字符串字面量（含两端引号）
+// 非 UTF-8 的字符串（如 GBK 编码的标题）逐字节转义为 \u00XX，保证输出为合法的 JSON
+static inline String Json_Quote(StrView s) {
+    bool utf8 = Str_IsUtf8(s);
+    String out = "\"";
+    for (char ch : s) {
+        unsigned char c = (unsigned char)ch;
+        if (ch == '"' || ch == '\\') {
+            out += '\\';
+            out += ch;
+        }
+        else if (ch == '\n') out += "\\n";
+        else if (ch == '\r') out += "\\r";
+        else if (ch == '\t') out += "\\t";
+        else if (c < 0x20 || (c >= 0x80 && !utf8)) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        }
+        else out += ch;
+    }
+    out += '"';
+    return out;
+}
+
+// 将数值转为 JSON 数字（无穷大和 NaN 不是合法的 JSON 数字，输出为 null）
+static inline String Json_Number(double v) {
+    if (!std::isfinite(v)) return "null";
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.9g", v);
+    return buf;
+}
+
+} // namespace xespice
+#endif // !XE_STATS_H
@@ -7,6 +7,8 @@
 * 完成日期：2025年8月26日
 */
 #include <string>
+#include <string_view>
+#include <charconv>
 #include <vector>
 #include <map>
 #include <unordered_set>
@@ -18,6 +20,8 @@ namespace xespice
 {
     // 字符串类型
     using String = std::string;
+    // 字符串视图类型（不拥有字符）
+    using StrView = std::string_view;
     // 泛型动态数组类型
     template<typename T>
     using Vect = std::vector<T>;
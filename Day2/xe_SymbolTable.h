@@ -0,0 +1,124 @@
+#ifndef XE_SYMBOLTABLE_H
+#define XE_SYMBOLTABLE_H
+/*
+* 文件名称：xe_SymbolTable.h
+* 摘    要：不区分大小写的名称驻留表（节点、支路和元件名只存一份，其余地方用整数编号引用）
+* 作    者：H.J.Xie
+* 完成日期：2025年9月19日
+*/
+#include <algorithm>
+#include "xe_StdType.h"
+#include "xe_Parse.h"
+#include "xe_Arena.h"
+namespace xespice
+{
+// 符号表：线性探测的开放寻址散列表，散列和比较时逐字符转小写，查找不产生临时字符串
+// 名称（已转小写）存放在外部的内存池中，不再移动，因此 Name 返回的视图在内存池释放之前一直有效
+struct SymbolTable {
+private:
+    Arena& Mem; // 存放名称的内存池
+    // 散列表的一个位置：散列值与符号编号放在一起，探测时先比较散列值，减少对名称的访问
+    struct Slot {
+        unsigned Hash = 0; // 名称的散列值（扩容时不必重新计算）
+        int Id = 0;        // 符号编号+1，0 表示空位
+    };
+    Vect<StrView> Names; // 各符号的名称（指向内存池）
+    Vect<Slot> Slots; // 散列表（容量为 2 的幂）
+    // 计算名称转小写后的散列值（FNV-1a）
+    static unsigned HashOf(StrView s);
+    // 名称 s 转小写后是否与已存放的名称相同
+    static bool Equal(StrView stored, StrView s);
+    // 查找名称所在的位置，不存在时返回应插入的空位
+    size_t Probe(StrView s, unsigned h) const;
+    // 以新的容量重建散列表
+    void Rehash(size_t cap);
+public:
+    // 构造函数，名称存放在内存池 arena 中
+    explicit SymbolTable(Arena& arena);
+    // 查找名称，返回符号编号，不存在时返回 -1
+    int Find(StrView name) const;
+    // 查找名称，不存在时加入，返回符号编号（编号从 0 开始连续分配）
+    int Intern(StrView name);
+    // 获取符号的名称（小写）
+    StrView Name(int id) const;
+    // 获取符号个数
+    int Size() const;
+};
+
+inline SymbolTable::SymbolTable(Arena& arena) : Mem(arena) {
+}
+
+inline unsigned SymbolTable::HashOf(StrView s) {
+    const char* lower = Str_CharTable().Lower;
+    unsigned h = 2166136261u;
+    for (char ch : s) {
+        h ^= (unsigned char)lower[(unsigned char)ch];
+        h *= 16777619u;
+    }
+    h ^= h >> 16; // 混合高位，避免相似名称的低位聚集（线性探测只用低位）
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    return h;
+}
+
+inline bool SymbolTable::Equal(StrView stored, StrView s) {
+    if (stored.size() != s.size()) return false;
+    const char* lower = Str_CharTable().Lower;
+    for (size_t i = 0; i < s.size(); i++) {
+        if (stored[i] != lower[(unsigned char)s[i]]) return false;
+    }
+    return true;
+}
+
+inline size_t SymbolTable::Probe(StrView s, unsigned h) const {
+    size_t mask = Slots.size() - 1;
+    size_t i = h & mask;
+    while (Slots[i].Id != 0) {
+        if (Slots[i].Hash == h && Equal(Names[Slots[i].Id - 1], s)) return i;
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+inline void SymbolTable::Rehash(size_t cap) {
+    Vect<Slot> old(cap);
+    old.swap(Slots);
+    size_t mask = cap - 1;
+    for (const Slot& slot : old) {
+        if (slot.Id == 0) continue;
+        size_t i = slot.Hash & mask;
+        while (Slots[i].Id != 0) i = (i + 1) & mask;
+        Slots[i] = slot;
+    }
+}
+
+inline int SymbolTable::Find(StrView name) const {
+    if (Slots.empty()) return -1;
+    return Slots[Probe(name, HashOf(name))].Id - 1;
+}
+
+inline int SymbolTable::Intern(StrView name) {
+    if ((Names.size() + 1) * 2 > Slots.size()) Rehash(std::max<size_t>(Slots.size() * 2, 64)); // 装载率不超过 1/2
+    unsigned h = HashOf(name);
+    size_t i = Probe(name, h);
+    if (Slots[i].Id != 0) return Slots[i].Id - 1;
+    // 新名称：转小写后存入内存池
+    const char* lower = Str_CharTable().Lower;
+    char* p = (char*)Mem.Alloc(name.size(), 1);
+    for (size_t k = 0; k < name.size(); k++) p[k] = lower[(unsigned char)name[k]];
+    Names.emplace_back(p, name.size());
+    Slots[i].Hash = h;
+    Slots[i].Id = (int)Names.size();
+    return (int)Names.size() - 1;
+}
+
+inline StrView SymbolTable::Name(int id) const {
+    return Names[id];
+}
+
+inline int SymbolTable::Size() const {
+    return (int)Names.size();
+}
+
+} // namespace xespice
+#endif // !XE_SYMBOLTABLE_H
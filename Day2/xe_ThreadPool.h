@@ -0,0 +1,124 @@
+#ifndef XE_THREADPOOL_H
+#define XE_THREADPOOL_H
+/*
+* 文件名称：xe_ThreadPool.h
+* 摘    要：简单的线程池，用于并行执行一组相互独立的任务
+* 作    者：H.J.Xie
+* 完成日期：2025年9月5日
+*/
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include "xe_StdType.h"
+namespace xespice
+{
+// 线程池类：Run 把编号为 0~count-1 的任务分发给各线程（调用线程也参与），全部完成后返回
+// 同一个线程池不能被多个线程同时调用 Run
+struct ThreadPool {
+private:
+    Vect<std::thread> Workers; // 工作线程（不含调用线程）
+    std::mutex Mtx;
+    std::condition_variable CvStart; // 通知工作线程开始新一轮任务
+    std::condition_variable CvDone;  // 通知调用线程本轮任务已完成
+    const std::function<void(int)>* Job = nullptr; // 当前任务
+    int Count = 0;               // 当前任务个数
+    std::atomic<int> Next{0};    // 下一个待领取的任务编号
+    int Active = 0;              // 尚未完成本轮的工作线程数
+    unsigned Generation = 0;     // 任务轮次
+    bool Stop = false;           // 是否停止
+    // 领取并执行任务，直到任务被领完
+    void Work();
+    // 工作线程主循环（id 为工作线程编号）
+    void Loop(int id);
+    // 当前线程编号的存储
+    static int& WorkerSlot();
+public:
+    // 构造函数，n 为总线程数（含调用线程），n<=0 表示使用全部硬件线程
+    ThreadPool(int n);
+    // 获取总线程数（含调用线程）
+    int Size();
+    // 并行执行 count 个任务，func(i) 执行第 i 个任务（任务由空闲线程依次领取）
+    void Run(int count, const std::function<void(int)>& func);
+    // 获取当前线程的编号（调用线程为 0，工作线程为 1~Size()-1），用于访问各线程私有的工作区
+    static int WorkerId();
+    // 析构函数，结束所有工作线程
+    ~ThreadPool();
+};
+
+inline ThreadPool::ThreadPool(int n) {
+    if (n <= 0) n = (int)std::thread::hardware_concurrency();
+    if (n <= 0) n = 1;
+    for (int i = 1; i < n; i++) Workers.emplace_back(&ThreadPool::Loop, this, i);
+}
+
+inline int ThreadPool::Size() {
+    return (int)Workers.size() + 1;
+}
+
+inline int& ThreadPool::WorkerSlot() {
+    static thread_local int id = 0;
+    return id;
+}
+
+inline int ThreadPool::WorkerId() {
+    return WorkerSlot();
+}
+
+inline void ThreadPool::Work() {
+    int i;
+    while ((i = Next.fetch_add(1)) < Count) (*Job)(i);
+}
+
+inline void ThreadPool::Loop(int id) {
+    WorkerSlot() = id;
+    unsigned seen = 0;
+    while (true) {
+        std::unique_lock<std::mutex> lock(Mtx);
+        CvStart.wait(lock, [&] { return Stop || Generation != seen; });
+        if (Stop) return;
+        seen = Generation;
+        lock.unlock();
+        Work();
+        lock.lock();
+        if (--Active == 0) CvDone.notify_one();
+    }
+}
+
+inline void ThreadPool::Run(int count, const std::function<void(int)>& func) {
+    // 调用线程在本线程池中的编号为 0（调用线程可能是另一个线程池的工作线程，结束后恢复其编号）
+    int& slot = WorkerSlot();
+    int saved = slot;
+    slot = 0;
+    if (Workers.empty() || count <= 1) { // 无需并行
+        for (int i = 0; i < count; i++) func(i);
+        slot = saved;
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(Mtx);
+        Job = &func;
+        Count = count;
+        Next = 0;
+        Active = (int)Workers.size();
+        Generation++;
+    }
+    CvStart.notify_all();
+    Work();
+    std::unique_lock<std::mutex> lock(Mtx);
+    CvDone.wait(lock, [&] { return Active == 0; });
+    slot = saved;
+}
+
+inline ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(Mtx);
+        Stop = true;
+    }
+    CvStart.notify_all();
+    for (std::thread& t : Workers) t.join();
+}
+
+} // namespace xespice
+#endif // !XE_THREADPOOL_H
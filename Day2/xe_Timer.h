@@ -0,0 +1,30 @@
+#ifndef XE_TIMER_H
+#define XE_TIMER_H
+/*
+* 文件名称：xe_Timer.h
+* 摘    要：单调时钟计时（各阶段耗时的累加）
+* 作    者：H.J.Xie
+* 完成日期：2025年9月25日
+*/
+#include <chrono>
+namespace xespice
+{
+// 获取单调时钟的当前时刻（秒，只用于求差）
+static inline double Timer_Now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 作用域计时器：析构时将经过的时间累加到 acc
+struct ScopedTimer {
+private:
+    double& Acc; // 累加的目标（秒）
+    double T0;   // 开始时刻
+public:
+    explicit ScopedTimer(double& acc) : Acc(acc), T0(Timer_Now()) {}
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+    ~ScopedTimer() { Acc += Timer_Now() - T0; }
+};
+
+} // namespace xespice
+#endif // !XE_TIMER_H
@@ -0,0 +1,139 @@
+#ifndef XE_WORKSPACE_H
+#define XE_WORKSPACE_H
+/*
+* 文件名称：xe_Workspace.h
+* 摘    要：批处理和服务模式中多个电路依次共用的工作区（内存块缓存、库文件缓存、线程池）
+* 作    者：H.J.Xie
+* 完成日期：2025年9月26日
+*/
+#include <memory>
+#include <unordered_map>
+#include "xe_StdType.h"
+#include "xe_Arena.h"
+#include "xe_MappedFile.h"
+#include "xe_ThreadPool.h"
+namespace xespice
+{
+// 库文件缓存项：文件映射（单词已原地转为小写）及分解出的各逻辑行的单词（单词指向映射）
+struct SourceEntry {
+    MappedFile File; // 文件映射
+    long long Size = -1; // 读取时文件的大小
+    long long MTime = 0; // 读取时文件的修改时间
+    Vect<Vect<StrView>> Lines; // 各逻辑行的单词（空行和注释行不记录）
+    bool Complete = false; // 是否已分解完整个文件（读取中的缓存项不能重放，也不能替换）
+    size_t Bytes = 0; // 占用的字节数（映射及逻辑行，读完后的第一次 EndJob 时计算）
+    long long LastUse = 0; // 最近一次使用时的作业序号（淘汰最久未用的缓存项）
+};
+
+// 工作区类：.INCLUDE/.LIB 读入的文件按路径缓存，文件未改动时直接重放已分解的逻辑行
+// 缓存的总字节数超过 SourceLimit 时，在作业之间按最久未用的顺序淘汰（作业中电路的单词指向映射，不能淘汰）
+// 电路的内存池从内存块缓存取用内存块，线程数相同的电路共用一个线程池
+// 不是线程安全的，同一时刻只能供一个电路使用，且须比使用它的电路存在得更久
+struct Workspace {
+private:
+    std::unordered_map<String, std::unique_ptr<SourceEntry>> Sources; // 路径 -> 库文件缓存项
+    ThreadPool* Pool = nullptr; // 共用的线程池
+    int PoolThreads = 0; // 线程池创建时请求的线程数
+    long long Jobs = 0; // 已结束的作业数（即当前作业的序号）
+    size_t SourceBytes = 0; // 已计入的缓存项的总字节数
+public:
+    size_t SourceLimit = (size_t)256 << 20; // 库文件缓存字节数的上限
+    BlockCache Blocks; // 内存池的内存块缓存
+    long long SourceHits = 0; // 库文件缓存命中的次数
+    long long SourceMisses = 0; // 库文件缓存未命中（首次读取或文件已改动）的次数
+    Workspace() = default;
+    Workspace(const Workspace&) = delete;
+    Workspace& operator=(const Workspace&) = delete;
+    // 查找库文件缓存项：读取中的缓存项直接返回，已完成的缓存项在文件未改动时返回，否则返回 nullptr
+    SourceEntry* FindSource(const String& path);
+    // 新建（或替换已过期的）缓存项，记录文件当前的大小和修改时间，文件不存在时返回 nullptr
+    SourceEntry* NewSource(const String& path);
+    // 删除缓存项（读取失败时）
+    void DropSource(const String& path);
+    // 一个电路用完工作区后调用：删除未读完的缓存项（中途出错），超过上限时淘汰最久未用的缓存项
+    void EndJob();
+    // 获取线程池（threads 为请求的线程数，与上次不同时重新创建）
+    ThreadPool* GetPool(int threads);
+    // 获取缓存的库文件个数
+    int SourceCount() const;
+    // 析构函数，结束线程池
+    ~Workspace();
+};
+
+inline SourceEntry* Workspace::FindSource(const String& path) {
+    auto it = Sources.find(path);
+    if (it == Sources.end()) return nullptr;
+    SourceEntry* entry = it->second.get();
+    if (!entry->Complete) return entry;
+    long long size, mtime;
+    if (!File_Stamp(path, size, mtime) || size != entry->Size || mtime != entry->MTime) return nullptr;
+    SourceHits++;
+    entry->LastUse = Jobs;
+    return entry;
+}
+
+inline SourceEntry* Workspace::NewSource(const String& path) {
+    long long size, mtime;
+    if (!File_Stamp(path, size, mtime)) return nullptr;
+    std::unique_ptr<SourceEntry>& slot = Sources[path];
+    if (slot) SourceBytes -= slot->Bytes;
+    slot.reset(new SourceEntry());
+    slot->Size = size;
+    slot->MTime = mtime;
+    slot->LastUse = Jobs;
+    SourceMisses++;
+    return slot.get();
+}
+
+inline void Workspace::DropSource(const String& path) {
+    auto it = Sources.find(path);
+    if (it == Sources.end()) return;
+    SourceBytes -= it->second->Bytes;
+    Sources.erase(it);
+}
+
+inline void Workspace::EndJob() {
+    for (auto it = Sources.begin(); it != Sources.end(); ) {
+        SourceEntry* entry = it->second.get();
+        if (!entry->Complete) {
+            SourceBytes -= entry->Bytes;
+            it = Sources.erase(it);
+            continue;
+        }
+        if (entry->Bytes == 0) { // 新读完的缓存项
+            entry->Bytes = entry->File.Size() + entry->Lines.capacity() * sizeof(Vect<StrView>);
+            for (const Vect<StrView>& line : entry->Lines) entry->Bytes += line.capacity() * sizeof(StrView);
+            SourceBytes += entry->Bytes;
+        }
+        ++it;
+    }
+    while (SourceBytes > SourceLimit) { // 淘汰最久未用的缓存项（缓存项不多，直接查找）
+        auto oldest = Sources.begin();
+        for (auto it = Sources.begin(); it != Sources.end(); ++it) {
+            if (it->second->LastUse < oldest->second->LastUse) oldest = it;
+        }
+        SourceBytes -= oldest->second->Bytes;
+        Sources.erase(oldest);
+    }
+    Jobs++;
+}
+
+inline ThreadPool* Workspace::GetPool(int threads) {
+    if (Pool == nullptr || PoolThreads != threads) {
+        delete Pool;
+        Pool = new ThreadPool(threads);
+        PoolThreads = threads;
+    }
+    return Pool;
+}
+
+inline int Workspace::SourceCount() const {
+    return (int)Sources.size();
+}
+
+inline Workspace::~Workspace() {
+    delete Pool;
+}
+
+} // namespace xespice
+#endif // !XE_WORKSPACE_H
@@ -0,0 +1,372 @@
+#ifndef XE_WRITER_H
+#define XE_WRITER_H
+/*
+* 文件名称：xe_Writer.h
+* 摘    要：仿真结果的输出（大缓冲区写入；制表符分隔的文本或 SPICE 二进制 rawfile，可选差分压缩）
+* 作    者：H.J.Xie
+* 完成日期：2025年9月23日
+*/
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <complex>
+#include "xe_StdType.h"
+namespace xespice
+{
+// 输出格式
+enum OutputFormat {
+    OUT_TEXT = 0, // 制表符分隔的文本（默认）
+    OUT_RAW = 1   // SPICE 二进制 rawfile
+};
+
+// 结果输出类：所有输出先写入缓冲区，缓冲区满或结束时一次写入文件
+// 结果按表（plot）组织：BeginPlot、AddColumn/AddVar、EndHeader，之后逐行 Real/Int/Complex、EndRow，最后 EndPlot
+// 文本格式与原先逐值格式化的输出逐字节相同；rawfile 格式每个表一个 plot（复数表的标量列虚部为 0）
+// 差分压缩（仅 rawfile）：每个值与上一点同一位置的值按位异或，去掉首尾的零字节，前缀一个字节记录
+// 去掉的字节数（高 4 位为高位零字节数，低 4 位为低位零字节数），数据段标记为 "Delta:" 而非 "Binary:"
+// （由 Raw_DecodeDelta 解码，bench/raw_undelta.cpp 把它转换回标准 rawfile）
+struct ResultWriter {
+private:
+    static const size_t BUF_SIZE = 1 << 20; // 缓冲区大小
+    static const int POINTS_WIDTH = 20; // "No. Points:" 数值字段的宽度（结束时回填）
+    std::FILE* File = nullptr; // 输出文件
+    String Path = ""; // 输出文件路径
+    Vect<char> Buf; // 缓冲区
+    size_t Len = 0; // 缓冲区中的字节数
+    long long Written = 0; // 已写入文件的字节数
+    bool WriteFailed = false; // 是否有写入失败（如磁盘已满），此时文件不完整
+    int Format = OUT_TEXT; // 输出格式
+    bool Delta = false; // rawfile 是否差分压缩
+    int Digits = 6; // 文本格式的有效数字位数
+    String Title = ""; // rawfile 的标题
+    /*//////////////////// 当前结果表 ////////////////////*/
+    bool IsComplex = false; // 是否为复数表
+    Vect<String> VarNames; // 各变量的名称（rawfile）
+    Vect<const char*> VarTypes; // 各变量的类型（rawfile）
+    long long PointsPos = -1; // "No. Points:" 数值字段在文件中的位置
+    long long Points = 0; // 已输出的行数
+    Vect<uint64_t> Prev; // 上一行各值的位模式（差分压缩）
+    size_t Slot = 0; // 当前行中下一个值的位置（差分压缩）
+    // 保证缓冲区至少还有 n 字节的空间
+    void Reserve(size_t n);
+    // 以二进制写入一个双精度数（差分压缩时编码）
+    void PutBinary(double v);
+public:
+    ResultWriter() = default;
+    ResultWriter(const ResultWriter&) = delete;
+    ResultWriter& operator=(const ResultWriter&) = delete;
+    // 打开输出文件（已打开时先关闭），返回 false 表示无法打开
+    bool Open(const String& path);
+    // 写出缓冲区并关闭文件，返回 false 表示有写入失败（文件不完整）
+    bool Close();
+    // 文件是否已打开
+    bool IsOpen() const;
+    // 获取输出文件路径
+    const String& GetPath() const;
+    // 设置输出格式、是否差分压缩和文本格式的有效数字位数
+    void SetFormat(int format, bool delta, int digits);
+    // 是否为文本格式
+    bool IsText() const;
+    // 设置 rawfile 的标题
+    void SetTitle(const String& title);
+    // 写出缓冲区
+    void Flush();
+    /*//////////////////// 文本写入 ////////////////////*/
+    // 写入字符串
+    void Put(StrView s);
+    // 写入一个字符
+    void Put(char ch);
+    // 写入整数
+    void PutInt(long long v);
+    // 以科学计数法写入实数（与 std::scientific 和 setprecision(Digits) 的结果相同）
+    void PutReal(double v);
+    /*//////////////////// 结果表 ////////////////////*/
+    // 开始一个结果表，name 为 rawfile 中的 Plotname
+    void BeginPlot(const char* name, bool isComplex);
+    // 添加一个标量列（扫描变量、时间、频率等），type 为 rawfile 中的变量类型
+    void AddColumn(StrView name, const char* type);
+    // 添加一个节点电压（kind 为 'V'）或支路电流（kind 为 'I'）列，复数表的文本格式输出幅度和相位两列
+    void AddVar(char kind, StrView name);
+    // 结束表头
+    void EndHeader();
+    // 写入一个实数值
+    void Real(double v);
+    // 写入一个整数值（rawfile 中按实数存放）
+    void Int(long long v);
+    // 写入一个复数值（文本格式为幅度和相位（度））
+    void Complex(std::complex<double> v);
+    // 结束一行
+    void EndRow();
+    // 结束结果表（rawfile 回填点数）
+    void EndPlot();
+    // 析构函数
+    ~ResultWriter();
+};
+
+// 定位到文件中的 pos 处（超过 2GB 的文件也可定位，long 为 32 位的平台不能用 std::fseek），成功时返回 true
+static inline bool Raw_Seek(std::FILE* file, long long pos) {
+#ifdef _WIN32
+    return _fseeki64(file, pos, SEEK_SET) == 0;
+#else
+    return fseeko(file, (off_t)pos, SEEK_SET) == 0;
+#endif
+}
+
+/*//////////////////// 差分压缩的解码 ////////////////////*/
+// 解码 count 个值（每行 width 个，count 为 width 的整数倍）追加到 out，prev 为上一行的位模式（首次调用时为空），返回读过的字节数，数据不完整时返回 0
+static inline size_t Raw_DecodeDelta(const char* src, size_t n, size_t width, size_t count, Vect<uint64_t>& prev, Vect<double>& out) {
+    if (prev.size() != width) prev.assign(width, 0);
+    size_t p = 0;
+    for (size_t k = 0; k < count; k++) {
+        if (p >= n) return 0;
+        unsigned char tag = (unsigned char)src[p++];
+        int lead = tag >> 4, trail = tag & 0xf;
+        int m = 8 - lead - trail;
+        if (m < 0 || p + m > n) return 0;
+        uint64_t x = 0;
+        for (int b = 0; b < m; b++) x |= (uint64_t)(unsigned char)src[p + b] << (8 * (trail + b));
+        p += m;
+        uint64_t& u = prev[k % width];
+        u ^= x;
+        double v;
+        std::memcpy(&v, &u, sizeof(v));
+        out.push_back(v);
+    }
+    return p;
+}
+
+inline bool ResultWriter::Open(const String& path) {
+    Close();
+    File = std::fopen(path.c_str(), "wb");
+    if (File == nullptr) return false;
+    Path = path;
+    Buf.resize(BUF_SIZE);
+    Len = 0;
+    Written = 0;
+    WriteFailed = false;
+    return true;
+}
+
+inline bool ResultWriter::Close() {
+    if (File == nullptr) return !WriteFailed;
+    EndPlot(); // 中途出错时回填已输出的点数
+    Flush();
+    if (std::ferror(File)) WriteFailed = true; // 回填点数时 fseek 隐式写出的 stdio 缓冲也可能失败
+    if (std::fclose(File) != 0) WriteFailed = true;
+    File = nullptr;
+    return !WriteFailed;
+}
+
+inline bool ResultWriter::IsOpen() const {
+    return File != nullptr;
+}
+
+inline const String& ResultWriter::GetPath() const {
+    return Path;
+}
+
+inline void ResultWriter::SetFormat(int format, bool delta, int digits) {
+    Format = format;
+    Delta = delta;
+    Digits = digits;
+}
+
+inline bool ResultWriter::IsText() const {
+    return Format == OUT_TEXT;
+}
+
+inline void ResultWriter::SetTitle(const String& title) {
+    Title = title;
+}
+
+inline void ResultWriter::Flush() {
+    if (File == nullptr || Len == 0) return;
+    if (std::fwrite(Buf.data(), 1, Len, File) != Len) WriteFailed = true;
+    Written += Len;
+    Len = 0;
+}
+
+inline void ResultWriter::Reserve(size_t n) {
+    if (Len + n > Buf.size()) {
+        Flush();
+        if (n > Buf.size()) Buf.resize(n);
+    }
+}
+
+inline void ResultWriter::Put(StrView s) {
+    if (File == nullptr) return;
+    Reserve(s.size());
+    std::memcpy(Buf.data() + Len, s.data(), s.size());
+    Len += s.size();
+}
+
+inline void ResultWriter::Put(char ch) {
+    if (File == nullptr) return;
+    Reserve(1);
+    Buf[Len++] = ch;
+}
+
+inline void ResultWriter::PutInt(long long v) {
+    if (File == nullptr) return;
+    Reserve(24);
+    char* p = Buf.data() + Len;
+    Len = std::to_chars(p, p + 24, v).ptr - Buf.data();
+}
+
+inline void ResultWriter::PutReal(double v) {
+    if (File == nullptr) return;
+    Reserve(32);
+    char* p = Buf.data() + Len;
+    Len = std::to_chars(p, p + 32, v, std::chars_format::scientific, Digits).ptr - Buf.data();
+}
+
+inline void ResultWriter::PutBinary(double v) {
+    if (File == nullptr) return;
+    Reserve(9);
+    uint64_t u;
+    std::memcpy(&u, &v, sizeof(u));
+    if (!Delta) {
+        std::memcpy(Buf.data() + Len, &u, sizeof(u));
+        Len += sizeof(u);
+        return;
+    }
+    if (Slot >= Prev.size()) Prev.resize(Slot + 1, 0);
+    uint64_t x = u ^ Prev[Slot];
+    Prev[Slot++] = u;
+    int lead = 0, trail = 0;
+    while (lead < 8 && (x >> (56 - 8 * lead) & 0xff) == 0) lead++;
+    while (lead + trail < 8 && (x >> (8 * trail) & 0xff) == 0) trail++;
+    Buf[Len++] = (char)(lead << 4 | trail);
+    for (int b = trail; b < 8 - lead; b++) Buf[Len++] = (char)(x >> (8 * b));
+}
+
+inline void ResultWriter::BeginPlot(const char* name, bool isComplex) {
+    IsComplex = isComplex;
+    VarNames.clear();
+    VarTypes.clear();
+    Points = 0;
+    Prev.clear();
+    Slot = 0;
+    if (Format == OUT_TEXT) return;
+    char date[64] = "";
+    std::time_t now = std::time(nullptr);
+    std::tm local = {}; // std::localtime 返回共用的静态缓冲，并发的任务会互相覆盖
+#ifdef _WIN32
+    localtime_s(&local, &now);
+#else
+    localtime_r(&now, &local);
+#endif
+    std::strftime(date, sizeof(date), "%a %b %d %H:%M:%S %Y", &local);
+    Put("Title: "); Put(Title); Put('\n');
+    Put("Date: "); Put(date); Put('\n');
+    Put("Plotname: "); Put(name); Put('\n');
+    Put(isComplex ? "Flags: complex" : "Flags: real");
+    Put(Delta ? " delta\n" : "\n");
+}
+
+inline void ResultWriter::AddColumn(StrView name, const char* type) {
+    if (Format == OUT_TEXT) {
+        Put(name);
+        Put('\t');
+        return;
+    }
+    VarNames.emplace_back(name);
+    VarTypes.push_back(type);
+}
+
+inline void ResultWriter::AddVar(char kind, StrView name) {
+    if (Format == OUT_TEXT) {
+        if (IsComplex) {
+            Put(kind); Put("M("); Put(name); Put(")\t");
+            Put(kind); Put("P("); Put(name); Put(")\t");
+        }
+        else {
+            Put(kind); Put('('); Put(name); Put(")\t");
+        }
+        return;
+    }
+    String s(1, (char)(kind - 'A' + 'a'));
+    s += '(';
+    s += name;
+    s += ')';
+    VarNames.push_back(std::move(s));
+    VarTypes.push_back(kind == 'V' ? "voltage" : "current");
+}
+
+inline void ResultWriter::EndHeader() {
+    if (Format == OUT_TEXT) {
+        Put('\n');
+        return;
+    }
+    Put("No. Variables: ");
+    PutInt((long long)VarNames.size());
+    Put("\nNo. Points: ");
+    PointsPos = Written + (long long)Len;
+    Put(String(POINTS_WIDTH, ' '));
+    Put("\nVariables:\n");
+    for (size_t i = 0; i < VarNames.size(); i++) {
+        Put('\t'); PutInt((long long)i);
+        Put('\t'); Put(VarNames[i]);
+        Put('\t'); Put(VarTypes[i]);
+        Put('\n');
+    }
+    Put(Delta ? "Delta:\n" : "Binary:\n");
+}
+
+inline void ResultWriter::Real(double v) {
+    if (Format == OUT_TEXT) {
+        PutReal(v);
+        Put('\t');
+        return;
+    }
+    PutBinary(v);
+    if (IsComplex) PutBinary(0);
+}
+
+inline void ResultWriter::Int(long long v) {
+    if (Format == OUT_TEXT) {
+        PutInt(v);
+        Put('\t');
+        return;
+    }
+    Real((double)v);
+}
+
+inline void ResultWriter::Complex(std::complex<double> v) {
+    if (Format == OUT_TEXT) {
+        PutReal(std::abs(v));
+        Put('\t');
+        PutReal(std::arg(v) * 180 / 3.14159265358979323846);
+        Put('\t');
+        return;
+    }
+    PutBinary(v.real());
+    PutBinary(v.imag());
+}
+
+inline void ResultWriter::EndRow() {
+    Points++;
+    Slot = 0;
+    if (Format == OUT_TEXT) Put('\n');
+}
+
+inline void ResultWriter::EndPlot() {
+    if (Format == OUT_TEXT || File == nullptr || PointsPos < 0) return;
+    // 回填点数（输出到不可定位的文件时保留空白）
+    Flush();
+    char num[POINTS_WIDTH + 1];
+    std::snprintf(num, sizeof(num), "%-*lld", POINTS_WIDTH, Points);
+    if (Raw_Seek(File, PointsPos)) {
+        if (std::fwrite(num, 1, POINTS_WIDTH, File) != (size_t)POINTS_WIDTH) WriteFailed = true;
+        std::fseek(File, 0, SEEK_END);
+    }
+    PointsPos = -1;
+}
+
+inline ResultWriter::~ResultWriter() {
+    Close();
+}
+
+} // namespace xespice
+#endif // !XE_WRITER_H
@@ -1,15 +1,67 @@
 #include "xe_Simulator.h"
+#include "xe_Scheduler.h"
 #include <iostream>
+#include <fstream>
+#include <algorithm>
 
-int main() {
+// 用法：
+//   xespice [-stats[=2]] [输入文件 [输出文件]]    运行一个网表，未给出的文件路径从标准输入读取
+//   xespice -batch [-stats[=2]] [网表 ...]        批处理：依次运行各网表（输出为网表路径加 .out）；
+//                                                 不给网表时从标准输入读取作业列表，每行 "输入 [输出]"
+//          [-jobs N] [-mem MB]                    N 个网表并行运行（0 表示全部硬件线程），同时运行的作业
+//                                                 按估计的内存用量不超过 MB 兆字节
+//   xespice -server 套接字路径 [-stats[=2]]       服务模式：在 UNIX 域套接字上接收作业（每行一个）
+// -stats 相当于 .OPTIONS STATS=1（=2 另外采样硬件计数器）；批处理和服务模式每个作业向标准输出/连接写一行 JSON 报告
+int main(int argc, char* argv[]) {
     namespace xe = xespice; // 取别名，方便使用
+    int stats = 0;
+    bool batch = false;
+    int jobs = 1;
+    long long memoryMB = 0;
+    xe::String socketPath = "";
+    xe::Vect<xe::String> paths;
+    for (int i = 1; i < argc; i++) {
+        xe::String arg = argv[i];
+        if (arg == "-stats") stats = 1;
+        else if (arg == "-stats=2") stats = 2;
+        else if (arg == "-batch") batch = true;
+        else if (arg == "-server" && i + 1 < argc) socketPath = argv[++i];
+        else if (arg == "-jobs" && i + 1 < argc) jobs = std::atoi(argv[++i]);
+        else if (arg == "-mem" && i + 1 < argc) memoryMB = std::atoll(argv[++i]);
+        else paths.push_back(arg);
+    }
+    if (batch || !socketPath.empty()) { // 批处理和服务模式：一个进程运行多个作业，共用工作区
+        xe::Batch_RetainHeap();
+        xe::Workspace ws;
+        if (!socketPath.empty()) {
+            xe::String error;
+            if (!xe::Batch_Serve(ws, socketPath, stats, error)) {
+                std::cout << error << std::endl;
+                return 1;
+            }
+            return 0;
+        }
+        std::stringstream list;
+        for (const xe::String& p : paths) list << p << "\n";
+        std::istream& in = paths.empty() ? std::cin : list;
+        int failed = (jobs == 1) ? xe::Batch_RunStream(ws, in, std::cout, stats)
+            : xe::Sched_RunStream(in, std::cout, stats, jobs, (size_t)memoryMB << 20);
+        return failed ? 1 : 0;
+    }
     xe::Circuit* cir = xe::NewCircuit(); // 创建电路
     xe::String s;
-    std::cout << "Input File: ";
-    std::cin >> s;
+    if (paths.size() >= 1) s = paths[0];
+    else {
+        std::cout << "Input File: ";
+        std::cin >> s;
+    }
     cir->ReadFile(s); // 读取电路文件
-    std::cout << "Output File: ";
-    std::cin >> s;
+    cir->Config.STATS = std::max(cir->Config.STATS, stats); // 命令行与网表中的设置取较大者
+    if (paths.size() >= 2) s = paths[1];
+    else {
+        std::cout << "Output File: ";
+        std::cin >> s;
+    }
 	cir->SetOutputPath(s); // 设置输出路径
     cir->Run(); // 运行
     if (cir->ErrorFlag) std::cout << cir->ErrorMsg << std::endl;